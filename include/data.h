@@ -49,6 +49,9 @@
 
 #include <stdio.h>
 #include "errors.h"
+#include "password.h"
+#include "ws23k.h"
+#include "ws23ksched.h"
 
 
 #define VAR_UNKNOWN                             0
@@ -66,29 +69,103 @@
 #define VAR_RPD                                12
 #define VAR_DIRSTR                             13
 #define VAR_TIME                               14
-#define VAR_NUM_OF_VARS                        14
+#define VAR_WIND_AVG                           15
+#define VAR_GUST                               16
+#define VAR_GUST_TIME                          17
+#define VAR_WIND_DIR                           18
+#define VAR_WIND_DEV                           19
+#define VAR_NUM_OF_VARS                        19
+
+#define STATIONS_MAX                            8                               // configuration files on the command line
+#define SPOOL_SIZE                              ( 1024L * 1024L )               // [bytes] default of [File] spool_size
+#define FLUSH_SIZE                              ( 16L * 1024L )                 // [bytes] default of [FTP] flush_size
+#define FTP_DESTINATIONS                        4                               // [FTP] and the mirrors [FTP2] to [FTP4]
+
+
+typedef struct _ftpdest
+    {
+    char server[256];                                                           // "" = not used
+    char user_name[128];
+    char key[MAX_PASSWORD_LENGTH];
+    char file[128];
+    } ftpdest_t;
+
+
+typedef struct _config
+    {
+    char com_port[128];
+    int persistent_port;                                                        // keep the serial port open between cycles
+    long response_timeout;                                                      // [us] 0 = default of sercom
+    long byte_timeout;                                                          // [us] 0 = default of sercom
+    char trace_file[128];                                                       // record the serial communication to this file
+    char replay_file[128];                                                      // replay this trace instead of using the port
+    int replay_speed;                                                           // replay speed factor, 0 = no delays
+    char image_file[128];                                                       // decode this memory image instead of the station
+    int cache_live;                                                             // [s] shadow age of current measurements
+    int cache_minmax;                                                           // [s] shadow age of minimum and maximum values
+    int cache_settings;                                                         // [s] shadow age of calibration and settings, -1 = forever
+    int sample_period[SAMPLE_NUM_OF_GROUPS];                                    // [s] sampling period of each group, 0 = read with the other values
+    int read_period;                                                            // [s] reading the station
+    int upload_period;                                                          // [s] sending the data string
+    int rollup_period;                                                          // [s] appending to the log files
+    int history_period;                                                         // [s] fetching history records
+    int alarm_period;                                                           // [s] polling the alarm flags, 0 = never
+    int reset_minmax;                                                           // [min] after midnight to reset all min/max values, -1 = never
+    char log_path[128];
+    char history_file[128];                                                     // position of the last fetched history record
+    char spool_path[128];                                                       // prefix of the upload spool files, "" = no spool
+    long spool_size;                                                            // [bytes] of log lines the spool keeps until they are sent
+    ftpdest_t ftp[FTP_DESTINATIONS];                                            // [FTP], [FTP2] ..., mirrors get the data file only
+    char ftp_log_path[128];
+    int ftp_flush;                                                              // [s] log lines for the server are collected, 0 = sent at once
+    long ftp_flush_size;                                                        // [bytes] collected lines are sent before ftp_flush is over
+    struct _tokens * p_token_list;                                              // the template split into texts and variables
+    char * ftp_string;                                                          // the template filled in by SetFtpString()
+    unsigned int ftp_changes;                                                   // CHG_xxx of the template's variables
+    int ftp_filled;                                                             // ftp_string holds a reading
+    } config_t;
 
 
 extern void set_verbose( char set );
 extern char verbose( void );
 extern void set_debug( char set );
 extern char is_debug( void );
-extern void set_ini_file( char * ini_file_name );
+extern ERRNO set_ini_file( char * ini_file_name );
+extern int ini_files( void );
+extern char * ini_file( int station );
 extern char * com_port( void );
+extern int persistent_port( void );
+extern long response_timeout( void );
+extern long byte_timeout( void );
+extern char * trace_file( void );
+extern char * replay_file( void );
+extern int replay_speed( void );
+extern char * image_file( void );
+extern int cache_live( void );
+extern int cache_minmax( void );
+extern int cache_settings( void );
+extern int sample_period( int group );
+extern int read_period( void );
+extern int upload_period( void );
+extern int rollup_period( void );
+extern int history_period( void );
+extern int alarm_period( void );
+extern int reset_minmax_time( void );
 extern char * log_path( void );
+extern char * history_file( void );
 extern char * ftp_server( void );
 extern char * user_name( void );
 extern char * user_key( void );
 extern char * ftp_log_path( void );
 extern char * ftp_file( void );
 extern char * ftp_string( void );
-extern char * get_first_token( int * len );
-extern char * get_next_token( int * len );
 extern ERRNO Remove( char * p_str, char chr );
+extern ERRNO config_read( config_t * p_config, char const * name );
+extern void config_free( config_t * p_config );
 extern ERRNO Init( void );
 extern void DeInit( void );
-extern ERRNO PrintVariable( int var, char * dst );
-extern void SetFtpString( void );
+extern ERRNO PrintVariable( weatherdata_t const * p_weatherdata, int var, char * dst );
+extern int SetFtpString( station_t * p_station, weatherdata_t const * p_weatherdata, unsigned int changes );
 
 
 #endif  // __DATA_H__
@@ -82,6 +82,12 @@
 #define ERR_RESET_COMMUNICATION                 -41
 #define ERR_NO_FTP_SERVER                       -42
 #define ERR_NO_LOG_DATA                         -43
+#define ERR_TIMER                               -44                             // creating or setting the timer failed
+#define ERR_THREAD                              -45                             // creating a thread or its locks failed
+#define ERR_TOO_MANY_STATIONS                   -46                             // more configuration files than STATIONS_MAX
+#define ERR_NO_ALARM                            -47                             // field is not an alarm threshold
+#define ERR_SPOOL_FULL                          -48                             // the upload spool reached its size
+#define ERR_SPOOL_FILE                          -49                             // reading or writing the upload spool failed
 
 
 typedef int ERRNO;
@@ -51,10 +51,26 @@
 #include "errors.h"
 
 
+typedef struct _ftpstat
+    {
+    long transfers;                                                             // successful transfers
+    long failures;
+    long connects;                                                              // transfers that needed a new connection
+    long reused;                                                                // transfers on the kept connection
+    long time_last;                                                             // [ms] of the last successful transfer
+    long time_min;                                                              // [ms]
+    long time_max;                                                              // [ms]
+    long long time_sum;                                                         // [ms]
+    } ftpstat_t;
+
+
 extern ERRNO FtpInit( void );
 extern void FtpCleanup( void );
-extern ERRNO PushFile( void );
-extern ERRNO AppendFile( char * logfile, char * line );
+extern ERRNO FtpOpen( station_t * p_station );
+extern void FtpClose( station_t * p_station );
+extern void FtpStats( station_t * p_station, int dest, ftpstat_t * p_stats );
+extern ERRNO PushFile( station_t * p_station, char * data );
+extern ERRNO AppendFile( station_t * p_station, char * logfile, char * line );
 
 
 #endif  // __FTP_H__
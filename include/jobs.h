@@ -0,0 +1,106 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        jobs.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Periodic jobs started at absolute times
+
+    details     A job runs at every multiple of its period on the wall clock,
+                e.g. a period of 60 s at every full minute. The program sleeps
+                on a timerfd until the next job is due, a clock set by hand
+                or by ntp is noticed at once. How late each job actually
+                starts is recorded.
+
+                All state is kept in a jobs_t, each thread that runs jobs
+                has its own one.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note
+
+    todo
+
+*/
+
+
+#ifndef __JOBS_H__
+#define __JOBS_H__
+
+
+#include "errors.h"
+
+
+#define JOBS_MAX                                8
+
+
+typedef void (*job_func_t)( void * p_arg );
+
+
+typedef struct _jobstat
+    {
+    long runs;                                                                  // number of starts
+    long skipped;                                                               // starts missed because a job took too long
+    long late_min;                                                              // [ms] lateness of the start
+    long late_max;                                                              // [ms]
+    long long late_sum;                                                         // [ms]
+    } jobstat_t;
+
+
+typedef struct _job
+    {
+    char const * name;
+    int period;                                                                 // [s]
+    job_func_t func;
+    void * p_arg;                                                               // passed to func
+    long long due;                                                              // [ms] since the epoch
+    jobstat_t stats;
+    } job_t;
+
+
+typedef struct _jobs
+    {
+    job_t job[JOBS_MAX];
+    int count;
+    int timer;                                                                  // timerfd
+    volatile int stop;                                                          // set by jobs_stop()
+    long clock_jumps;                                                           // times the clock was set
+    } jobs_t;
+
+
+extern ERRNO jobs_init( jobs_t * p_jobs );
+extern void jobs_deinit( jobs_t * p_jobs );
+extern int job_add( jobs_t * p_jobs, char const * name, int period, job_func_t func, void * p_arg );
+extern ERRNO jobs_run( jobs_t * p_jobs );
+extern void jobs_stop( jobs_t * p_jobs );
+extern int jobs_count( jobs_t const * p_jobs );
+extern char const * job_name( jobs_t const * p_jobs, int job );
+extern void job_stats( jobs_t const * p_jobs, int job, jobstat_t * p_stats );
+extern long jobs_clock_jumps( jobs_t const * p_jobs );
+
+
+#endif                                                                          // __JOBS_H__
@@ -48,10 +48,11 @@
 
 #include "data.h"
 #include "errors.h"
+#include "ws23khist.h"
 
 
-extern int WaitForNextMinute( void );
-extern ERRNO Log( void );
+extern ERRNO Log( station_t * p_station, weatherdata_t const * p_weatherdata );
+extern ERRNO LogHistory( station_t * p_station, history_record_t const * records, int n );
 
 
 #endif  // __LOG_H__
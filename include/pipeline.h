@@ -0,0 +1,98 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        pipeline.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Readings of all stations passed to one output thread
+
+    details     The reader thread of each station puts its readings into the
+                pipeline, the output thread takes them out in the order they
+                were put in and logs and uploads them. A reading is a copy, the
+                reader may go on with the next one at once.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        A reader never waits for the output. If the pipeline is full
+                the oldest reading is dropped and counted.
+
+    todo
+
+*/
+
+
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+
+#include <pthread.h>
+#include <time.h>
+#include "errors.h"
+#include "ws23k.h"
+#include "ws23kcom.h"
+
+
+#define PIPELINE_SLOTS                          32
+
+
+typedef struct _reading
+    {
+    station_t * p_station;                                                      // where the reading comes from
+    weatherdata_t data;
+    commstat_t stats;                                                           // of this reading
+    int ticks;                                                                  // samples taken so far
+    int fields;                                                                 // fields read by the samples
+    long duration;                                                              // [ms] of ReadData()
+    long cycle_min;                                                             // [ms] of all readings of this station
+    long cycle_mean;                                                            // [ms]
+    long cycle_max;                                                             // [ms]
+    time_t time;                                                                // when the reading was started
+    } reading_t;
+
+
+typedef struct _pipeline
+    {
+    reading_t slot[PIPELINE_SLOTS];
+    int head;                                                                   // oldest reading
+    int count;
+    int closed;                                                                 // set by pipeline_close()
+    long put;                                                                   // readings put in
+    long dropped;                                                               // readings lost because the pipeline was full
+    pthread_mutex_t lock;
+    pthread_cond_t ready;                                                       // a reading was put in or the pipeline closed
+    } pipeline_t;
+
+
+extern ERRNO pipeline_init( pipeline_t * p_pipeline );
+extern void pipeline_deinit( pipeline_t * p_pipeline );
+extern void pipeline_put( pipeline_t * p_pipeline, reading_t const * p_reading );
+extern int pipeline_get( pipeline_t * p_pipeline, reading_t * p_reading );
+extern void pipeline_close( pipeline_t * p_pipeline );
+extern void pipeline_stats( pipeline_t * p_pipeline, long * p_put, long * p_dropped );
+
+
+#endif                                                                          // __PIPELINE_H__
@@ -32,10 +32,12 @@
                 compatible weather station.
                 The API includes
                 - ws_init
+                - ws_deinit
                 - ws_open
                 - ws_close
                 - ws_read
                 - ws_write
+                - ws_counters
 
     project     weather23k
     target      Linux
@@ -56,16 +58,46 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <time.h>
 #include "errors.h"
 
 
-extern ERRNO ws_init( char * name );
-extern ERRNO ws_open( void );
-extern ERRNO ws_close( void );
-extern size_t ws_read( uint8_t * dst, size_t n );
-extern size_t ws_write( uint8_t * src, size_t n );
-extern ERRNO ws_flush( void );
-extern ERRNO ws_clear( void ); 
+#define PORTNAME_LEN                    255
+#define TRACE_MAX_RECORD                255                                     // bytes per record
+
+
+typedef struct _serport
+    {
+    int handle;                                                                 // the serial port's handle
+    char name[PORTNAME_LEN+1];                                                  // the serial port's name
+    unsigned long bytes_tx;                                                     // bytes written since last ws_clear_counters()
+    unsigned long bytes_rx;                                                     // bytes read since last ws_clear_counters()
+    long response_timeout;                                                      // [us]
+    long byte_timeout;                                                          // [us]
+    FILE * trace;                                                               // recording to this file if set
+    struct timespec trace_time;                                                 // time of the last record, 0 = none yet
+    FILE * replay;                                                              // replaying this file instead of the port if set
+    int replay_speed;                                                           // 1 = real time, 0 = no delays
+    uint8_t record[TRACE_MAX_RECORD];                                           // current record of the replay
+    int record_dir;                                                             // direction of the current record, 0 = none
+    int record_len;
+    int record_pos;                                                             // bytes of the current record already used
+    } serport_t;
+
+
+extern ERRNO ws_init( serport_t * p_port, char * name );
+extern void ws_deinit( serport_t * p_port );
+extern ERRNO ws_open( serport_t * p_port );
+extern ERRNO ws_close( serport_t * p_port );
+extern size_t ws_read( serport_t * p_port, uint8_t * dst, size_t n );
+extern size_t ws_write( serport_t * p_port, uint8_t * src, size_t n );
+extern ERRNO ws_flush( serport_t * p_port );
+extern ERRNO ws_clear( serport_t * p_port ); 
+extern void ws_counters( serport_t * p_port, unsigned long * tx, unsigned long * rx );
+extern void ws_clear_counters( serport_t * p_port );
+extern void ws_set_timeouts( serport_t * p_port, long response, long byte );
+extern ERRNO ws_set_trace( serport_t * p_port, char const * record, char const * replay, int speed );
 
 
 
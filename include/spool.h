@@ -0,0 +1,105 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        spool.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Lines for the log files on the server kept on disk until
+                they are sent
+
+    details     If the server can't be reached the lines are appended to
+                the spool of the station : a segment file that only grows
+                and a checkpoint file that holds the offset of the first
+                record not yet sent. Once the server answers again the
+                records are read from the checkpoint on and the lines of
+                one log file are sent with one append.
+
+                A record is a header line "<log file>\t<length>\n" and
+                length bytes of text.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The segment is emptied as soon as all of its records are
+                sent. A record that was cut off by a crash is removed when
+                the spool is opened.
+
+    todo
+
+*/
+
+
+#ifndef __SPOOL_H__
+#define __SPOOL_H__
+
+
+#include <pthread.h>
+#include "errors.h"
+
+
+#define SPOOL_SEGMENT                           "upload.seg"                    // appended to [File] spool
+#define SPOOL_CHECKPOINT                        "upload.chk"
+#define SPOOL_BATCH                             ( 256 * 1024 )                  // [bytes] of text sent with one append at most
+
+
+typedef struct _spoolstat
+    {
+    long spooled;                                                               // records put in
+    long dropped;                                                               // records refused because the spool was full
+    long pending;                                                               // [bytes] of the records not yet sent
+    long flushes;                                                               // appends of spooled records
+    long long flushed;                                                          // [bytes] of text sent
+    long long flush_time;                                                       // [ms] spent on the appends
+    } spoolstat_t;
+
+
+typedef struct _spool
+    {
+    int active;                                                                 // 0 : no spool, set by spool_open()
+    int fd;                                                                     // segment
+    char segment[160];
+    char checkpoint[160];
+    long max;                                                                   // [bytes] of the records not yet sent
+    long size;                                                                  // [bytes] of the segment
+    long done;                                                                  // [bytes] the checkpoint, records before it are sent
+    long next;                                                                  // end of the records returned by spool_peek()
+    long next_text;                                                             // [bytes] of their text
+    pthread_mutex_t lock;
+    spoolstat_t stats;
+    } spool_t;
+
+
+extern ERRNO spool_open( spool_t * p_spool, char const * path, long max );
+extern void spool_close( spool_t * p_spool );
+extern int spool_active( spool_t * p_spool );
+extern long spool_pending( spool_t * p_spool );
+extern ERRNO spool_add( spool_t * p_spool, char const * logfile, char const * text );
+extern ERRNO spool_peek( spool_t * p_spool, char * logfile, size_t size, char ** pp_text );
+extern void spool_commit( spool_t * p_spool, long ms );
+extern void spool_stats( spool_t * p_spool, spoolstat_t * p_stats );
+
+
+#endif                                                                          // __SPOOL_H__
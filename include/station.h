@@ -0,0 +1,91 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        station.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Context of one weather station
+
+    details     A station_t holds everything that belongs to one WS2300 : its
+                configuration, the serial port and the shadow of its memory,
+                the sampled fields, the position in its history ring and the
+                latest weather data. All functions that work on a station
+                get it as their first parameter, so one process can drive
+                several stations.
+
+                The single station programs use station_default(), the
+                functions of data.c without a station parameter refer to it.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note
+
+    todo
+
+*/
+
+
+#ifndef __STATION_H__
+#define __STATION_H__
+
+
+#include "errors.h"
+#include "data.h"
+#include "ws23k.h"
+#include "ws23kcom.h"
+#include "ws23kclock.h"
+#include "ws23khist.h"
+#include "ws23ksched.h"
+#include "ws23kwind.h"
+#include "spool.h"
+
+
+typedef struct _ftp ftp_t;                                                      // see ftp.c
+
+
+struct _station                                                                 // typedef station_t in ws23k.h
+    {
+    config_t config;                                                            // read from the station's .ini file
+    link_t link;                                                                // serial port, shadow and statistics
+    sched_t sched;                                                              // fields sampled between the reads
+    histpos_t history;                                                          // last fetched history record
+    windstat_t wind;                                                            // wind samples of the last ten minutes
+    winhash_t hashes;                                                           // telegrams of the last ReadData()
+    alarms_t alarms;                                                            // flags of the last PollAlarms()
+    clocksync_t clock;                                                          // drift of the station's clock
+    ftp_t * p_ftp;                                                              // curl handle, see FtpOpen()
+    spool_t spool;                                                              // log lines not yet sent, see spool_open()
+    weatherdata_t weatherdata;                                                  // values of the last ReadData()
+    };
+
+
+extern station_t * station_default( void );
+extern ERRNO station_init( station_t * p_station, char const * name );
+extern void station_deinit( station_t * p_station );
+
+
+#endif  // __STATION_H__
@@ -0,0 +1,89 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        upload.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Transfers to the ftp server done by one upload thread
+
+    details     The threads that read the stations render the data string
+                and the log lines and put them into the upload queue, the
+                upload thread takes them out and transfers them. A slow or
+                hung server delays only the upload thread, the stations are
+                read on time.
+
+                A payload is a copy made by upload_push() or
+                upload_append(), the upload thread frees it after the
+                transfer.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Putting a payload in never waits. If the queue is full the
+                oldest payload is dropped and counted.
+
+    todo
+
+*/
+
+
+#ifndef __UPLOAD_H__
+#define __UPLOAD_H__
+
+
+#include <stdatomic.h>
+#include "errors.h"
+#include "ws23k.h"
+
+
+#define UPLOAD_SLOTS                            64                              // a power of 2
+
+
+typedef struct _uploadstat
+    {
+    long queued;                                                                // payloads put in
+    long dropped;                                                               // payloads lost because the queue was full
+    long sent;                                                                  // payloads and batches
+    long failed;
+    long batched;                                                               // payloads of log lines put into a batch
+    long flushes;                                                               // batches sent
+    int depth;                                                                  // payloads waiting now
+    int depth_max;
+    long latency_last;                                                          // [ms] from putting in to the end of the transfer
+    long latency_min;                                                           // [ms]
+    long latency_max;                                                           // [ms]
+    long long latency_sum;                                                      // [ms] of all payloads sent
+    } uploadstat_t;
+
+
+extern ERRNO upload_init( void );
+extern void upload_deinit( void );
+extern ERRNO upload_push( station_t * p_station, char const * data, atomic_uint * p_resend );
+extern ERRNO upload_append( station_t * p_station, char const * logfile, char const * text );
+extern void upload_stats( uploadstat_t * p_stats );
+
+
+#endif                                                                          // __UPLOAD_H__
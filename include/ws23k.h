@@ -46,7 +46,10 @@
 #define __WS23K_H__
 
 
+#include "errors.h"
 #include "locals.h"
+#include "ws23kclock.h"
+#include "ws23kwind.h"
 #include <stdint.h>
 
 
@@ -67,6 +70,23 @@
 #define RESET_MIN                               0x01
 #define RESET_MAX                               0x02
 
+#define CHG_TIME                                0x0001                          // values of weatherdata_t.changed
+#define CHG_TEMP                                0x0002
+#define CHG_TEMP_IN                             0x0004
+#define CHG_PRESSURE                            0x0008
+#define CHG_HUMIDITY                            0x0010
+#define CHG_HUMIDITY_IN                         0x0020
+#define CHG_WIND                                0x0040                          // direction, dir, speed and sensor_connected
+#define CHG_DEWPOINT                            0x0080
+#define CHG_WINDCHILL                           0x0100
+#define CHG_RAIN_1H                             0x0200
+#define CHG_RAIN_24H                            0x0400
+#define CHG_WIND_STATS                          0x0800
+#define CHG_ALL                                 0x0fff                          // all values
+#define CHG_ALARM                               0x1000                          // an alarm flag changed, not part of CHG_ALL
+
+#define ALARM_STORM_WARNING                     0x00000004UL                    // bit of the alarm set flags
+
 #define KMH                                        3.6                          // * m/s
 #define KNOTS                                      1.943844492                  // * m/s
 
@@ -97,60 +117,83 @@ typedef struct _weatherdata
     double rain_per_hour;
     double rain_per_day;
     char act_time[11];
-    } weatherdata_t;
+    windsummary_t wind;                                                         // of the last WIND_WINDOW seconds
+    clocksummary_t clock;                                                       // station's clock against the host's clock
+    unsigned long alarm_set;                                                    // alarm set flags of the last PollAlarms()
+    unsigned long alarm_active;                                                 // alarm active flags of the last PollAlarms()
+    unsigned int changed;                                                       // CHG_xxx, values that differ from the previous ReadData()
+    } weatherdata_t;
+
+
+typedef struct _alarms
+    {
+    int valid;                                                                  // the flags were read at least once
+    int flipped;                                                                // a flag changed since the last ReadData()
+    unsigned long set;                                                          // FLD_ALARM_SET
+    unsigned long active;                                                       // FLD_ALARM_ACTIVE
+    } alarms_t;
+
+
+typedef struct _station station_t;                                              // see station.h
 
 
-extern weatherdata_t * get_weatherdata_ptr( void );
+extern weatherdata_t * get_weatherdata_ptr( station_t * p_station );
 
 
 // data dirctcly from weather station
-extern double temperature_indoor( void );
-extern void temperature_indoor_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void temperature_indoor_reset( uint8_t minmax );
-extern double temperature_outdoor( void );
-extern void temperature_outdoor_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void temperature_outdoor_reset( uint8_t minmax );
-extern double dewpoint( void );
-extern void dewpoint_minmax( double * dp_min, double * dp_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void dewpoint_reset( uint8_t minmax );
-extern int humidity_indoor( void );
-extern int humidity_indoor_all( int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void humidity_indoorr_reset( uint8_t minmax );
-extern int humidity_outdoor( void );
-extern int humidity_outdoor_all( int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void humidity_outdoor_reset( uint8_t minmax );
-extern double wind_current( double * winddir );
-extern double wind_current_flags( double * winddir, int * sensor_connected, int * minimum_code );
-extern double wind_all( int * winddir_index, double * winddir );
-extern double wind_minmax( double * wind_min, double * wind_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void wind_reset( uint8_t minmax );
-extern double windchill( void );
-extern void windchill_minmax( double * wc_min, double * wc_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void windchill_reset( uint8_t minmax );
-extern double rain_1h( void );
-extern double rain_1h_all( double * rain_max, struct timestamp * time_max );
-extern void rain_1h_max_reset( void );
-extern void rain_1h_reset( void );
-extern double rain_24h( void );
-extern double rain_24h_all( double * rain_max, struct timestamp * time_max );
-extern void rain_24h_max_reset( void );
-extern void rain_24h_reset( void );
-extern double rain_total( void );
-extern double rain_total_all( struct timestamp * time_since );
-extern void rain_total_reset( void );
-extern double rel_pressure( void );
-extern void rel_pressure_minmax( double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max );
-extern double abs_pressure( void );
-extern void abs_pressure_minmax( double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max );
-extern void pressure_reset( char minmax );
-extern double pressure_correction( void );
-extern void tendency_forecast( int * tendency, int * forecast );
-extern void light( int set );
+extern double temperature_indoor( station_t * p_station );
+extern void temperature_indoor_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void temperature_indoor_reset( station_t * p_station, uint8_t minmax );
+extern double temperature_outdoor( station_t * p_station );
+extern void temperature_outdoor_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void temperature_outdoor_reset( station_t * p_station, uint8_t minmax );
+extern double dewpoint( station_t * p_station );
+extern void dewpoint_minmax( station_t * p_station, double * dp_min, double * dp_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void dewpoint_reset( station_t * p_station, uint8_t minmax );
+extern int humidity_indoor( station_t * p_station );
+extern int humidity_indoor_all( station_t * p_station, int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void humidity_indoorr_reset( station_t * p_station, uint8_t minmax );
+extern int humidity_outdoor( station_t * p_station );
+extern int humidity_outdoor_all( station_t * p_station, int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void humidity_outdoor_reset( station_t * p_station, uint8_t minmax );
+extern double wind_current( station_t * p_station, double * winddir );
+extern double wind_current_flags( station_t * p_station, double * winddir, int * sensor_connected, int * minimum_code );
+extern double wind_all( station_t * p_station, int * winddir_index, double * winddir );
+extern double wind_minmax( station_t * p_station, double * wind_min, double * wind_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void wind_reset( station_t * p_station, uint8_t minmax );
+extern double windchill( station_t * p_station );
+extern void windchill_minmax( station_t * p_station, double * wc_min, double * wc_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void windchill_reset( station_t * p_station, uint8_t minmax );
+extern double rain_1h( station_t * p_station );
+extern double rain_1h_all( station_t * p_station, double * rain_max, struct timestamp * time_max );
+extern void rain_1h_max_reset( station_t * p_station );
+extern void rain_1h_reset( station_t * p_station );
+extern double rain_24h( station_t * p_station );
+extern double rain_24h_all( station_t * p_station, double * rain_max, struct timestamp * time_max );
+extern void rain_24h_max_reset( station_t * p_station );
+extern void rain_24h_reset( station_t * p_station );
+extern double rain_total( station_t * p_station );
+extern double rain_total_all( station_t * p_station, struct timestamp * time_since );
+extern void rain_total_reset( station_t * p_station );
+extern double rel_pressure( station_t * p_station );
+extern void rel_pressure_minmax( station_t * p_station, double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max );
+extern double abs_pressure( station_t * p_station );
+extern void abs_pressure_minmax( station_t * p_station, double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max );
+extern void pressure_reset( station_t * p_station, char minmax );
+extern void minmax_reset_all( station_t * p_station );
+extern double pressure_correction( station_t * p_station );
+extern void tendency_forecast( station_t * p_station, int * tendency, int * forecast );
+extern void light( station_t * p_station, int set );
+extern ERRNO alarm_flags( station_t * p_station, unsigned long * set, unsigned long * active );
+extern ERRNO alarm_thresholds( station_t * p_station, int const * fields, double * values, int n );
+extern ERRNO alarm_set_thresholds( station_t * p_station, int const * fields, double const * values, int n );
 
 // data recalculated
-extern double GetRelPressure( void );
+extern double GetRelPressure( weatherdata_t const * p_weatherdata );
 //  data pressed into one structure (get it using get_weatherdata_ptr())
-extern void ReadData( void );
+extern int PollAlarms( station_t * p_station );
+extern void SampleData( station_t * p_station );
+extern void ReadData( station_t * p_station );
 
 
 #endif  // __WS23K_H__
@@ -0,0 +1,97 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+
+    file        ws23kclock.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Drift of the station's clock against the host's clock
+
+    details     Each reading of the station's clock gives one measurement of
+                the offset between the station's clock and CLOCK_REALTIME.
+                The station counts whole seconds only, so the measurements
+                are smoothed :
+                    - offset, exponentially weighted moving average
+                    - drift rate, from two smoothed offsets at least
+                      CLOCK_RATE_BASE seconds apart, smoothed too
+                The estimate converts timestamps of the station (history
+                records) into host time.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        A jump of more than CLOCK_JUMP seconds means the clock was
+                set (DCF77 or by hand), the estimate starts anew.
+
+    todo
+
+*/
+
+
+#ifndef __WS23KCLOCK_H__
+#define __WS23KCLOCK_H__
+
+
+#include <time.h>
+
+
+#define CLOCK_WEIGHT                            8                               // a new offset counts 1 / CLOCK_WEIGHT
+#define CLOCK_JUMP                              5.0                             // [s] the clock was set, more than a second and a telegram
+#define CLOCK_RATE_BASE                         86400                           // [s] one day, the error of the rate is about 1 s / base
+#define CLOCK_RATE_WEIGHT                       4                               // a new rate counts 1 / CLOCK_RATE_WEIGHT
+
+
+typedef struct _clocksync
+    {
+    int samples;                                                                // measurements since the start or the last jump
+    double host;                                                                // [s] host time of the last measurement
+    double offset;                                                              // [s] station - host, smoothed
+    double last;                                                                // [s] station - host, last measurement
+    double base_host;                                                           // [s] host time of base_offset
+    double base_offset;                                                         // [s] smoothed offset the rate is measured against
+    int rated;                                                                  // 1 if rate is valid
+    double rate;                                                                // [s/day] the station's clock gains
+    int jumps;                                                                  // number of times the clock was set
+    } clocksync_t;
+
+
+typedef struct _clocksummary
+    {
+    int samples;                                                                // 0 = the clock was not read yet
+    double offset;                                                              // [s] station - host
+    int rated;                                                                  // 1 if rate is valid
+    double rate;                                                                // [s/day]
+    int jumps;
+    } clocksummary_t;
+
+
+extern void clocksync_init( clocksync_t * p_clock );
+extern void clocksync_add( clocksync_t * p_clock, double host, time_t station );
+extern void clocksync_get( clocksync_t const * p_clock, clocksummary_t * p_summary );
+extern time_t clocksync_to_host( clocksync_t const * p_clock, time_t station );
+
+
+#endif                                                                          // __WS23KCLOCK_H__
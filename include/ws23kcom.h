@@ -47,15 +47,118 @@
 
 
 #include <stdint.h>
+#include "sercom.h"
 
 
 #define BIT_SET                                 0x12
 #define BIT_CLEAR                               0x32
-
-
-extern int read_data( uint8_t * data, int addr, int n );
-extern int write_data( uint8_t * data, int addr, int n, uint8_t encode_constant );
-extern void handle_comm_error( ERRNO err );
+#define WRITE_NIBBLE                            0x42
+
+#define PLAN_MAX_FIELDS                         64
+#define PLAN_MAX_WINDOWS                        32
+#define PLAN_WINDOW_BYTES                       15                              // the station can't send more in a single telegram
+#define PLAN_HASHES                             32                              // telegrams remembered by a winhash_t
+
+#define WPLAN_MAX_WRITES                        64
+#define WPLAN_MAX_NIBBLES                       512
+#define WPLAN_RUN_NIBBLES                       80                              // longest single write telegram
+
+#define MEMORY_NIBBLES                          0x1400                          // the station's memory 0x0000 .. 0x13ff
+#define IMAGE_BYTES                             (MEMORY_NIBBLES / 2)            // memory image, two nibbles per byte
+
+#define SHADOW_NEVER                            0                               // always read from the station
+#define SHADOW_FOREVER                          -1                              // read once after start
+
+
+typedef struct _commstat
+    {
+    int transactions;                                                           // read and write telegrams sent
+    int retries;                                                                // telegrams that had to be repeated
+    int resyncs;                                                                // resets sent to get the link in sync again
+    int cache_hits;                                                             // fields served from the shadow
+    int cache_misses;                                                           // fields read from the station
+    int windows_unchanged;                                                      // telegrams with the same bytes as the last time
+    unsigned long bytes_tx;                                                     // bytes written to the station
+    unsigned long bytes_rx;                                                     // bytes read from the station
+    } commstat_t;
+
+
+typedef struct _link
+    {
+    serport_t port;
+    commstat_t stats;                                                           // statistics since last clear_comm_stats()
+    int synced;                                                                 // station is waiting for a new command
+    volatile int stop;                                                          // set by link_stop(), no more retries
+    uint8_t image[IMAGE_BYTES];                                                 // memory image or shadow, two nibbles per byte
+    int image_loaded;                                                           // read from the image instead of the station
+    long shadow_time[MEMORY_NIBBLES];                                           // [s] monotonic time a nibble was transferred, 0 = unknown
+    int shadow_age[MEMORY_NIBBLES];                                             // [s] maximum age of a nibble, SHADOW_NEVER or SHADOW_FOREVER
+    } link_t;
+
+
+typedef struct _winhash
+    {
+    int n;                                                                      // entries used
+    int next;                                                                   // entry to replace if all are used
+    int addr[PLAN_HASHES];                                                      // nibble address of the telegram
+    int bytes[PLAN_HASHES];                                                     // number of bytes of the telegram
+    uint32_t hash[PLAN_HASHES];                                                 // FNV-1a of the bytes last read
+    } winhash_t;
+
+
+typedef struct _readplan
+    {
+    int n_fields;
+    int field_addr[PLAN_MAX_FIELDS];                                            // nibble address of each requested field
+    int field_bytes[PLAN_MAX_FIELDS];                                           // number of bytes requested for each field
+    int field_cached[PLAN_MAX_FIELDS];                                          // field is served from the shadow
+    int n_windows;
+    int window_addr[PLAN_MAX_WINDOWS];                                          // nibble address of each telegram
+    int window_bytes[PLAN_MAX_WINDOWS];                                         // number of bytes read by each telegram
+    int window_ok[PLAN_MAX_WINDOWS];                                            // telegram successfully read
+    int window_changed[PLAN_MAX_WINDOWS];                                       // bytes differ from the last read, see plan_compare()
+    double window_time[PLAN_MAX_WINDOWS];                                       // [s] CLOCK_REALTIME when the telegram was read
+    uint8_t window_data[PLAN_MAX_WINDOWS][PLAN_WINDOW_BYTES];
+    link_t * p_link;                                                            // link of plan_read(), holds the shadow of the cached fields
+    winhash_t * p_hashes;                                                       // telegrams of the last read, 0 = every telegram changed
+    } readplan_t;
+
+
+typedef struct _writeplan
+    {
+    int n_writes;
+    int n_nibbles;                                                              // nibbles used in data
+    int write_addr[WPLAN_MAX_WRITES];                                           // nibble address of each write
+    int write_nibbles[WPLAN_MAX_WRITES];                                        // number of nibbles of each write
+    int write_offset[WPLAN_MAX_WRITES];                                         // first nibble of each write in data
+    int write_ok[WPLAN_MAX_WRITES];                                             // write verified by the read-back
+    uint8_t data[WPLAN_MAX_NIBBLES];                                            // one nibble per byte
+    } writeplan_t;
+
+
+
+
+extern ERRNO link_init( link_t * p_link, char * port );
+extern int read_data( link_t * p_link, uint8_t * data, int addr, int n );
+extern int write_data( link_t * p_link, uint8_t * data, int addr, int n, uint8_t encode_constant );
+extern void handle_comm_error( link_t * p_link, ERRNO err );
+extern void link_invalidate( link_t * p_link );
+extern void link_stop( link_t * p_link );
+extern ERRNO link_load_image( link_t * p_link, char const * name );
+extern uint8_t const * link_image( link_t * p_link );
+extern void shadow_set_age( link_t * p_link, int addr, int nibbles, int age );
+extern void plan_clear( readplan_t * p_plan );
+extern int plan_add( readplan_t * p_plan, int addr, int n );
+extern void plan_compare( readplan_t * p_plan, winhash_t * p_hashes );
+extern ERRNO plan_read( link_t * p_link, readplan_t * p_plan );
+extern int plan_get( readplan_t const * p_plan, uint8_t * data, int addr, int n );
+extern int plan_changed( readplan_t const * p_plan, int addr, int n );
+extern double plan_time( readplan_t const * p_plan, int addr, int n );
+extern void wplan_clear( writeplan_t * p_plan );
+extern int wplan_add( writeplan_t * p_plan, int addr, uint8_t const * nibbles, int n );
+extern ERRNO wplan_write( link_t * p_link, writeplan_t * p_plan );
+extern void get_comm_stats( link_t * p_link, commstat_t * p_stats );
+extern void clear_comm_stats( link_t * p_link );
 
 
 #endif  // __H_file__
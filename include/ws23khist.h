@@ -0,0 +1,103 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23khist.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       History records of the WS2300 weather station
+
+    details     The station saves a record every history interval into a
+                ring of 175 records. The records that are new since the last
+                call of history_sync() are read with as few telegrams as
+                possible.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The record format is taken from doc/memory_map_2300.txt
+
+    todo
+
+*/
+
+
+#ifndef __WS23KHIST_H__
+#define __WS23KHIST_H__
+
+
+#include <time.h>
+#include "errors.h"
+#include "ws23k.h"
+#include "ws23kcom.h"
+
+
+#define HISTORY_RECORDS                         175                             // size of the ring
+#define HISTORY_RECORD_NIBBLES                  19
+#define HISTORY_ADDRESS                         0x6c6                           // record 0
+#define HISTORY_RAIN_STEP                       0.518                           // [mm] per rain count
+
+
+typedef struct _history_info
+    {
+    int interval;                                                               // [min] between two records
+    int countdown;                                                              // [min] until the next record is saved
+    struct timestamp last_time;                                                 // time of the last record
+    int last_record;                                                            // index of the last record 0 .. 174
+    int records;                                                                // number of saved records
+    } history_info_t;
+
+
+typedef struct _history_record
+    {
+    int index;                                                                  // index in the ring
+    time_t time;                                                                // time the record was saved
+    double temperature_in;                                                      // [°C]
+    double temperature_out;                                                     // [°C]
+    double pressure;                                                            // absolute pressure [hPa]
+    int humidity_in;                                                            // [%]
+    int humidity_out;                                                           // [%]
+    int rain_count;                                                             // raw rain counter, HISTORY_RAIN_STEP mm per step
+    double speed;                                                               // wind speed [m/sec]
+    double direction;                                                           // wind direction [°]
+    } history_record_t;
+
+
+typedef struct _histpos
+    {
+    int index;                                                                  // index of the last fetched record, -1 = none
+    time_t time;                                                                // time of the last fetched record
+    } histpos_t;
+
+
+extern ERRNO history_info( link_t * p_link, history_info_t * p_info );
+extern int history_sync( histpos_t * p_pos, link_t * p_link, history_record_t * records, int max );
+extern void history_get_position( histpos_t const * p_pos, int * index, time_t * time );
+extern void history_set_position( histpos_t * p_pos, int index, time_t time );
+extern ERRNO history_load_position( histpos_t * p_pos, char const * name );
+extern ERRNO history_save_position( histpos_t const * p_pos, char const * name );
+
+
+#endif                                                                          // __WS23KHIST_H__
@@ -0,0 +1,191 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kmap.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Memory map of the WS2300 weather station
+
+    details     Every known field of the station's memory is described by
+                its address, its number of nibbles, its encoding and a
+                linear conversion. One decoder serves all fields.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The addresses are taken from doc/memory_map_2300.txt
+
+    todo
+
+*/
+
+
+#ifndef __WS23KMAP_H__
+#define __WS23KMAP_H__
+
+
+#include <stdint.h>
+#include "errors.h"
+#include "ws23k.h"
+#include "ws23kcom.h"
+
+
+#define ENC_BCD                                 0                               // decimal digits, least significant nibble first
+#define ENC_BIN                                 1                               // binary number, least significant nibble first
+#define ENC_TIMESTAMP                           2                               // BCD minute, hour, day, month, year
+#define ENC_CLOCK                               3                               // BCD minute, hour, weekday, day, month, year
+
+#define REFRESH_LIVE                            0                               // current measurements
+#define REFRESH_MINMAX                          1                               // minimum and maximum values with their time
+#define REFRESH_SETTINGS                        2                               // calibration and settings
+
+#define FLD_TEMP_IN                             0
+#define FLD_TEMP_IN_MIN                         1
+#define FLD_TEMP_IN_MAX                         2
+#define FLD_TEMP_IN_TMIN                        3
+#define FLD_TEMP_IN_TMAX                        4
+#define FLD_TEMP_OUT                            5
+#define FLD_TEMP_OUT_MIN                        6
+#define FLD_TEMP_OUT_MAX                        7
+#define FLD_TEMP_OUT_TMIN                       8
+#define FLD_TEMP_OUT_TMAX                       9
+#define FLD_WINDCHILL                          10
+#define FLD_WINDCHILL_MIN                      11
+#define FLD_WINDCHILL_MAX                      12
+#define FLD_WINDCHILL_TMIN                     13
+#define FLD_WINDCHILL_TMAX                     14
+#define FLD_DEWPOINT                           15
+#define FLD_DEWPOINT_MIN                       16
+#define FLD_DEWPOINT_MAX                       17
+#define FLD_DEWPOINT_TMIN                      18
+#define FLD_DEWPOINT_TMAX                      19
+#define FLD_HUM_IN                             20
+#define FLD_HUM_IN_MIN                         21
+#define FLD_HUM_IN_MAX                         22
+#define FLD_HUM_IN_TMIN                        23
+#define FLD_HUM_IN_TMAX                        24
+#define FLD_HUM_OUT                            25
+#define FLD_HUM_OUT_MIN                        26
+#define FLD_HUM_OUT_MAX                        27
+#define FLD_HUM_OUT_TMIN                       28
+#define FLD_HUM_OUT_TMAX                       29
+#define FLD_RAIN_24H                           30
+#define FLD_RAIN_24H_MAX                       31
+#define FLD_RAIN_24H_TMAX                      32
+#define FLD_RAIN_1H                            33
+#define FLD_RAIN_1H_MAX                        34
+#define FLD_RAIN_1H_TMAX                       35
+#define FLD_RAIN_TOTAL                         36
+#define FLD_RAIN_TOTAL_TRESET                  37
+#define FLD_WIND_MIN                           38
+#define FLD_WIND_MAX                           39
+#define FLD_WIND_TMIN                          40
+#define FLD_WIND_TMAX                          41
+#define FLD_WIND_FLAGS                         42
+#define FLD_WIND_MINCODE                       43
+#define FLD_WIND_SPEED                         44
+#define FLD_WIND_DIR                           45
+#define FLD_WIND_DIR1                          46
+#define FLD_WIND_DIR2                          47
+#define FLD_WIND_DIR3                          48
+#define FLD_WIND_DIR4                          49
+#define FLD_WIND_DIR5                          50
+#define FLD_PRESS_ABS                          51
+#define FLD_PRESS_REL                          52
+#define FLD_PRESS_CORR                         53
+#define FLD_PRESS_ABS_MIN                      54
+#define FLD_PRESS_REL_MIN                      55
+#define FLD_PRESS_ABS_MAX                      56
+#define FLD_PRESS_REL_MAX                      57
+#define FLD_PRESS_TMIN                         58
+#define FLD_PRESS_TMAX                         59
+#define FLD_CLOCK                              60
+#define FLD_FORECAST                           61
+#define FLD_TENDENCY                           62
+#define FLD_RAIN_24H_AREA                      63
+#define FLD_RAIN_1H_AREA                       64
+#define FLD_SETTINGS                           65
+#define FLD_HIST_INTERVAL                      66
+#define FLD_HIST_COUNTDOWN                     67
+#define FLD_HIST_TLAST                         68
+#define FLD_HIST_LAST                          69
+#define FLD_HIST_COUNT                         70
+#define FLD_ALARM_SET                          71
+#define FLD_ALARM_ACTIVE                       72
+#define FLD_ALARM_TEMP_IN_LO                   73                               // first alarm threshold
+#define FLD_ALARM_TEMP_IN_HI                   74
+#define FLD_ALARM_TEMP_OUT_LO                  75
+#define FLD_ALARM_TEMP_OUT_HI                  76
+#define FLD_ALARM_WINDCHILL_LO                 77
+#define FLD_ALARM_WINDCHILL_HI                 78
+#define FLD_ALARM_DEWPOINT_LO                  79
+#define FLD_ALARM_DEWPOINT_HI                  80
+#define FLD_ALARM_HUM_IN_LO                    81
+#define FLD_ALARM_HUM_IN_HI                    82
+#define FLD_ALARM_HUM_OUT_LO                   83
+#define FLD_ALARM_HUM_OUT_HI                   84
+#define FLD_ALARM_RAIN_24H                     85
+#define FLD_ALARM_RAIN_1H                      86
+#define FLD_ALARM_WIND_LO                      87
+#define FLD_ALARM_WIND_HI                      88
+#define FLD_ALARM_PRESS_LO                     89
+#define FLD_ALARM_PRESS_HI                     90                               // last alarm threshold
+#define FLD_CLOCK_SECONDS                      91                               // BCD hhmmss
+#define FLD_NUM_OF_FIELDS                      92
+
+
+typedef struct _field
+    {
+    int id;                                                                     // FLD_xxx, equals the index into the table
+    char const * name;
+    int address;                                                                // nibble address in the station's memory
+    int nibbles;                                                                // number of nibbles
+    int encoding;                                                               // ENC_xxx
+    double scale;                                                               // value = raw * scale + offset
+    double offset;
+    int refresh;                                                                // REFRESH_xxx, how long the shadow may be used
+    } field_t;
+
+
+extern field_t const * map_field( int field );
+extern int map_address( int field );
+extern int map_bytes( int field );
+extern unsigned long map_raw( int field, uint8_t const * data, int base );
+extern double map_value( int field, uint8_t const * data, int base );
+extern void map_timestamp( int field, uint8_t const * data, int base, struct timestamp * ts );
+extern void map_nibbles( int field, uint8_t const * data, int base, uint8_t * dst );
+extern void map_encode( int field, double value, uint8_t * dst );
+extern void map_encode_timestamp( struct timestamp const * ts, uint8_t * dst );
+extern int map_plan( readplan_t * p_plan, int field );
+extern void map_set_refresh( link_t * p_link, int refresh, int age );
+extern ERRNO map_get_raw( readplan_t const * p_plan, int field, unsigned long * raw );
+extern ERRNO map_get( readplan_t const * p_plan, int field, double * value );
+extern ERRNO map_get_nibbles( readplan_t const * p_plan, int field, uint8_t * dst );
+extern ERRNO map_get_timestamp( readplan_t const * p_plan, int field, struct timestamp * ts );
+extern int map_changed( readplan_t const * p_plan, int field );
+
+
+#endif                                                                          // __WS23KMAP_H__
@@ -0,0 +1,100 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23ksched.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Multi-rate sampling of the WS2300 weather station
+
+    details     Every field of the memory map can be given its own sampling
+                period. sched_tick() reads the fields that are due with a
+                single read plan and keeps the latest value of each field
+                together with the time it was read.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note
+
+    todo
+
+*/
+
+
+#ifndef __WS23KSCHED_H__
+#define __WS23KSCHED_H__
+
+
+#include <time.h>
+#include "errors.h"
+#include "ws23k.h"
+#include "ws23kcom.h"
+#include "ws23kmap.h"
+
+
+#define SAMPLE_WIND                             0                               // speed, direction and sensor flags
+#define SAMPLE_TEMPERATURE                      1                               // temperatures, dewpoint and windchill
+#define SAMPLE_HUMIDITY                         2
+#define SAMPLE_PRESSURE                         3
+#define SAMPLE_RAIN                             4
+#define SAMPLE_MINMAX                           5                               // minimum and maximum values with their time
+#define SAMPLE_NUM_OF_GROUPS                    6
+
+#define SAMPLE_OFF                              0                               // period of a field that is not sampled
+
+
+typedef struct _sample
+    {
+    int valid;                                                                  // the field was read at least once
+    time_t time;                                                                // time the field was read
+    unsigned long raw;                                                          // raw value
+    double value;                                                               // value in the field's unit
+    struct timestamp ts;                                                        // timestamp and clock fields only
+    } sample_t;
+
+
+typedef struct _sched
+    {
+    int period[FLD_NUM_OF_FIELDS];                                              // [s] sampling period, SAMPLE_OFF
+    long long due[FLD_NUM_OF_FIELDS];                                           // [ms] since the epoch the field is due
+    sample_t samples[FLD_NUM_OF_FIELDS];                                        // latest value of each field
+    int ticks;                                                                  // calls of sched_tick() that read the station
+    int fields_read;                                                            // fields read by sched_tick()
+    winhash_t hashes;                                                           // telegrams of the last sched_tick()
+    } sched_t;
+
+
+extern void sched_set_period( sched_t * p_sched, int field, int period );
+extern int sched_period( sched_t const * p_sched, int field );
+extern void sched_set_group( sched_t * p_sched, int group, int period );
+extern int sched_active( sched_t const * p_sched );
+extern int sched_next( sched_t * p_sched );
+extern int sched_tick( sched_t * p_sched, link_t * p_link );
+extern sample_t const * sched_sample( sched_t const * p_sched, int field );
+extern void sched_stats( sched_t const * p_sched, int * ticks, int * fields );
+
+
+#endif                                                                          // __WS23KSCHED_H__
@@ -0,0 +1,106 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kwind.h
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Running wind statistics of the last ten minutes
+
+    details     Every valid wind sample (speed and direction, sampled or read
+                by ReadData()) is added to a ring of the last WIND_WINDOW
+                seconds. Kept up to date with each sample :
+                    - mean speed
+                    - peak gust and its time
+                    - vector mean direction, weighted by the speed
+                    - variability of the direction (Yamartino's sigma theta)
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Samples are kept in steps of one second, a second sample in
+                the same second is ignored, so the ring never holds more
+                than WIND_WINDOW samples.
+
+    todo
+
+*/
+
+
+#ifndef __WS23KWIND_H__
+#define __WS23KWIND_H__
+
+
+#include <time.h>
+
+
+#define WIND_WINDOW                             600                             // [s] ten minutes
+#define WIND_CALM                               0.3                             // [m/s] below this the direction is not used
+
+
+typedef struct _windsample
+    {
+    time_t time;
+    double speed;                                                               // [m/s]
+    double sin;                                                                 // of the direction, 0 if calm
+    double cos;                                                                 // of the direction, 0 if calm
+    } windsample_t;
+
+
+typedef struct _windstat
+    {
+    windsample_t ring[WIND_WINDOW];
+    int head;                                                                   // oldest sample
+    int count;
+    int peaks[WIND_WINDOW];                                                     // ring positions with falling speeds, the first one is the gust
+    int peak_head;
+    int peak_count;
+    int directions;                                                             // samples that were not calm
+    double sum_speed;                                                           // [m/s]
+    double sum_u;                                                               // speed * sin
+    double sum_v;                                                               // speed * cos
+    double sum_sin;
+    double sum_cos;
+    int added;                                                                  // samples since the sums were computed anew
+    } windstat_t;
+
+
+typedef struct _windsummary
+    {
+    int samples;                                                                // in the window, 0 = no wind values
+    double mean;                                                                // [m/s]
+    double gust;                                                                // [m/s]
+    time_t gust_time;
+    double direction;                                                           // [°] vector mean
+    double deviation;                                                           // [°] sigma theta
+    } windsummary_t;
+
+
+extern void windstat_init( windstat_t * p_wind );
+extern void windstat_add( windstat_t * p_wind, time_t t, double speed, double direction );
+extern void windstat_get( windstat_t * p_wind, time_t now, windsummary_t * p_summary );
+
+
+#endif                                                                          // __WS23KWIND_H__
@@ -43,9 +43,12 @@
 
 
 #include "data.h"
+#include "station.h"
 #include "ws23k.h"
+#include "ws23ksched.h"
 #include "password.h"
-#include <string.h>
+#include <stdlib.h>
+#include <string.h>
 #include <malloc.h>
 
 
@@ -77,29 +80,55 @@ static char const * the_variables[] =
     "rph",                                                                      // rain per hour
     "rpd",                                                                      // rain per day
     "dirstr",                                                                   // wind direction as text
-    "time"                                                                      // current time stamp
+    "time",                                                                     // current time stamp
+    "wind_avg10",                                                               // mean wind speed of the last ten minutes [m/sec]
+    "gust",                                                                     // peak wind speed of the last ten minutes [m/sec]
+    "gust_time",                                                                // time of the peak wind speed
+    "wind_dir10",                                                               // vector mean wind direction of the last ten minutes
+    "wind_dev10"                                                                // standard deviation of the wind direction
     };
-static int const max_var_length[] =                                             // maximum string lenght if variable is printed
-    { 0, 6, 6, 3, 3, 4, 5, 5, 2, 6, 6, 6, 6, 3, 11 };
+static unsigned int const var_changes[] =                                       // CHG_xxx a variable depends on, VAR_xxx order
+    {
+    0,
+    CHG_TEMP,
+    CHG_PRESSURE,
+    CHG_HUMIDITY,
+    CHG_WIND,
+    CHG_WIND,
+    CHG_WIND,
+    CHG_WIND,
+    CHG_WIND,
+    CHG_DEWPOINT,
+    CHG_WINDCHILL | CHG_WIND,                                                   // not printed without wind sensor
+    CHG_RAIN_1H,
+    CHG_RAIN_24H,
+    CHG_WIND,
+    CHG_TIME,
+    CHG_WIND_STATS | CHG_WIND,
+    CHG_WIND_STATS | CHG_WIND,
+    CHG_WIND_STATS | CHG_WIND,
+    CHG_WIND_STATS | CHG_WIND,
+    CHG_WIND_STATS | CHG_WIND
+    };
+static int const max_var_length[] =                                             // maximum string lenght if variable is printed, VAR_xxx order
+    { 0, 6, 6, 3, 5, 4, 5, 5, 2, 6, 6, 6, 6, 3, 11, 4, 4, 8, 5, 5 };
 
 static char const * the_default_init_file_name = "conf/weather23k.conf";
 static char const * the_default_com_port = "/dev/ttyS0";
 
 static char the_verbose_flag = 0;
 static char the_debug_flag = 0;
-static char the_com_port[128];
-static char the_log_path[128];
-static char the_ftp_server[256];
-static char the_user_name[128];
-static char the_ftp_log_path[128];
-static char the_key[MAX_PASSWORD_LENGTH];
-static char the_ftp_file[128] = { 0, };
-static char * the_init_file_name = 0;
-
-static struct _tokens * the_p_token_list = 0;
-static struct _tokens * the_p_token = 0;
-
-static char * the_ftp_string = 0;
+static char const * the_sample_groups[SAMPLE_NUM_OF_GROUPS] =                   // keys of the [Sample] section, SAMPLE_xxx order
+    {
+    "wind",
+    "temperature",
+    "humidity",
+    "pressure",
+    "rain",
+    "minmax"
+    };
+static char * the_init_file_names[STATIONS_MAX];                                // one station each, the first one is the default station
+static int the_init_files = 0;
 
 
 /*  function        void set_verbose( char set )
@@ -150,15 +179,51 @@ char is_debug( void )
     }
 
 
-/*  function        void set_ini_file( char * ini_file_name )
+/*  function        ERRNO set_ini_file( char * ini_file_name )
 
-    brief           set the initialization file name into a global variable
+    brief           adds an initialization file name to the list of stations
 
     param[in]       char * ini_file_name
-*/
-void set_ini_file( char * ini_file_name )
+
+    return          ERRNO
+*/
+ERRNO set_ini_file( char * ini_file_name )
     {
-    the_init_file_name = ini_file_name;
+    if( the_init_files >= STATIONS_MAX )
+        return ERR_TOO_MANY_STATIONS;
+
+    the_init_file_names[the_init_files++] = ini_file_name;
+    return NOERR;
+    }
+
+
+/*  function        int ini_files( void )
+
+    brief           returns the number of initialization files given by
+                    set_ini_file(), at least one station is always read
+
+    return          int
+*/
+int ini_files( void )
+    {
+    return ( the_init_files > 0 ) ? the_init_files : 1;
+    }
+
+
+/*  function        char * ini_file( int station )
+
+    brief           returns the initialization file name of a station
+
+    param[in]       int station, 0 .. ini_files() - 1
+
+    return          char *, 0 = default file
+*/
+char * ini_file( int station )
+    {
+    if( station < 0 || station >= the_init_files )
+        return 0;
+
+    return the_init_file_names[station];
     }
 
 
@@ -170,10 +235,228 @@ void set_ini_file( char * ini_file_name )
 */
 char * com_port( void )
     {
-    return the_com_port;
+    return station_default()->config.com_port;
     }
 
 
+/*  function        int persistent_port( void )
+
+    brief           returns if the serial port is kept open between cycles
+
+    return          int, boolean value : 0 = close and reopen every cycle
+*/
+int persistent_port( void )
+    {
+    return station_default()->config.persistent_port;
+    }
+
+
+/*  function        long response_timeout( void )
+
+    brief           returns the time to wait for the first byte of an answer
+                    of the weather station
+
+    return          long, [us], 0 = use default
+*/
+long response_timeout( void )
+    {
+    return station_default()->config.response_timeout;
+    }
+
+
+/*  function        long byte_timeout( void )
+
+    brief           returns the time to wait for each following byte of an
+                    answer of the weather station
+
+    return          long, [us], 0 = use default
+*/
+long byte_timeout( void )
+    {
+    return station_default()->config.byte_timeout;
+    }
+
+
+/*  function        char * trace_file( void )
+
+    brief           returns the name of the file the serial communication is
+                    recorded to
+
+    return          char *, file name, empty string = no recording
+*/
+char * trace_file( void )
+    {
+    return station_default()->config.trace_file;
+    }
+
+
+/*  function        char * replay_file( void )
+
+    brief           returns the name of a recorded trace that is replayed
+                    instead of using the serial port
+
+    return          char *, file name, empty string = use the serial port
+*/
+char * replay_file( void )
+    {
+    return station_default()->config.replay_file;
+    }
+
+
+/*  function        int replay_speed( void )
+
+    brief           returns the speed factor for replaying a trace
+
+    return          int, 1 = real time, n = n times faster, 0 = no delays
+*/
+int replay_speed( void )
+    {
+    return station_default()->config.replay_speed;
+    }
+
+
+/*  function        char * image_file( void )
+
+    brief           returns the name of a memory image written by
+                    weather23k-dump that is used instead of the station
+
+    return          char *, file name, empty string = use the station
+*/
+char * image_file( void )
+    {
+    return station_default()->config.image_file;
+    }
+
+
+/*  function        int cache_live( void )
+
+    brief           returns how long current measurements may be taken from
+                    the shadow of the station's memory
+
+    return          int, [s], 0 = always read, -1 = read once
+*/
+int cache_live( void )
+    {
+    return station_default()->config.cache_live;
+    }
+
+
+/*  function        int cache_minmax( void )
+
+    brief           returns how long minimum and maximum values may be taken
+                    from the shadow of the station's memory
+
+    return          int, [s], 0 = always read, -1 = read once
+*/
+int cache_minmax( void )
+    {
+    return station_default()->config.cache_minmax;
+    }
+
+
+/*  function        int cache_settings( void )
+
+    brief           returns how long calibration and settings may be taken
+                    from the shadow of the station's memory
+
+    return          int, [s], 0 = always read, -1 = read once
+*/
+int cache_settings( void )
+    {
+    return station_default()->config.cache_settings;
+    }
+
+
+/*  function        int sample_period( int group )
+
+    brief           returns the sampling period of a group of fields
+
+    param[in]       int group, SAMPLE_xxx
+
+    return          int, [s], SAMPLE_OFF = read once every minute
+*/
+int sample_period( int group )
+    {
+    if( group < 0 || group >= SAMPLE_NUM_OF_GROUPS )
+        return SAMPLE_OFF;
+
+    return station_default()->config.sample_period[group];
+    }
+
+
+/*  function        int read_period( void )
+
+    brief           returns how often the weather station is read
+
+    return          int, [s]
+*/
+int read_period( void )
+    {
+    return station_default()->config.read_period;
+    }
+
+
+/*  function        int upload_period( void )
+
+    brief           returns how often the data string is sent to the server
+
+    return          int, [s]
+*/
+int upload_period( void )
+    {
+    return station_default()->config.upload_period;
+    }
+
+
+/*  function        int rollup_period( void )
+
+    brief           returns how often the data is appended to the log files
+
+    return          int, [s]
+*/
+int rollup_period( void )
+    {
+    return station_default()->config.rollup_period;
+    }
+
+
+/*  function        int history_period( void )
+
+    brief           returns how often new history records are fetched
+
+    return          int, [s]
+*/
+int history_period( void )
+    {
+    return station_default()->config.history_period;
+    }
+
+
+/*  function        int alarm_period( void )
+
+    brief           returns how often the alarm flags are polled
+
+    return          int, [s], 0 = never
+*/
+int alarm_period( void )
+    {
+    return station_default()->config.alarm_period;
+    }
+
+
+/*  function        int reset_minmax_time( void )
+
+    brief           returns the time of day all minimum and maximum values of
+                    the station are reset
+
+    return          int, [min] after midnight, -1 = never
+*/
+int reset_minmax_time( void )
+    {
+    return station_default()->config.reset_minmax;
+    }
+
+
 /*  function        char * log_path( void )
 
     brief           returns a pointer to the path for the log files
@@ -182,7 +465,20 @@ char * com_port( void )
 */
 char * log_path( void )
     {
-    return the_log_path;
+    return station_default()->config.log_path;
+    }
+
+
+/*  function        char * history_file( void )
+
+    brief           returns the name of the file that keeps the position of
+                    the last history record fetched from the station
+
+    return          char *, file name, empty string = don't fetch the history
+*/
+char * history_file( void )
+    {
+    return station_default()->config.history_file;
     }
 
 
@@ -194,7 +490,7 @@ char * log_path( void )
 */
 char * ftp_server( void )
     {
-    return the_ftp_server;
+    return station_default()->config.ftp[0].server;
     }
 
 
@@ -206,7 +502,7 @@ char * ftp_server( void )
 */
 char * user_name( void )
     {
-    return the_user_name;
+    return station_default()->config.ftp[0].user_name;
     }
 
 
@@ -218,7 +514,7 @@ char * user_name( void )
 */
 char * user_key( void )
     {
-    return the_key;
+    return station_default()->config.ftp[0].key;
     }
 
 
@@ -230,7 +526,7 @@ char * user_key( void )
 */
 char * ftp_log_path( void )
     {
-    return the_ftp_log_path;
+    return station_default()->config.ftp_log_path;
     }
 
 
@@ -243,7 +539,7 @@ char * ftp_log_path( void )
 */
 char * ftp_string( void )
     {
-    return the_ftp_string;
+    return station_default()->config.ftp_string;
     }
 
 
@@ -256,76 +552,52 @@ char * ftp_string( void )
 */
 char * ftp_file( void )
     {
-    return the_ftp_file;
+    return station_default()->config.ftp[0].file;
     }
 
 
-/*  function        static void _add_token( char * p_str, int len )
-
-    brief           collects a token to the token array
-
-    param[in]       char * p_str, pointer to token
-                                  that is an int pointer if token is a variable !
-    param[in]       int len, string length or 0 if token is a variable
-*/
-static void _add_token( char * p_str, int len )
-    {
-    if( the_p_token )
-        {
-        the_p_token->next = malloc(sizeof(struct _tokens));
-        the_p_token = the_p_token->next;
-        }
-    else
-        {
-        the_p_token = malloc(sizeof(struct _tokens));
-        the_p_token_list = the_p_token;                                         // set the anchor
-        }
-    the_p_token->p_str = p_str;
-    the_p_token->length = len;
-    the_p_token->next = 0;
-    }
+/*  function        static int ftp_section( char const * section )
 
+    brief           returns the destination of an ftp section
 
-/*  function        char * get_first_token( int * len )
-
-    brief           returns a pointer to the string residing as first token
-
-    param[in]       int * len, string length or 0 if token is a variable
-
-    return          char *, pointer to token
-                            this is an int pointer if token is a variable !
-*/
-char * get_first_token( int * len )
+    param[in]       char const * section
+
+    return          int, 0 for [FTP], 1 for [FTP2] ..., -1 if it is no ftp
+                    section
+*/
+static int ftp_section( char const * section )
     {
-    *len = the_p_token_list->length;
+    if( strncmp(section, "FTP", 3) != 0 )
+        return -1;
+    if( section[3] == 0 )
+        return 0;
+    if( section[3] >= '2' && section[3] < '1' + FTP_DESTINATIONS && section[4] == 0 )
+        return section[3] - '1';
+
+    return -1;
+    }
 
-    the_p_token = the_p_token_list->next;
 
-    return the_p_token_list->p_str;
-    }
+/*  function        static void _add_token( config_t * p_config, char * p_str, int len )
 
+    brief           appends a token to the template's token list
 
-/*  function        char * get_next_token( int * len )
-
-    brief           returns a pointer to the string residing as current token
-                    in the array
-
-    param[in]       int * len, string length or 0 if token is a variable
-
-    return          char *, pointer to token
-                            this is an int pointer if token is a variable !
-*/
-char * get_next_token( int * len )
+    param[in]       config_t * p_config
+    param[in]       char * p_str, pointer to token
+                                  that is an int pointer if token is a variable !
+    param[in]       int len, string length or 0 if token is a variable
+*/
+static void _add_token( config_t * p_config, char * p_str, int len )
     {
-    char * p_str = 0;
+    struct _tokens ** pp_token = &p_config->p_token_list;
 
-    if( the_p_token )
-        {
-        p_str = the_p_token->p_str;
-        *len = the_p_token->length;
-        the_p_token = the_p_token->next;
-        }
-    return p_str;
+    while( *pp_token )                                                          // templates are short, just walk to the end
+        pp_token = &(*pp_token)->next;
+
+    *pp_token = malloc(sizeof(struct _tokens));
+    (*pp_token)->p_str = p_str;
+    (*pp_token)->length = len;
+    (*pp_token)->next = 0;
     }
 
 
@@ -493,14 +765,18 @@ ERRNO _GetEntry( FILE * p_file, char * p_section, char * p_key, char * p_val )
     }
 
 
-/*  function        ERRNO Init( void )
+/*  function        ERRNO config_read( config_t * p_config, char const * name )
 
-    brief           initializes the global viarables from the data from the
-                    .ini file
+    brief           reads the configuration of a station from an .ini file,
+                    keys that are missing get their default value
 
-    return          ERRNO, initialization error or success
-*/
-ERRNO Init( void )
+    param[out]      config_t * p_config, must not hold a template, see
+                                         config_free()
+    param[in]       char const * name, .ini file, 0 = default file
+
+    return          ERRNO, initialization error or success
+*/
+ERRNO config_read( config_t * p_config, char const * name )
     {
     FILE * p_inifile;
     ERRNO error = NOERR;
@@ -516,26 +792,35 @@ ERRNO Init( void )
     int ftp_str_length = 0;
     int l;
     int j;
+    int hour;
+    int minute;
+    int dest;
 
     p_template_buffer = 0;                                                      // initialize to prevent memory access errors
     template_len = 0;
 
     /* initialize the strings */
-    strncpy(the_com_port, the_default_com_port, 127);
-    the_com_port[127] = 0;                                                      // always terminate the string
-    *the_log_path = 0;                                                          // empty string
-    *the_ftp_server = 0;                                                        // empty string
-    *the_user_name = 0;                                                         // empty string
-    *the_key = 0;                                                               // empty string
-    *the_ftp_file = 0;                                                          // empty string
-
-    if( !the_init_file_name )
-        the_init_file_name = (char *)the_default_init_file_name;
+    memset(p_config, 0, sizeof(*p_config));                                     // empty strings, no template
+    strncpy(p_config->com_port, the_default_com_port, 127);
+    p_config->com_port[127] = 0;                                                // always terminate the string
+    p_config->replay_speed = 1;
+    p_config->cache_minmax = 3600;
+    p_config->cache_settings = -1;
+    p_config->read_period = 60;
+    p_config->upload_period = 60;
+    p_config->rollup_period = 60;
+    p_config->history_period = 60;
+    p_config->reset_minmax = -1;
+    p_config->spool_size = SPOOL_SIZE;
+    p_config->ftp_flush_size = FLUSH_SIZE;
+
+    if( !name )
+        name = the_default_init_file_name;
 
     if( the_verbose_flag )
-        printf("Reading configuration from %s\n", the_init_file_name);
+        printf("Reading configuration from %s\n", name);
 
-    p_inifile = fopen(the_init_file_name, "r");
+    p_inifile = fopen(name, "r");
     if( !p_inifile )                                                            // no ini file found
         return ERR_NO_INIFILE;
 
@@ -545,20 +830,74 @@ ERRNO Init( void )
         always use strncpy() for the strings at here and put a terminating 0 at the end of the buiffer !
         NOT DONE YET !!!!!
 */
-        if( (strcmp(section, "FTP") == 0) && (strcmp(key, "server") == 0) )
-            decode(the_ftp_server, val);
-        else if( (strcmp(section, "FTP") == 0) && (strcmp(key, "user") == 0) )
-            decode(the_user_name, val);
-        else if( (strcmp(section, "FTP") == 0) && (strcmp(key, "key") == 0) )
-            decode(the_key, val);
-        else if( (strcmp(section, "FTP") == 0) && (strcmp(key, "file") == 0) )
-            decode(the_ftp_file, val);
+        dest = ftp_section(section);
+        if( (dest >= 0) && (strcmp(key, "server") == 0) )
+            decode(p_config->ftp[dest].server, val);
+        else if( (dest >= 0) && (strcmp(key, "user") == 0) )
+            decode(p_config->ftp[dest].user_name, val);
+        else if( (dest >= 0) && (strcmp(key, "key") == 0) )
+            decode(p_config->ftp[dest].key, val);
+        else if( (dest >= 0) && (strcmp(key, "file") == 0) )
+            decode(p_config->ftp[dest].file, val);
         else if( (strcmp(section, "FTP") == 0) && (strcmp(key, "logpath") == 0) )
-            decode(the_ftp_log_path, val);
+            decode(p_config->ftp_log_path, val);
+        else if( (strcmp(section, "FTP") == 0) && (strcmp(key, "flush") == 0) )
+            p_config->ftp_flush = ( atoi(val) > 0 ) ? atoi(val) : 0;
+        else if( (strcmp(section, "FTP") == 0) && (strcmp(key, "flush_size") == 0) )
+            p_config->ftp_flush_size = ( atol(val) > 0 ) ? atol(val) * 1024 : FLUSH_SIZE;
         else if( (strcmp(section, "File") == 0) && (strcmp(key, "logpath") == 0) )
-            strcpy(the_log_path, val);
+            strcpy(p_config->log_path, val);
+        else if( (strcmp(section, "File") == 0) && (strcmp(key, "history") == 0) )
+            strcpy(p_config->history_file, val);
+        else if( (strcmp(section, "File") == 0) && (strcmp(key, "spool") == 0) )
+            strcpy(p_config->spool_path, val);
+        else if( (strcmp(section, "File") == 0) && (strcmp(key, "spool_size") == 0) )
+            p_config->spool_size = ( atol(val) > 0 ) ? atol(val) * 1024 : SPOOL_SIZE;
         else if( (strcmp(section, "Port") == 0) && (strcmp(key, "port") == 0) )
-            strcpy(the_com_port, val);
+            strcpy(p_config->com_port, val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "persistent") == 0) )
+            p_config->persistent_port = atoi(val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "response_timeout") == 0) )
+            p_config->response_timeout = atol(val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "byte_timeout") == 0) )
+            p_config->byte_timeout = atol(val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "trace") == 0) )
+            strcpy(p_config->trace_file, val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "replay") == 0) )
+            strcpy(p_config->replay_file, val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "replay_speed") == 0) )
+            p_config->replay_speed = atoi(val);
+        else if( (strcmp(section, "Port") == 0) && (strcmp(key, "image") == 0) )
+            strcpy(p_config->image_file, val);
+        else if( (strcmp(section, "Cache") == 0) && (strcmp(key, "live") == 0) )
+            p_config->cache_live = atoi(val);
+        else if( (strcmp(section, "Cache") == 0) && (strcmp(key, "minmax") == 0) )
+            p_config->cache_minmax = atoi(val);
+        else if( (strcmp(section, "Cache") == 0) && (strcmp(key, "settings") == 0) )
+            p_config->cache_settings = atoi(val);
+        else if( strcmp(section, "Sample") == 0 )
+            {
+            for( j = 0; j < SAMPLE_NUM_OF_GROUPS; ++j )
+                {
+                if( strcmp(key, the_sample_groups[j]) == 0 )
+                    p_config->sample_period[j] = atoi(val);
+                }
+            }
+        else if( (strcmp(section, "Schedule") == 0) && (strcmp(key, "read") == 0) )
+            p_config->read_period = ( atoi(val) > 0 ) ? atoi(val) : 60;
+        else if( (strcmp(section, "Schedule") == 0) && (strcmp(key, "upload") == 0) )
+            p_config->upload_period = ( atoi(val) > 0 ) ? atoi(val) : 60;
+        else if( (strcmp(section, "Schedule") == 0) && (strcmp(key, "rollup") == 0) )
+            p_config->rollup_period = ( atoi(val) > 0 ) ? atoi(val) : 60;
+        else if( (strcmp(section, "Schedule") == 0) && (strcmp(key, "history") == 0) )
+            p_config->history_period = ( atoi(val) > 0 ) ? atoi(val) : 60;
+        else if( (strcmp(section, "Schedule") == 0) && (strcmp(key, "alarm") == 0) )
+            p_config->alarm_period = ( atoi(val) > 0 ) ? atoi(val) : 0;
+        else if( (strcmp(section, "Reset") == 0) && (strcmp(key, "minmax") == 0) )
+            {
+            if( sscanf(val, "%d:%d", &hour, &minute) == 2 && hour >= 0 && hour < 24 && minute >= 0 && minute < 60 )
+                p_config->reset_minmax = hour * 60 + minute;
+            }
         else if( strcmp(section, "Template") == 0 )
             {                                                                   // now get the template
             i = ftell(p_inifile);
@@ -577,13 +916,8 @@ ERRNO Init( void )
                 goto end_Init;
                 }
 
-            p_buffer = p_template_buffer;
-            while( !feof(p_inifile) )                                           // read file
-                {
-                *p_buffer = fgetc(p_inifile);
-                ++p_buffer;
-                }
-            *p_buffer = 0;                                                      // make it a string
+            template_len = fread(p_template_buffer, 1, template_len, p_inifile); // read file
+            p_template_buffer[template_len] = 0;                                // make it a string
             break;                                                              // the template is the last section
             }
         key[0] = 0;
@@ -627,19 +961,22 @@ ERRNO Init( void )
             p_token += 6;                                                       // point to variable's name
             for( j=0; j<VAR_NUM_OF_VARS; ++j )                                  // identify variable
                 {
-                if( strncmp(p_token, the_variables[j], strlen(the_variables[j])) == 0)
+                l = strlen(the_variables[j]);
+                if( ( strncmp(p_token, the_variables[j], l) == 0 ) && ( p_token[l] == '*' ) )
                     {                                                           // identifier found
                     *(int *)p_str = j+1;
                     break;
                     }
                 }
             p_buffer = strstr(p_token, "*>") + 2;                               // set buffer pointer behind the variable
-            ftp_str_length += max_var_length[j];                                // collect the string length
+            p_config->ftp_changes |= var_changes[*(int *)p_str];
+            ftp_str_length += max_var_length[*(int *)p_str];                    // collect the string length
+            l = 0;
             }
-        _add_token(p_str, l);
+        _add_token(p_config, p_str, l);
         }
-    the_ftp_string = malloc(ftp_str_length + 1);                                // beware for the trailing 0
-    if( !the_ftp_string )
+    p_config->ftp_string = malloc(ftp_str_length + 1);                                // beware for the trailing 0
+    if( !p_config->ftp_string )
         error = ERR_NOT_ENOUGH_MEMORY;
 
 end_Init:                                                                       // error exit
@@ -649,40 +986,68 @@ end_Init:
     }
 
 
-/*  function        void DeInit( void )
-
-    brief           closes the connenction to the weather station and
-                    releases all allocated memory
-*/
-void DeInit( void )
+/*  function        void config_free( config_t * p_config )
+
+    brief           releases the template and the data string of a
+                    configuration
+
+    param[in]       config_t * p_config
+*/
+void config_free( config_t * p_config )
     {
     struct _tokens * p_token;
 
-    the_p_token = the_p_token_list;
-    while( the_p_token )
+    while( p_config->p_token_list )
         {
-        p_token = the_p_token;
-        the_p_token = the_p_token->next;
+        p_token = p_config->p_token_list;
+        p_config->p_token_list = p_token->next;
         free(p_token->p_str);
         free(p_token);
         }
-    free(the_ftp_string);
+    free(p_config->ftp_string);
+    p_config->ftp_string = 0;
+    p_config->ftp_filled = 0;
+    }
+
+
+/*  function        ERRNO Init( void )
+
+    brief           initializes the default station from the .ini file given
+                    by set_ini_file()
+
+    return          ERRNO, initialization error or success
+*/
+ERRNO Init( void )
+    {
+    return station_init(station_default(), ini_file(0));
+    }
+
+
+/*  function        void DeInit( void )
+
+    brief           closes the connenction to the default station and
+                    releases all allocated memory
+*/
+void DeInit( void )
+    {
+    station_deinit(station_default());
     }
 
 
-/*  function        ERRNO PrintVariable( int var, char * dst )
+/*  function        ERRNO PrintVariable( weatherdata_t const * p_weatherdata, int var, char * dst )
 
     brief           adds the formatted variable value to the end of the string
 
+    param[in]       weatherdata_t const * p_weatherdata, the reading to print
     param[in]       int var, index to variable
     param[out]      char * dst, string to print in
 
     return          ERRNO
 */
-ERRNO PrintVariable( int var, char * dst )
+ERRNO PrintVariable( weatherdata_t const * p_weatherdata, int var, char * dst )
     {
-    weatherdata_t * p_weatherdata;
     char var_str[20];
+    struct tm tm;
 
     if( (var > VAR_NUM_OF_VARS) || (var == VAR_UNKNOWN) )
         return ERR_VAR_UNKNOWN;
@@ -690,15 +1055,13 @@ ERRNO PrintVariable( int var, char * dst )
     if( !dst )
         return ERR_ILLEGAL_STRING_PTR;
 
-    p_weatherdata = get_weatherdata_ptr();
-
     switch( var )
         {
         case VAR_TEMP :
             sprintf(var_str, "%1.1f", p_weatherdata->temperature);
             break;
         case VAR_PRESS :
-            sprintf(var_str, "%1.1f", GetRelPressure());
+            sprintf(var_str, "%1.1f", GetRelPressure(p_weatherdata));
             break;
         case VAR_HUM :
             sprintf(var_str, "%d", p_weatherdata->humidity);
@@ -757,6 +1120,39 @@ ERRNO PrintVariable( int var, char * dst )
         case VAR_TIME :
             sprintf(var_str, "%s", p_weatherdata->act_time);
             break;
+        case VAR_WIND_AVG :
+            if( ( p_weatherdata->sensor_connected == 0 ) && p_weatherdata->wind.samples )
+                sprintf(var_str, "%1.1f", p_weatherdata->wind.mean);
+            else
+                sprintf(var_str, "-.-");
+            break;
+        case VAR_GUST :
+            if( ( p_weatherdata->sensor_connected == 0 ) && p_weatherdata->wind.samples )
+                sprintf(var_str, "%1.1f", p_weatherdata->wind.gust);
+            else
+                sprintf(var_str, "-.-");
+            break;
+        case VAR_GUST_TIME :
+            if( ( p_weatherdata->sensor_connected == 0 ) && p_weatherdata->wind.samples )
+                {
+                localtime_r(&p_weatherdata->wind.gust_time, &tm);
+                strftime(var_str, sizeof(var_str), "%H:%M:%S", &tm);
+                }
+            else
+                sprintf(var_str, "--:--:--");
+            break;
+        case VAR_WIND_DIR :
+            if( ( p_weatherdata->sensor_connected == 0 ) && p_weatherdata->wind.samples )
+                sprintf(var_str, "%1.1f", p_weatherdata->wind.direction);
+            else
+                sprintf(var_str, "-.-");
+            break;
+        case VAR_WIND_DEV :
+            if( ( p_weatherdata->sensor_connected == 0 ) && p_weatherdata->wind.samples )
+                sprintf(var_str, "%1.1f", p_weatherdata->wind.deviation);
+            else
+                sprintf(var_str, "-.-");
+            break;
         default :
             break;
         }
@@ -766,30 +1162,36 @@ ERRNO PrintVariable( int var, char * dst )
     }
 
 
-/*  function        void SetFtpString( void )
-
-    brief           collects all data to be sent to the ftp seerver
-*/
-void SetFtpString( void )
+/*  function        int SetFtpString( station_t * p_station, weatherdata_t const * p_weatherdata, unsigned int changes )
+
+    brief           collects all data to be sent to the ftp seerver, the string
+                    is kept if none of the template's variables changed
+
+    param[in]       station_t * p_station
+    param[in]       weatherdata_t const * p_weatherdata, the reading to send
+    param[in]       unsigned int changes, CHG_xxx since the last call
+
+    return          int, 0 : the string is the same as the last time
+*/
+int SetFtpString( station_t * p_station, weatherdata_t const * p_weatherdata, unsigned int changes )
     {
-    char * str;
-    int len;
+    config_t * p_config = &p_station->config;
+    struct _tokens * p_token;
+
+    if( !p_config->ftp_string )                                                 // no template
+        return 1;
 
-    *the_ftp_string = 0;                                                        // start from scratch every time
-    str = get_first_token(&len);
+    if( p_config->ftp_filled && !( changes & p_config->ftp_changes ) )
+        return 0;
 
-    do
+    p_config->ftp_filled = 1;
+    *p_config->ftp_string = 0;                                                  // start from scratch
+    for( p_token = p_config->p_token_list; p_token; p_token = p_token->next )
         {
-        if( len == 0 )                                                          // variable
-            {
-            PrintVariable((int)*str, the_ftp_string);
-            }
+        if( p_token->length == 0 )                                              // variable
+            PrintVariable(p_weatherdata, *(int *)p_token->p_str, p_config->ftp_string);
         else
-            {
-            strcat(the_ftp_string, str);
-            }
-
-        str = get_next_token(&len);
+            strcat(p_config->ftp_string, p_token->p_str);
         }
-    while( str );
+    return 1;
     }
@@ -94,6 +94,7 @@ static char * errors[] =
     "",
     "",
     "",
+    "creating or setting the timer failed",
     0
     };
 
@@ -22,7 +22,7 @@
 
     file        ftp.c
 
-    date        15.10.2016
+    date        17.10.2026
 
     author      Uwe Jantzen (jantzen@klabautermann-software.de)
 
@@ -30,7 +30,27 @@
                 push the weather data to a file on the server
                 kill the connection
 
-    details     
+    details     Each station keeps one curl handle from FtpOpen() to
+                FtpClose(). libcurl keeps the control connection of the
+                handle open between two transfers, so an upload only needs
+                a new data connection, no new login. The credentials, the
+                url and the command list of the data file are built once.
+                The command lists of the log files are kept for the last
+                FTP_APPEND_LISTS file names, a new day gets new ones.
+
+                The data file goes to [FTP] and its mirrors [FTP2] to
+                [FTP4]. Each server has a curl handle of its own, all of
+                them run together in the multi handle of the station, so an
+                upload takes as long as the slowest server, not the sum of
+                all. A server that fails or hangs does not stop the others,
+                the page is sent to all of them again if [FTP] failed. A
+                mirror that failed is left out for FTP_RETRY seconds. The
+                log files go to [FTP] only.
+
+                All transfers are made by the upload thread (upload.c),
+                the handle is still locked for a transfer. The statistics
+                have a lock of their own, the readers print them while a
+                transfer runs.
 
     project     weather23k
     target      Linux
@@ -47,31 +67,67 @@
 #include "debug.h"
 #include "data.h"
 #include <curl/curl.h>
+#include "station.h"
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 
-static char * the_ftp_string_ptr = 0;
+#define FTP_APPEND_LISTS                        2                               // data and history log
+#define FTP_TIMEOUT                             30L                             // [s] to connect, or without progress in a transfer
+#define FTP_POLL                                1000                            // [ms] to wait for the sockets of the running transfers
+#define FTP_RETRY                               300                             // [s] until a server that failed gets the data file again
 
 
-/*  function        static size_t _copy( char * dst, size_t n )
+typedef struct _dest
+    {
+    CURL * curl;                                                                // 0 : no server
+    char name_pass[272];
+    char push_url[420];
+    struct curl_slist * p_push_list;                                            // commands after the data file
+    char * p_src;                                                               // read position of the running transfer
+    int running;                                                                // added to the multi handle
+    struct timespec start;                                                      // CLOCK_MONOTONIC, of the running transfer
+    CURLcode res;                                                               // of the last transfer
+    long port;                                                                  // local port of the control connection, 0 = none yet
+    time_t retry;                                                               // CLOCK_MONOTONIC, no data file before, after a failure
+    ftpstat_t stats;
+    } dest_t;
+
+
+struct _ftp                                                                     // typedef ftp_t in station.h
+    {
+    pthread_mutex_t lock;                                                       // one transfer at a time
+    pthread_mutex_t stats_lock;                                                 // guards stats only, never held during a transfer
+    CURLM * multi;                                                              // runs the transfers to all destinations at once
+    dest_t dest[FTP_DESTINATIONS];                                              // config.ftp[] order
+    char append_name[FTP_APPEND_LISTS][256];
+    struct curl_slist * p_append_list[FTP_APPEND_LISTS];                        // commands after a log file
+    int append_next;                                                            // entry to replace next
+    };
+
 
-    brief           copies a part of the string that is to be sent over the ftp connection
+/*  function        static size_t _copy( char ** pp_src, char * dst, size_t n )
+
+    brief           copies a part of the string that is to be sent over the ftp connection
                     to the send buffer
-
+
+    param[in,out]   char ** pp_src, read position in the string, advanced by the bytes copied
     param[in]       char * dst, send buffer
     param[in]       size_t n, number of bytes to copy from src to dst
 
     return          int, number of bytes copied
 */
-static size_t _copy( char * dst, size_t n )
+static size_t _copy( char ** pp_src, char * dst, size_t n )
     {
-    size_t res = strlen(the_ftp_string_ptr);
+    size_t res = strlen(*pp_src);
 
     if( res > n )
         res = n;
 
-    memcpy(dst, the_ftp_string_ptr, res);
-    the_ftp_string_ptr += res;
+    memcpy(dst, *pp_src, res);
+    *pp_src += res;
     return res;
     }
 
@@ -84,208 +140,291 @@ static size_t _copy( char * dst, size_t n )
     param[in]       void * ptr
     param[in]       size_t size
     param[in]       size_t nmemb,
-    param[in]       void * stream,
+    param[in]       void * stream, the transfer's read position (char **)
 
     return          size_t, number of bytes transferred
 */
 static size_t _read_callback( void * ptr, size_t size, size_t nmemb, void * stream )
     {
-    size_t retcode = _copy(ptr, size*nmemb);
+    size_t retcode = _copy(stream, ptr, size*nmemb);
     return retcode;
     }
 
 
-/*  function        ERRNO PushFile( void )
-
-    brief           opens a ftp connection and transfers the ftp string to the
-                    given file on the server
-
-    return          ERRNO
-*/
-ERRNO PushFile( void )
+/*  function        static struct curl_slist * append_list( ftp_t * p_ftp, char const * logfile )
+
+    brief           returns the list of commands to run after a log file was
+                    appended, the list is built at the first use of the file
+
+    param[in]       ftp_t * p_ftp, locked
+    param[in]       char const * logfile
+
+    return          struct curl_slist *, 0 if out of memory
+*/
+static struct curl_slist * append_list( ftp_t * p_ftp, char const * logfile )
     {
-    ERRNO error = NOERR;
-    CURL * curl = 0;
-    curl_off_t fsize;
-    struct curl_slist * headerlist = 0;
-    char buf_1[148];
-    char remote_url[420];
-    char name_pass[272]; 
-
-    sprintf(buf_1, "RNFR %s", ftp_file());
-    debug("RNFR %s\n", ftp_file());
-
-    if( strlen(ftp_server()) == 0 )
-        return ERR_NO_FTP_SERVER;
+    char command[272];
+    int i;
 
-    sprintf(remote_url, "ftp://%s%s", ftp_server(), ftp_file());
-    debug("ftp://%s%s\n", ftp_server(), ftp_file());
+    for( i = 0; i < FTP_APPEND_LISTS; ++i )
+        {
+        if( p_ftp->p_append_list[i] && strcmp(p_ftp->append_name[i], logfile) == 0 )
+            return p_ftp->p_append_list[i];
+        }
 
-    sprintf(name_pass, "%s:%s", user_name(), user_key());
-    debug("Set user name and key : %s %s\n", user_name(), user_key());
+    i = p_ftp->append_next;                                                     // the oldest one, yesterday's file
+    p_ftp->append_next = ( i + 1 ) % FTP_APPEND_LISTS;
+    curl_slist_free_all(p_ftp->p_append_list[i]);
+    snprintf(p_ftp->append_name[i], sizeof(p_ftp->append_name[i]), "%s", logfile);
+    snprintf(command, sizeof(command), "RNFR %s", logfile);
+    p_ftp->p_append_list[i] = curl_slist_append(0, command);
+    debug("Headerlist of %s set\n", logfile);
 
-    fsize = (curl_off_t)strlen(ftp_string());                                   // get the number of bytes for transfer
-    the_ftp_string_ptr = ftp_string();  
-
-    curl = curl_easy_init();                                                    // get a curl handle
-    if( !curl )
+    return p_ftp->p_append_list[i];
+    }
+
+
+/*  function        static ERRNO start( ftp_t * p_ftp, dest_t * p_dest, char const * url, struct curl_slist * p_list, char * data, long append )
+
+    brief           adds a transfer of a string to one destination to the
+                    multi handle, the control connection of the last
+                    transfer is used again if the server did not close it
+
+    param[in]       ftp_t * p_ftp, locked
+    param[in]       dest_t * p_dest
+    param[in]       char const * url, remote file
+    param[in]       struct curl_slist * p_list, commands to run after the transfer
+    param[in]       char * data, string to send
+    param[in]       long append, 1 to append to the remote file, 0 to overwrite it
+
+    return          ERRNO
+*/
+static ERRNO start( ftp_t * p_ftp, dest_t * p_dest, char const * url, struct curl_slist * p_list, char * data, long append )
+    {
+    p_dest->p_src = data;
+    p_dest->res = CURLE_FAILED_INIT;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_URL, url) )                      // specify target
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_APPEND, append) )                // append instead of overwrite
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_POSTQUOTE, p_list) )             // pass in that last of FTP commands to run after the transfer
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_READDATA, &p_dest->p_src) )      // now specify which string to upload
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)strlen(data)) )
+        return ERR_CURL_SETOPERRNOOR;
+    debug("Options set\n");
+
+    clock_gettime(CLOCK_MONOTONIC, &p_dest->start);
+    if( curl_multi_add_handle(p_ftp->multi, p_dest->curl) )
+        return ERR_CURL_SETOPERRNOOR;
+    p_dest->running = 1;
+
+    return NOERR;
+    }
+
+
+/*  function        static void finish( ftp_t * p_ftp, dest_t * p_dest, CURLcode res )
+
+    brief           takes a transfer that is done out of the multi handle and
+                    adds it to the statistics of its destination
+
+    param[in]       ftp_t * p_ftp, locked
+    param[in]       dest_t * p_dest
+    param[in]       CURLcode res, of the transfer
+*/
+static void finish( ftp_t * p_ftp, dest_t * p_dest, CURLcode res )
+    {
+    struct timespec end;
+    long connects = 0;
+    long port = 0;
+    long ms;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    curl_multi_remove_handle(p_ftp->multi, p_dest->curl);
+    p_dest->running = 0;
+    p_dest->res = res;
+    if( res )
         {
-        error = ERR_CURL_EASY_INIERRNOOR;
-        goto end_PushFile;
-        }   
-    debug("Curl initialized\n");
+        debug("transfer to %s failed: %s\n", p_dest->push_url, curl_easy_strerror(res));
+        pthread_mutex_lock(&p_ftp->stats_lock);
+        ++p_dest->stats.failures;
+        pthread_mutex_unlock(&p_ftp->stats_lock);
+        return;
+        }
+
+    ms = ( end.tv_sec - p_dest->start.tv_sec ) * 1000 + ( end.tv_nsec - p_dest->start.tv_nsec ) / 1000000;
+    curl_easy_getinfo(p_dest->curl, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(p_dest->curl, CURLINFO_LOCAL_PORT, &port);                // of the control connection
+    pthread_mutex_lock(&p_ftp->stats_lock);
+    if( connects > 0 && port != p_dest->port )                                  // libcurl may count the data connection too
+        ++p_dest->stats.connects;
+    else
+        ++p_dest->stats.reused;
+    p_dest->port = port;
+    if( p_dest->stats.transfers == 0 || ms < p_dest->stats.time_min )
+        p_dest->stats.time_min = ms;
+    if( ms > p_dest->stats.time_max )
+        p_dest->stats.time_max = ms;
+    p_dest->stats.time_sum += ms;
+    p_dest->stats.time_last = ms;
+    ++p_dest->stats.transfers;
+    pthread_mutex_unlock(&p_ftp->stats_lock);
+    }
+
+
+/*  function        static void run( ftp_t * p_ftp )
+
+    brief           runs the transfers added by start() until all of them are
+                    done, each one ends on its own, a slow server does not
+                    hold up the others
 
-    headerlist = curl_slist_append(headerlist, buf_1);                          // build a list of commands to pass to libcurl
-    if( !headerlist )
+    param[in]       ftp_t * p_ftp, locked
+*/
+static void run( ftp_t * p_ftp )
+    {
+    CURLMsg * p_msg;
+    int running = 1;
+    int left;
+    int i;
+
+    while( running )
         {
-        error = ERR_CURL_HEADERLISERRNOOR;
-        goto cleanup_PushFile;
+        if( curl_multi_perform(p_ftp->multi, &running) )
+            break;
+        while( (p_msg = curl_multi_info_read(p_ftp->multi, &left)) != 0 )
+            {
+            if( p_msg->msg != CURLMSG_DONE )
+                continue;
+            for( i = 0; i < FTP_DESTINATIONS; ++i )
+                {
+                if( p_ftp->dest[i].running && p_ftp->dest[i].curl == p_msg->easy_handle )
+                    finish(p_ftp, &p_ftp->dest[i], p_msg->data.result);
+                }
+            }
+        if( running && curl_multi_poll(p_ftp->multi, 0, 0, FTP_POLL, 0) )
+            break;
         }
-    debug("Headerlist set\n");
+    debug("Curl performed\n");
 
-    error = ERR_CURL_SETOPERRNOOR;
-    if( curl_easy_setopt(curl, CURLOPT_READFUNCTION, _read_callback) )          // we want to use our own read function
-        goto setopt_PushFile;
-    if( curl_easy_setopt(curl, CURLOPT_UPLOAD, 1) )                             // enable uploading
-        goto setopt_PushFile;
-    if( curl_easy_setopt(curl,CURLOPT_URL, remote_url) )                        // specify target
-        goto setopt_PushFile;
-    if( curl_easy_setopt(curl, CURLOPT_USERPWD, name_pass) )                    // set user and password
-        goto setopt_PushFile;
-    if( curl_easy_setopt(curl, CURLOPT_POSTQUOTE, headerlist) )                 // pass in that last of FTP commands to run after the transfer
-        goto setopt_PushFile;
-    if( curl_easy_setopt(curl, CURLOPT_READDATA, the_ftp_string_ptr) )          // now specify which file to upload
-        goto setopt_PushFile;
-    debug("Options set\n");
+    for( i = 0; i < FTP_DESTINATIONS; ++i )                                     // only if the multi handle failed
+        {
+        if( p_ftp->dest[i].running )
+            finish(p_ftp, &p_ftp->dest[i], CURLE_FAILED_INIT);
+        }
+    }
+
+
+/*  function        ERRNO PushFile( station_t * p_station, char * data )
 
-    /* Set the size of the file to upload (optional). If you give a *_LARGE
-       option you MUST make sure that the type of the passed-in argument is a
-       curl_off_t. If you use CURLOPT_INFILESIZE (without _LARGE) you must
-       make sure that to pass in a type 'long' argument. */
-    if( curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)fsize) )
-        goto setopt_PushFile;
-    debug("Filesize set set\n");
-
-    error = NOERR;
-    if( curl_easy_perform(curl) )                                               // Now run off and do what you've been told!
-        error = ERR_CURL_PERFORM_ERROR;
-    debug("Curl performed\n");
+    brief           transfers the data string to the given file on all
+                    servers at the same time
 
-setopt_PushFile:
-    curl_slist_free_all(headerlist);                                            // clean up the FTP commands list
-    debug("Curl freed\n");
-cleanup_PushFile:
-    curl_easy_cleanup(curl);                                                    // always cleanup
-    debug("Curl cleaned up\n");
-end_PushFile:
+    param[in]       station_t * p_station
+    param[in]       char * data, the filled in template
+
+    return          ERRNO, ERR_CURL_PERFORM_ERROR if the server of [FTP] did
+                    not get it
+*/
+ERRNO PushFile( station_t * p_station, char * data )
+    {
+    ftp_t * p_ftp = p_station->p_ftp;
+    struct timespec now;
+    ERRNO error = ERR_NO_FTP_SERVER;
+    int started = 0;
+    int i;
+
+    if( data == 0 )
+        return ERR_NO_LOG_DATA;
+
+    if( !p_ftp )
+        return ERR_CURL_EASY_INIERRNOOR;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock(&p_ftp->lock);
+    for( i = 0; i < FTP_DESTINATIONS; ++i )
+        {
+        p_ftp->dest[i].res = CURLE_OK;
+        if( !p_ftp->dest[i].curl )
+            continue;
+        error = NOERR;
+        if( now.tv_sec < p_ftp->dest[i].retry )
+            continue;                                                           // a hung server would hold up the others each time
+        debug("%s\n", p_ftp->dest[i].push_url);
+        if( start(p_ftp, &p_ftp->dest[i], p_ftp->dest[i].push_url, p_ftp->dest[i].p_push_list, data, 0) )
+            finish(p_ftp, &p_ftp->dest[i], CURLE_FAILED_INIT);
+        else
+            ++started;
+        }
+    if( started )
+        run(p_ftp);
+    for( i = 0; i < FTP_DESTINATIONS; ++i )
+        {
+        if( !p_ftp->dest[i].res )
+            continue;
+        if( i == 0 )
+            error = ERR_CURL_PERFORM_ERROR;                                     // the mirrors have it, it is sent to all again
+        else
+            p_ftp->dest[i].retry = now.tv_sec + FTP_RETRY;                      // gets the next one after the pause
+        }
+    pthread_mutex_unlock(&p_ftp->lock);
+
     return error;
     }
 
 
-/*  function        ERRNO AppendFile( char * logfile, char * line )
+/*  function        ERRNO AppendFile( station_t * p_station, char * logfile, char * line )
 
-    brief           opens a ftp connection and transfers the line to the
-                    logfile on the server
+    brief           transfers the line to the logfile on the server of [FTP]
 
+    param[in]       station_t * p_station
     param[in]       char * logfile,
     param[in]       char * line
 
     return          ERRNO
 */
-ERRNO AppendFile( char * logfile, char * line )
+ERRNO AppendFile( station_t * p_station, char * logfile, char * line )
     {
-    ERRNO error = NOERR;
-    CURL * curl = 0;
-    CURLcode res;
-    curl_off_t fsize;
-    struct curl_slist * headerlist = 0;
-    char buf_1[272];
+    config_t const * p_config = &p_station->config;
+    ftp_t * p_ftp = p_station->p_ftp;
+    dest_t * p_dest;
+    struct curl_slist * p_list;
     char remote_url[540];
-    char name_pass[272]; 
+    ERRNO error;
 
     if( line == 0 )
         return ERR_NO_LOG_DATA;
 
-    sprintf(buf_1, "RNFR %s", logfile);
-    debug("RNFR %s\n", logfile);
-    if( strlen(ftp_server()) == 0 )
+    if( strlen(p_config->ftp[0].server) == 0 )
         return ERR_NO_FTP_SERVER;
-    sprintf(remote_url, "ftp://%s%s", ftp_server(), logfile);
-    debug("ftp://%s%s\n", ftp_server(), logfile);
-    sprintf(name_pass, "%s:%s", user_name(), user_key());
-    debug("Set user name and key : %s %s\n", user_name(), user_key());
 
-    fsize = (curl_off_t)strlen(line);                                           // get the number of bytes for transfer
-    the_ftp_string_ptr = line;  
-    debug("ftp string : %s, len %d\n", the_ftp_string_ptr, (int)fsize);
+    if( !p_ftp )
+        return ERR_CURL_EASY_INIERRNOOR;
 
-    /* In windows, this will init the winsock stuff */
-    curl_global_init(CURL_GLOBAL_ALL);
-
-    curl = curl_easy_init();                                                    // get a curl handle
-    if( !curl )
-        {
-        error = ERR_CURL_EASY_INIERRNOOR;
-        goto end_AppendFile;
-        }
-    debug("Curl initialized\n");
+    sprintf(remote_url, "ftp://%s%s", p_config->ftp[0].server, logfile);
+    debug("%s\n", remote_url);
+    debug("ftp string : %s, len %d\n", line, (int)strlen(line));
 
-    headerlist = curl_slist_append(headerlist, buf_1);                          // build a list of commands to pass to libcurl
-    if( !headerlist )
+    pthread_mutex_lock(&p_ftp->lock);
+    p_dest = &p_ftp->dest[0];
+    p_list = append_list(p_ftp, logfile);
+    error = p_list ? start(p_ftp, p_dest, remote_url, p_list, line, 1) : ERR_CURL_HEADERLISERRNOOR;
+    if( !error )
         {
-        error = ERR_CURL_HEADERLISERRNOOR;
-        goto cleanup_AppendFile;
+        run(p_ftp);
+        if( p_dest->res )
+            error = ERR_CURL_PERFORM_ERROR;
         }
-    debug("Headerlist set\n");
-    error = ERR_CURL_SETOPERRNOOR;
-    if( curl_easy_setopt(curl, CURLOPT_READFUNCTION, _read_callback) )          // we want to use our own read function
-        goto setopt_AppendFile;
-    if( curl_easy_setopt(curl, CURLOPT_APPEND, 1) )                             // enable append instead of overwrite
-        goto setopt_AppendFile;
-    if( curl_easy_setopt(curl, CURLOPT_UPLOAD, 1) )                             // enable uploading
-        goto setopt_AppendFile;
-    if( curl_easy_setopt(curl,CURLOPT_URL, remote_url) )                        // specify target
-        goto setopt_AppendFile;
-    if( curl_easy_setopt(curl, CURLOPT_USERPWD, name_pass) )                    // set user and password
-        goto setopt_AppendFile;
-    if( curl_easy_setopt(curl, CURLOPT_POSTQUOTE, headerlist) )                 // pass in that last of FTP commands to run after the transfer
-        goto setopt_AppendFile;
-    if( curl_easy_setopt(curl, CURLOPT_READDATA, the_ftp_string_ptr) )          // now specify which file to upload
-        goto setopt_AppendFile;
-    debug("Options set\n");
+    pthread_mutex_unlock(&p_ftp->lock);
 
-    /* Set the size of the file to upload (optional). If you give a *_LARGE
-       option you MUST make sure that the type of the passed-in argument is a
-       curl_off_t. If you use CURLOPT_INFILESIZE (without _LARGE) you must
-       make sure that to pass in a type 'long' argument. */
-    if( curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)fsize) )
-        goto setopt_AppendFile;
-    debug("Filesize set set\n");
-
-    error = NOERR;
-    if( (res = curl_easy_perform(curl)) )                                       // Now run off and do what you've been told!
-        {
-        debug("curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        error = ERR_CURL_PERFORM_ERROR;
-        }
-    debug("Curl performed\n");
-
-setopt_AppendFile:
-    curl_slist_free_all(headerlist);                                            // clean up the FTP commands list
-    debug("Curl freed\n");
-cleanup_AppendFile:
-    curl_easy_cleanup(curl);                                                    // always cleanup
-    debug("Curl esy cleaned up\n");
-    curl_global_cleanup();
-    debug("Curl global cleaned up\n");
-end_AppendFile:
     return error;
     }
 
 
 /*  function        ERRNO FtpInit( void )
 
-    brief           does the global init of the curl lib
+    brief           does the global init of the curl lib, once per process before any
+                    station transfers a file
 
     return          ERRNO
 */
@@ -304,3 +443,153 @@ void FtpCleanup( void )
     {
     curl_global_cleanup();
     }
+
+
+/*  function        static ERRNO open_dest( dest_t * p_dest, ftpdest_t const * p_config )
+
+    brief           builds the curl handle of one server with the options that
+                    are the same for all transfers
+
+    param[in]       dest_t * p_dest
+    param[in]       ftpdest_t const * p_config, [FTP] or one of its mirrors
+
+    return          ERRNO
+*/
+static ERRNO open_dest( dest_t * p_dest, ftpdest_t const * p_config )
+    {
+    char command[148];
+
+    p_dest->curl = curl_easy_init();                                            // get a curl handle
+    if( !p_dest->curl )
+        return ERR_CURL_EASY_INIERRNOOR;
+    debug("Curl initialized\n");
+
+    snprintf(command, sizeof(command), "RNFR %s", p_config->file);              // build a list of commands to pass to libcurl
+    p_dest->p_push_list = curl_slist_append(0, command);
+    if( !p_dest->p_push_list )
+        return ERR_CURL_HEADERLISERRNOOR;
+    debug("Headerlist set\n");
+
+    snprintf(p_dest->push_url, sizeof(p_dest->push_url), "ftp://%s%s", p_config->server, p_config->file);
+    snprintf(p_dest->name_pass, sizeof(p_dest->name_pass), "%s:%s", p_config->user_name, p_config->key);
+    debug("Set user name and key : %s %s\n", p_config->user_name, p_config->key);
+
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_READFUNCTION, _read_callback) )  // we want to use our own read function
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_UPLOAD, 1L) )                    // enable uploading
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_USERPWD, p_dest->name_pass) )    // set user and password
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_TCP_KEEPALIVE, 1L) )             // keep the idle control connection alive
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_NOSIGNAL, 1L) )                  // the transfers run in the upload thread
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_CONNECTTIMEOUT, FTP_TIMEOUT) )
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_LOW_SPEED_LIMIT, 1L) )           // a hung server would hold up all uploads
+        return ERR_CURL_SETOPERRNOOR;
+    if( curl_easy_setopt(p_dest->curl, CURLOPT_LOW_SPEED_TIME, FTP_TIMEOUT) )
+        return ERR_CURL_SETOPERRNOOR;
+
+    return NOERR;
+    }
+
+
+/*  function        ERRNO FtpOpen( station_t * p_station )
+
+    brief           builds the station's multi handle and a curl handle for
+                    each configured server, after FtpInit()
+
+    param[in]       station_t * p_station
+
+    return          ERRNO
+*/
+ERRNO FtpOpen( station_t * p_station )
+    {
+    config_t const * p_config = &p_station->config;
+    ftp_t * p_ftp;
+    ERRNO error = ERR_CURL_EASY_INIERRNOOR;
+    int i;
+
+    p_ftp = calloc(1, sizeof(*p_ftp));
+    if( !p_ftp )
+        return ERR_OUT_OF_MEMORY;
+    pthread_mutex_init(&p_ftp->lock, 0);
+    pthread_mutex_init(&p_ftp->stats_lock, 0);
+    p_station->p_ftp = p_ftp;
+
+    p_ftp->multi = curl_multi_init();
+    if( !p_ftp->multi )
+        goto error_FtpOpen;
+
+    for( i = 0; i < FTP_DESTINATIONS; ++i )
+        {
+        if( strlen(p_config->ftp[i].server) == 0 )
+            continue;
+        error = open_dest(&p_ftp->dest[i], &p_config->ftp[i]);
+        if( error )
+            goto error_FtpOpen;
+        }
+
+    return NOERR;
+
+error_FtpOpen:
+    FtpClose(p_station);
+    return error;
+    }
+
+
+/*  function        void FtpClose( station_t * p_station )
+
+    brief           closes the connections of the station and frees its curl
+                    handles
+
+    param[in]       station_t * p_station
+*/
+void FtpClose( station_t * p_station )
+    {
+    ftp_t * p_ftp = p_station->p_ftp;
+    int i;
+
+    if( !p_ftp )
+        return;
+
+    for( i = 0; i < FTP_DESTINATIONS; ++i )
+        {
+        if( p_ftp->dest[i].curl )
+            curl_easy_cleanup(p_ftp->dest[i].curl);                             // closes the control connection
+        curl_slist_free_all(p_ftp->dest[i].p_push_list);
+        }
+    for( i = 0; i < FTP_APPEND_LISTS; ++i )
+        curl_slist_free_all(p_ftp->p_append_list[i]);
+    if( p_ftp->multi )
+        curl_multi_cleanup(p_ftp->multi);
+    pthread_mutex_destroy(&p_ftp->stats_lock);
+    pthread_mutex_destroy(&p_ftp->lock);
+    free(p_ftp);
+    p_station->p_ftp = 0;
+    debug("Curl cleaned up\n");
+    }
+
+
+/*  function        void FtpStats( station_t * p_station, int dest, ftpstat_t * p_stats )
+
+    brief           returns the transfer statistics of one server of the
+                    station
+
+    param[in]       station_t * p_station
+    param[in]       int dest, 0 for [FTP], 1 for [FTP2] ...
+    param[out]      ftpstat_t * p_stats, all 0 if there is no handle
+*/
+void FtpStats( station_t * p_station, int dest, ftpstat_t * p_stats )
+    {
+    ftp_t * p_ftp = p_station->p_ftp;
+
+    memset(p_stats, 0, sizeof(*p_stats));
+    if( !p_ftp || dest < 0 || dest >= FTP_DESTINATIONS )
+        return;
+
+    pthread_mutex_lock(&p_ftp->stats_lock);
+    *p_stats = p_ftp->dest[dest].stats;
+    pthread_mutex_unlock(&p_ftp->stats_lock);
+    }
@@ -77,13 +77,14 @@ ERRNO handle_arg( char * str )
                 case 'h' :
                     printf("\nweather23k V%s (c) Uwe Jantzen (Klabautermann-Software) %s", VERSION, __DATE__);
                     printf("\n\nUsage:");
-                    printf("\n        weather23k [options] [<configuration file>]");
+                    printf("\n        weather23k [options] [<configuration file> ...]");
                     printf("\nOptions:");
                     printf("\n        -v            verbose, show data read from the weather station");
                     printf("\n        -d            debug, show more data (eg. ftp, logging ...)");
                     printf("\n        -h            show this help then stop without doing anything more");
                     printf("\n        -c            start the password encoder");
                     printf("\n\nIf no configuration file name is given the file \"conf/weather23k.conf\" is used.");
+                    printf("\nEach configuration file is one station, up to %d stations are read at once.", STATIONS_MAX);
                     printf("\n\n");
                     exit(error);
                     break;
@@ -102,7 +103,7 @@ ERRNO handle_arg( char * str )
             error = ERR_ILLEGAL_COMMANDLINE_ARGUMENT;    
         }
     else
-        set_ini_file(str);
+        error = set_ini_file(str);
 
     return error;
     }
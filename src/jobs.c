@@ -0,0 +1,331 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        jobs.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Periodic jobs started at absolute times
+
+    details     jobs_run() arms a timerfd on CLOCK_REALTIME with the absolute
+                time of the next due job (TFD_TIMER_ABSTIME) and sleeps in
+                read() until it expires, so there are no idle wakeups. With
+                TFD_TIMER_CANCEL_ON_SET the read() fails with ECANCELED when
+                the clock is set, then all jobs are scheduled again from the
+                new time.
+
+                Jobs that are due at the same time run in the order they
+                were added. If a job took so long that the next start of a
+                job has passed already, that start is skipped and counted.
+
+                jobs_stop() arms the timer with a time in the past, so a
+                jobs_run() of another thread wakes up at once.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The lateness of a start is the time between its due time and
+                the call of the job function, it includes the jobs that ran
+                before it at the same time.
+
+    todo
+
+*/
+
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "debug.h"
+#include "jobs.h"
+
+
+/*  function        static long long now_ms( void )
+
+    brief           Returns the time of day
+
+    return          long long, [ms] since the epoch
+*/
+static long long now_ms( void )
+    {
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (long long)now.tv_sec * 1000LL + now.tv_nsec / 1000000L;
+    }
+
+
+/*  function        static long long next_due( job_t const * p_job, long long now )
+
+    brief           Returns the first multiple of the job's period after now
+
+    param[in]       job_t const * p_job
+    param[in]       long long now, [ms] since the epoch
+
+    return          long long, [ms] since the epoch
+*/
+static long long next_due( job_t const * p_job, long long now )
+    {
+    long long period = p_job->period * 1000LL;
+
+    return ( now / period + 1 ) * period;
+    }
+
+
+/*  function        ERRNO jobs_init( jobs_t * p_jobs )
+
+    brief           Creates the timer, removes all jobs
+
+    param[out]      jobs_t * p_jobs
+
+    return          ERRNO
+*/
+ERRNO jobs_init( jobs_t * p_jobs )
+    {
+    memset(p_jobs, 0, sizeof(*p_jobs));
+    p_jobs->timer = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+
+    return ( p_jobs->timer < 0 ) ? ERR_TIMER : NOERR;
+    }
+
+
+/*  function        void jobs_deinit( jobs_t * p_jobs )
+
+    brief           Closes the timer
+
+    param[in]       jobs_t * p_jobs
+*/
+void jobs_deinit( jobs_t * p_jobs )
+    {
+    if( p_jobs->timer >= 0 )
+        close(p_jobs->timer);
+    p_jobs->timer = -1;
+    }
+
+
+/*  function        int job_add( jobs_t * p_jobs, char const * name, int period, job_func_t func, void * p_arg )
+
+    brief           Adds a periodic job, it runs first at the next multiple
+                    of its period
+
+    param[in]       jobs_t * p_jobs
+    param[in]       char const * name, for the statistics, not copied
+    param[in]       int period, [s], > 0
+    param[in]       job_func_t func, called when the job is due
+    param[in]       void * p_arg, passed to func
+
+    return          int, index of the job or -1 if there are too many jobs
+*/
+int job_add( jobs_t * p_jobs, char const * name, int period, job_func_t func, void * p_arg )
+    {
+    job_t * p_job;
+
+    if( p_jobs->count >= JOBS_MAX || period <= 0 || !func )
+        return -1;
+
+    p_job = &p_jobs->job[p_jobs->count];
+    memset(p_job, 0, sizeof(*p_job));
+    p_job->name = name;
+    p_job->period = period;
+    p_job->func = func;
+    p_job->p_arg = p_arg;
+    p_job->due = next_due(p_job, now_ms());
+
+    return p_jobs->count++;
+    }
+
+
+/*  function        ERRNO jobs_run( jobs_t * p_jobs )
+
+    brief           Runs the jobs until jobs_stop() is called
+
+    param[in]       jobs_t * p_jobs
+
+    return          ERRNO
+*/
+ERRNO jobs_run( jobs_t * p_jobs )
+    {
+    struct itimerspec timer;
+    uint64_t expirations;
+    long long now;
+    long long due;
+    long late;
+    job_t * p_job;
+    int i;
+
+    if( p_jobs->timer < 0 || p_jobs->count == 0 )
+        return ERR_TIMER;
+
+    while( !p_jobs->stop )
+        {
+        due = p_jobs->job[0].due;
+        for( i = 1; i < p_jobs->count; ++i )
+            {
+            if( p_jobs->job[i].due < due )
+                due = p_jobs->job[i].due;
+            }
+
+        memset(&timer, 0, sizeof(timer));
+        timer.it_value.tv_sec = (time_t)(due / 1000);
+        timer.it_value.tv_nsec = (long)(due % 1000) * 1000000L;
+        if( timerfd_settime(p_jobs->timer, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &timer, 0) < 0 )
+            return ERR_TIMER;
+        if( p_jobs->stop )                                                      // jobs_stop() came before the timer was set
+            break;
+
+        if( read(p_jobs->timer, &expirations, sizeof(expirations)) < 0 )
+            {
+            if( errno == ECANCELED )                                            // the clock was set
+                {
+                ++p_jobs->clock_jumps;
+                now = now_ms();
+                debug("Clock set, scheduling all jobs again\n");
+                for( i = 0; i < p_jobs->count; ++i )
+                    p_jobs->job[i].due = next_due(&p_jobs->job[i], now);
+                continue;
+                }
+            if( errno == EINTR )                                                // a signal, maybe jobs_stop()
+                continue;
+            return ERR_TIMER;
+            }
+
+        for( i = 0; i < p_jobs->count && !p_jobs->stop; ++i )
+            {
+            p_job = &p_jobs->job[i];
+            now = now_ms();
+            if( p_job->due > now )
+                continue;
+
+            late = (long)( now - p_job->due );
+            if( p_job->stats.runs == 0 || late < p_job->stats.late_min )
+                p_job->stats.late_min = late;
+            if( late > p_job->stats.late_max )
+                p_job->stats.late_max = late;
+            p_job->stats.late_sum += late;
+            ++p_job->stats.runs;
+
+            p_job->func(p_job->p_arg);
+
+            p_job->due = next_due(p_job, p_job->due);
+            now = now_ms();
+            if( p_job->due <= now )                                             // the job took longer than its period
+                {
+                p_job->stats.skipped += ( now - p_job->due ) / ( p_job->period * 1000LL ) + 1;
+                p_job->due = next_due(p_job, now);
+                }
+            }
+        }
+
+    return NOERR;
+    }
+
+
+/*  function        void jobs_stop( jobs_t * p_jobs )
+
+    brief           Makes jobs_run() return after the current job, may be
+                    called from a signal handler or from another thread
+
+    param[in]       jobs_t * p_jobs
+*/
+void jobs_stop( jobs_t * p_jobs )
+    {
+    struct itimerspec timer;
+
+    p_jobs->stop = 1;
+    memset(&timer, 0, sizeof(timer));
+    timer.it_value.tv_nsec = 1;                                                 // long ago, the timer expires at once
+    if( p_jobs->timer >= 0 )
+        timerfd_settime(p_jobs->timer, TFD_TIMER_ABSTIME, &timer, 0);
+    }
+
+
+/*  function        int jobs_count( jobs_t const * p_jobs )
+
+    brief           Returns the number of jobs
+
+    param[in]       jobs_t const * p_jobs
+
+    return          int
+*/
+int jobs_count( jobs_t const * p_jobs )
+    {
+    return p_jobs->count;
+    }
+
+
+/*  function        char const * job_name( jobs_t const * p_jobs, int job )
+
+    brief           Returns the name of a job
+
+    param[in]       jobs_t const * p_jobs
+    param[in]       int job, index returned by job_add()
+
+    return          char const *
+*/
+char const * job_name( jobs_t const * p_jobs, int job )
+    {
+    if( job < 0 || job >= p_jobs->count )
+        return "";
+
+    return p_jobs->job[job].name;
+    }
+
+
+/*  function        void job_stats( jobs_t const * p_jobs, int job, jobstat_t * p_stats )
+
+    brief           Returns how often and how late a job was started
+
+    param[in]       jobs_t const * p_jobs
+    param[in]       int job, index returned by job_add()
+    param[out]      jobstat_t * p_stats
+*/
+void job_stats( jobs_t const * p_jobs, int job, jobstat_t * p_stats )
+    {
+    if( job < 0 || job >= p_jobs->count )
+        {
+        memset(p_stats, 0, sizeof(*p_stats));
+        return;
+        }
+
+    *p_stats = p_jobs->job[job].stats;
+    }
+
+
+/*  function        long jobs_clock_jumps( jobs_t const * p_jobs )
+
+    brief           Returns how often the clock was set while jobs_run() was
+                    waiting
+
+    param[in]       jobs_t const * p_jobs
+
+    return          long
+*/
+long jobs_clock_jumps( jobs_t const * p_jobs )
+    {
+    return p_jobs->clock_jumps;
+    }
@@ -43,60 +43,41 @@
 
 
 #include "log.h"
+#include "station.h"
 #include "ws23k.h"
 #include <time.h>
 #include <unistd.h>
 #include <stdio.h>
-#include "ftp.h"
+#include <string.h>
+#include "upload.h"
 
 
-/*  function        int WaitForNextMinute( void )
-
-    brief           waits for the next minute to begin
-
-    return          int, 0 if timed out
-                        1 if key was pressed (not used now)
-*/
-int WaitForNextMinute( void )
-    {
-    time_t t;
-    for( ; ; )
-        {
-        sleep(2);
-#ifdef NIX
-        if( kbhit() )
-            {
-            getchar();
-            return 1;
-            }
-#endif    // NIX
-        t = time(0) % 60;
-        if( (t == 0) || (t == 1) )
-            return 0;
-        }
-    }
+#define HISTORY_LINE_LEN                        80                              // length of a history log line
 
 
-/*  function        ERRNO Log( void )
+/*  function        ERRNO Log( station_t * p_station, weatherdata_t const * p_weatherdata )
 
     brief           logs the weather data to the current day's log file
 
+    param[in]       station_t * p_station
+    param[in]       weatherdata_t const * p_weatherdata, the reading to log
+
     return          ERRNO
 */
-ERRNO Log( void )
+ERRNO Log( station_t * p_station, weatherdata_t const * p_weatherdata )
     {
     ERRNO error = NOERR;
     time_t basictime;
     char filename[256];
     char curr_date[11];
     char line[1024];
+    struct tm now;
     FILE * logfile;
-    weatherdata_t * p_weatherdata = get_weatherdata_ptr();
 
     sprintf(line, "%s", p_weatherdata->act_time);
     sprintf(line, "%s %6.2f", line, p_weatherdata->temperature);                // temperature [°C]
     sprintf(line, "%s %6.1f", line, p_weatherdata->pressure);                   // absolute pressure [hPa]
-    sprintf(line, "%s %6.1f", line, GetRelPressure());                          // relative pressure [hPa]
+    sprintf(line, "%s %6.1f", line, GetRelPressure(p_weatherdata));             // relative pressure [hPa]
     sprintf(line, "%s %3d", line, p_weatherdata->humidity);                     // relative humudity [%]
     sprintf(line, "%s %5.1f", line, p_weatherdata->direction);                  // wind direction [٠]
     sprintf(line, "%s %3s", line, p_weatherdata->dir);                          // wind direction
@@ -111,8 +92,8 @@ ERRNO Log( void )
     sprintf(line, "%s\n", line);
 
     time(&basictime);
-    strftime(curr_date, sizeof(curr_date), "%Y_%m_%d", localtime(&basictime));
-    sprintf(filename, "%s%sdata.log", log_path(), curr_date);
+    strftime(curr_date, sizeof(curr_date), "%Y_%m_%d", localtime_r(&basictime, &now));
+    sprintf(filename, "%s%sdata.log", p_station->config.log_path, curr_date);
     logfile = fopen(filename, "a+");
     if( logfile )
         {
@@ -122,8 +103,8 @@ ERRNO Log( void )
         fclose(logfile);
         }
 
-    sprintf(filename, "%s%sdata.log", ftp_log_path(), curr_date);
-    if( (error = AppendFile(filename, line)) != 0 )
+    sprintf(filename, "%s%sdata.log", p_station->config.ftp_log_path, curr_date);
+    if( (error = upload_append(p_station, filename, line)) != 0 )               // sent by the upload thread
         {
         printf("Error logging to server %d\n", error);
         return error;
@@ -131,3 +112,66 @@ ERRNO Log( void )
     
     return error;
     }
+
+
+/*  function        ERRNO LogHistory( station_t * p_station, history_record_t const * records, int n )
+
+    brief           logs history records to the history log file of the day
+                    each record was saved, all records of one day are
+                    appended at once
+
+    param[in]       station_t * p_station
+    param[in]       history_record_t const * records, oldest first
+    param[in]       int n, number of records
+
+    return          ERRNO
+*/
+ERRNO LogHistory( station_t * p_station, history_record_t const * records, int n )
+    {
+    char lines[HISTORY_RECORDS * HISTORY_LINE_LEN + 1];
+    ERRNO error = NOERR;
+    char filename[256];
+    char curr_date[11];
+    char record_date[11];
+    struct tm stamp;
+    char * p_line;
+    FILE * logfile;
+    int i = 0;
+
+    while( i < n )
+        {
+        strftime(curr_date, sizeof(curr_date), "%Y_%m_%d", localtime_r(&records[i].time, &stamp));
+        p_line = lines;
+        *p_line = 0;
+        for( ; i < n; ++i )
+            {
+            strftime(record_date, sizeof(record_date), "%Y_%m_%d", localtime_r(&records[i].time, &stamp));
+            if( strcmp(record_date, curr_date) != 0 )
+                break;
+            p_line += strftime(p_line, HISTORY_LINE_LEN, "%H:%M:%S", &stamp);
+            p_line += sprintf(p_line, " %6.1f", records[i].temperature_in);                 // indoor temperature [°C]
+            p_line += sprintf(p_line, " %6.1f", records[i].temperature_out);                // outdoor temperature [°C]
+            p_line += sprintf(p_line, " %6.1f", records[i].pressure);                       // absolute pressure [hPa]
+            p_line += sprintf(p_line, " %3d", records[i].humidity_in);                      // indoor humidity [%]
+            p_line += sprintf(p_line, " %3d", records[i].humidity_out);                     // outdoor humidity [%]
+            p_line += sprintf(p_line, " %4d", records[i].rain_count);                       // rain counter
+            p_line += sprintf(p_line, " %7.1f", records[i].rain_count * HISTORY_RAIN_STEP); // rain counter [mm]
+            p_line += sprintf(p_line, " %4.1f", records[i].speed);                          // wind speed [m/sec]
+            p_line += sprintf(p_line, " %5.1f\n", records[i].direction);                    // wind direction [°]
+            }
+
+        sprintf(filename, "%s%shistory.log", p_station->config.log_path, curr_date);
+        logfile = fopen(filename, "a+");
+        if( logfile )
+            {
+            fprintf(logfile, "%s", lines);
+            fclose(logfile);
+            }
+
+        sprintf(filename, "%s%shistory.log", p_station->config.ftp_log_path, curr_date);
+        if( (error = upload_append(p_station, filename, lines)) != 0 )
+            printf("Error logging history to server %d\n", error);
+        }
+
+    return error;
+    }
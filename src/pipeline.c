@@ -0,0 +1,195 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        pipeline.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Readings of all stations passed to one output thread
+
+    details     A ring of PIPELINE_SLOTS readings protected by a mutex. The
+                readers copy a reading in and signal the condition variable,
+                the output thread sleeps on it while the ring is empty.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The mutex is held only while a reading is copied.
+
+    todo
+
+*/
+
+
+#include <string.h>
+#include "debug.h"
+#include "pipeline.h"
+
+
+/*  function        ERRNO pipeline_init( pipeline_t * p_pipeline )
+
+    brief           Prepares an empty pipeline
+
+    param[out]      pipeline_t * p_pipeline
+
+    return          ERRNO
+*/
+ERRNO pipeline_init( pipeline_t * p_pipeline )
+    {
+    memset(p_pipeline, 0, sizeof(*p_pipeline));
+    if( pthread_mutex_init(&p_pipeline->lock, 0) )
+        return ERR_THREAD;
+    if( pthread_cond_init(&p_pipeline->ready, 0) )
+        {
+        pthread_mutex_destroy(&p_pipeline->lock);
+        return ERR_THREAD;
+        }
+
+    return NOERR;
+    }
+
+
+/*  function        void pipeline_deinit( pipeline_t * p_pipeline )
+
+    brief           Releases the mutex and the condition variable, no thread
+                    may use the pipeline any more
+
+    param[in]       pipeline_t * p_pipeline
+*/
+void pipeline_deinit( pipeline_t * p_pipeline )
+    {
+    pthread_cond_destroy(&p_pipeline->ready);
+    pthread_mutex_destroy(&p_pipeline->lock);
+    }
+
+
+/*  function        void pipeline_put( pipeline_t * p_pipeline, reading_t const * p_reading )
+
+    brief           Appends a copy of a reading, drops the oldest reading if
+                    the pipeline is full, its changes are passed on to the
+                    next reading of the same station
+
+    param[in]       pipeline_t * p_pipeline
+    param[in]       reading_t const * p_reading
+*/
+void pipeline_put( pipeline_t * p_pipeline, reading_t const * p_reading )
+    {
+    reading_t const * p_dropped;
+    unsigned int changed = 0;
+    int i;
+
+    pthread_mutex_lock(&p_pipeline->lock);
+    if( !p_pipeline->closed )
+        {
+        if( p_pipeline->count == PIPELINE_SLOTS )                               // the output is stuck, keep the latest readings
+            {
+            p_dropped = &p_pipeline->slot[p_pipeline->head];
+            for( i = 1; i < p_pipeline->count; ++i )
+                {
+                if( p_pipeline->slot[( p_pipeline->head + i ) % PIPELINE_SLOTS].p_station == p_dropped->p_station )
+                    break;
+                }
+            if( i < p_pipeline->count )
+                p_pipeline->slot[( p_pipeline->head + i ) % PIPELINE_SLOTS].data.changed |= p_dropped->data.changed;
+            else if( p_dropped->p_station == p_reading->p_station )
+                changed = p_dropped->data.changed;
+            p_pipeline->head = ( p_pipeline->head + 1 ) % PIPELINE_SLOTS;
+            --p_pipeline->count;
+            ++p_pipeline->dropped;
+            }
+        p_pipeline->slot[( p_pipeline->head + p_pipeline->count ) % PIPELINE_SLOTS] = *p_reading;
+        p_pipeline->slot[( p_pipeline->head + p_pipeline->count ) % PIPELINE_SLOTS].data.changed |= changed;
+        ++p_pipeline->count;
+        ++p_pipeline->put;
+        pthread_cond_signal(&p_pipeline->ready);
+        }
+    pthread_mutex_unlock(&p_pipeline->lock);
+    }
+
+
+/*  function        int pipeline_get( pipeline_t * p_pipeline, reading_t * p_reading )
+
+    brief           Takes the oldest reading out, waits while the pipeline is
+                    empty
+
+    param[in]       pipeline_t * p_pipeline
+    param[out]      reading_t * p_reading
+
+    return          int, 1 if there is a reading, 0 if the pipeline is
+                    closed and empty
+*/
+int pipeline_get( pipeline_t * p_pipeline, reading_t * p_reading )
+    {
+    int res = 0;
+
+    pthread_mutex_lock(&p_pipeline->lock);
+    while( p_pipeline->count == 0 && !p_pipeline->closed )
+        pthread_cond_wait(&p_pipeline->ready, &p_pipeline->lock);
+    if( p_pipeline->count > 0 )
+        {
+        *p_reading = p_pipeline->slot[p_pipeline->head];
+        p_pipeline->head = ( p_pipeline->head + 1 ) % PIPELINE_SLOTS;
+        --p_pipeline->count;
+        res = 1;
+        }
+    pthread_mutex_unlock(&p_pipeline->lock);
+
+    return res;
+    }
+
+
+/*  function        void pipeline_close( pipeline_t * p_pipeline )
+
+    brief           Refuses further readings, pipeline_get() returns 0 as soon
+                    as the readings left are taken out
+
+    param[in]       pipeline_t * p_pipeline
+*/
+void pipeline_close( pipeline_t * p_pipeline )
+    {
+    pthread_mutex_lock(&p_pipeline->lock);
+    p_pipeline->closed = 1;
+    pthread_cond_broadcast(&p_pipeline->ready);
+    pthread_mutex_unlock(&p_pipeline->lock);
+    debug("Pipeline closed\n");
+    }
+
+
+/*  function        void pipeline_stats( pipeline_t * p_pipeline, long * p_put, long * p_dropped )
+
+    brief           Returns how many readings were put in and how many of them
+                    were dropped
+
+    param[in]       pipeline_t * p_pipeline
+    param[out]      long * p_put
+    param[out]      long * p_dropped
+*/
+void pipeline_stats( pipeline_t * p_pipeline, long * p_put, long * p_dropped )
+    {
+    pthread_mutex_lock(&p_pipeline->lock);
+    *p_put = p_pipeline->put;
+    *p_dropped = p_pipeline->dropped;
+    pthread_mutex_unlock(&p_pipeline->lock);
+    }
@@ -22,7 +22,7 @@
 
     file        sercom.c
 
-    date        18.06.2017
+    date        17.10.2026
 
     author      Uwe Jantzen (jantzen@klabautermann-software.de)
 
@@ -32,11 +32,37 @@
                 compatible weather station.
                 The API includes
                 - ws_init
+                - ws_deinit
                 - ws_open
                 - ws_close
                 - ws_read
                 - ws_write
                 - ws_reset
+                - ws_counters
+                - ws_set_timeouts
+                - ws_set_trace
+
+                All state of a port is kept in a serport_t of the caller, so
+                several ports can be used at the same time.
+
+                The port is used non-blocking. Every read waits with poll()
+                for the first byte of an answer at most the response timeout
+                and for each following byte at most the byte timeout, so a
+                lost byte costs milliseconds instead of a second.
+
+                All bytes written and read can be recorded to a trace file.
+                A trace can be replayed instead of using the serial port, the
+                bytes written are then compared with the recorded ones and the
+                recorded answers are returned with the recorded timing,
+                optionally accelerated.
+                Trace file format : the header "WS23TRC1" followed by records
+                of
+                    uint32_t    time since the previous record [us], little endian
+                    uint8_t     direction, TRACE_TX or TRACE_RX
+                    uint8_t     number of bytes n
+                    uint8_t     n bytes
+                When the replay reaches the end of the trace ws_read() and
+                ws_write() fail, the next ws_open() starts the trace again.
 
     project     weather23k
     target      Linux
@@ -54,62 +80,305 @@
 #include "debug.h"
 #include "sercom.h"
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/file.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <stdio.h>
 #include <string.h>
 
 
-#define PORTNAME_LEN                    255
+#define CHAR_TIME                       4167                                    // [us] 10 bits at 2400 baud
+#define RESPONSE_TIMEOUT                100000                                  // [us] default wait for the first byte of an answer
+#define BYTE_TIMEOUT                    (4 * CHAR_TIME)                         // [us] default wait for each following byte
 
+#define TRACE_MAGIC                     "WS23TRC1"
+#define TRACE_MAGIC_LEN                 8
+#define TRACE_TX                        'w'                                     // bytes written to the station
+#define TRACE_RX                        'r'                                     // bytes read from the station
 
-static int the_handle = -1;                                                     // the serial port's handle
-static char the_port[PORTNAME_LEN+1] = {0 };                                    // the serial port's name
 
+/*  function        static void set_deadline( struct timespec * deadline, long timeout )
 
-/*  function        int ws_init( char * name )
+    brief           calculates the point of time a timeout will be reached
+
+    param[out]      struct timespec * deadline
+    param[in]       long timeout, [us] from now
+*/
+static void set_deadline( struct timespec * deadline, long timeout )
+    {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout / 1000000;
+    deadline->tv_nsec += (timeout % 1000000) * 1000;
+    if( deadline->tv_nsec >= 1000000000 )
+        {
+        deadline->tv_nsec -= 1000000000;
+        ++deadline->tv_sec;
+        }
+    }
+
+
+/*  function        static int wait_for( serport_t * p_port, short events, struct timespec const * deadline )
+
+    brief           waits until the serial port is ready for events or the
+                    deadline is reached
+
+    param[in]       serport_t * p_port
+    param[in]       short events, POLLIN or POLLOUT
+    param[in]       struct timespec const * deadline
+
+    return          int, > 0 if the port is ready, 0 on timeout, < 0 on error
+*/
+static int wait_for( serport_t * p_port, short events, struct timespec const * deadline )
+    {
+    struct pollfd pfd;
+    struct timespec now;
+    long remaining;
+    int ret;
+
+    pfd.fd = p_port->handle;
+    pfd.events = events;
+
+    for( ; ; )
+        {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining = (deadline->tv_sec - now.tv_sec) * 1000000 + (deadline->tv_nsec - now.tv_nsec) / 1000;
+        if( remaining < 0 )
+            remaining = 0;
+
+        ret = poll(&pfd, 1, (int)((remaining + 999) / 1000));                   // poll() counts in ms, round up
+        if( ret < 0 && errno == EINTR )
+            continue;
+        if( ret > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) && !(pfd.revents & events) )
+            return -1;
+        return ret;
+        }
+    }
+
+
+/*  function        static void trace_record( serport_t * p_port, int dir, uint8_t const * data, size_t n )
+
+    brief           appends bytes written or read to the trace file
+
+    param[in]       serport_t * p_port
+    param[in]       int dir, TRACE_TX or TRACE_RX
+    param[in]       uint8_t const * data, bytes
+    param[in]       size_t n, number of bytes
+*/
+static void trace_record( serport_t * p_port, int dir, uint8_t const * data, size_t n )
+    {
+    struct timespec now;
+    unsigned long delta;
+    uint8_t header[6];
+    size_t len;
+
+    if( !p_port->trace )
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if( p_port->trace_time.tv_sec == 0 && p_port->trace_time.tv_nsec == 0 )     // the trace starts with its first byte
+        delta = 0;
+    else
+        delta = (now.tv_sec - p_port->trace_time.tv_sec) * 1000000UL + (now.tv_nsec - p_port->trace_time.tv_nsec) / 1000;
+    p_port->trace_time = now;
+
+    while( n > 0 )
+        {
+        len = ( n > TRACE_MAX_RECORD ) ? TRACE_MAX_RECORD : n;
+        header[0] = (uint8_t)delta;
+        header[1] = (uint8_t)(delta >> 8);
+        header[2] = (uint8_t)(delta >> 16);
+        header[3] = (uint8_t)(delta >> 24);
+        header[4] = (uint8_t)dir;
+        header[5] = (uint8_t)len;
+        fwrite(header, 1, sizeof(header), p_port->trace);
+        fwrite(data, 1, len, p_port->trace);
+        data += len;
+        n -= len;
+        delta = 0;
+        }
+
+    fflush(p_port->trace);                                                      // keep the trace usable if the program is killed
+    }
+
+
+/*  function        static int replay_peek( serport_t * p_port )
+
+    brief           makes sure a record of the replay with unused bytes is
+                    available, waits the recorded time before a new record is
+                    used
+
+    param[in]       serport_t * p_port
+
+    return          int, direction of the record or 0 at the end of the trace
+*/
+static int replay_peek( serport_t * p_port )
+    {
+    uint8_t header[6];
+    unsigned long delta;
+
+    if( p_port->record_pos < p_port->record_len )
+        return p_port->record_dir;
+
+    p_port->record_dir = 0;
+    p_port->record_len = 0;
+    p_port->record_pos = 0;
+
+    if( fread(header, 1, sizeof(header), p_port->replay) != sizeof(header) )
+        return 0;
+    if( (int)fread(p_port->record, 1, header[5], p_port->replay) != header[5] || header[5] == 0 )
+        return 0;
+
+    delta = header[0] | (header[1] << 8) | ((unsigned long)header[2] << 16) | ((unsigned long)header[3] << 24);
+    if( p_port->replay_speed > 0 && delta / p_port->replay_speed > 0 )
+        usleep(delta / p_port->replay_speed);
+
+    p_port->record_dir = header[4];
+    p_port->record_len = header[5];
+    return p_port->record_dir;
+    }
+
+
+/*  function        ERRNO ws_set_trace( serport_t * p_port, char const * record, char const * replay, int speed )
+
+    brief           starts recording the communication to a trace file or
+                    replaying a recorded trace instead of using the serial port
+
+    param[in]       serport_t * p_port
+    param[in]       char const * record, trace file to write, 0 or empty = none
+    param[in]       char const * replay, trace file to replay, 0 or empty = none
+    param[in]       int speed, replay speed factor : 1 = real time,
+                               n = n times faster, 0 = no delays
+
+    return          ERRNO
+*/
+ERRNO ws_set_trace( serport_t * p_port, char const * record, char const * replay, int speed )
+    {
+    char magic[TRACE_MAGIC_LEN];
+
+    if( replay && *replay )
+        {
+        p_port->replay = fopen(replay, "rb");
+        if( !p_port->replay )
+            return ERR_OPEN_FILE;
+        if( fread(magic, 1, TRACE_MAGIC_LEN, p_port->replay) != TRACE_MAGIC_LEN
+            || memcmp(magic, TRACE_MAGIC, TRACE_MAGIC_LEN) != 0 )
+            {
+            fclose(p_port->replay);
+            p_port->replay = 0;
+            return ERR_OPEN_FILE;
+            }
+        p_port->replay_speed = ( speed > 0 ) ? speed : 0;
+        }
+
+    if( record && *record )
+        {
+        p_port->trace = fopen(record, "wb");
+        if( !p_port->trace )
+            return ERR_OPEN_FILE;
+        fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_LEN, p_port->trace);
+        }
+
+    return NOERR;
+    }
+
+
+/*  function        void ws_set_timeouts( serport_t * p_port, long response, long byte )
+
+    brief           sets the timeouts used by ws_read() and ws_write()
+
+    param[in]       serport_t * p_port
+    param[in]       long response, [us] wait for the first byte of an answer,
+                                   0 = default
+    param[in]       long byte, [us] wait for each following byte, 0 = default
+*/
+void ws_set_timeouts( serport_t * p_port, long response, long byte )
+    {
+    p_port->response_timeout = ( response > 0 ) ? response : RESPONSE_TIMEOUT;
+    p_port->byte_timeout = ( byte > 0 ) ? byte : BYTE_TIMEOUT;
+    }
+
+
+/*  function        int ws_init( serport_t * p_port, char * name )
 
     brief           Initializes the serial line connection to the WS2300
-                    weather station connected to <name>
+                    weather station connected to <name>, the port is not
+                    opened and uses the default timeouts
 
-    param[in]       char * name, a string containing a device name like
+    param[out]      serport_t * p_port
+    param[in]       char * name, a string containing a device name like
                     /dev/ttyS0 or /dev/ttyUSB1
 
     return          ERRNO
-*/
-int ws_init( char * name )
+*/
+int ws_init( serport_t * p_port, char * name )
     {
-    if( strlen(name) > 255 )
+    memset(p_port, 0, sizeof(*p_port));
+    p_port->handle = -1;
+    p_port->response_timeout = RESPONSE_TIMEOUT;
+    p_port->byte_timeout = BYTE_TIMEOUT;
+    p_port->replay_speed = 1;
+
+    if( strlen(name) > PORTNAME_LEN )
         return ERR_NAME;
 
-    strncpy(the_port, name, PORTNAME_LEN);
+    strncpy(p_port->name, name, PORTNAME_LEN);
 
     return NOERR;
     }
 
 
-/*  function        int ws_open( void )
+/*  function        void ws_deinit( serport_t * p_port )
+
+    brief           closes the trace files of the port
+
+    param[in]       serport_t * p_port
+*/
+void ws_deinit( serport_t * p_port )
+    {
+    if( p_port->trace )
+        fclose(p_port->trace);
+    if( p_port->replay )
+        fclose(p_port->replay);
+    p_port->trace = 0;
+    p_port->replay = 0;
+    }
+
+
+/*  function        int ws_open( serport_t * p_port )
 
     brief           opens a serial connection to a WS2300 weather station using
                     the port given by ws_init()
 
+    param[in]       serport_t * p_port
+
     return          ERRNO
 */
-ERRNO ws_open( void )
+ERRNO ws_open( serport_t * p_port )
     {
     struct termios control;
     int portstatus;
     ERRNO error = NOERR;
 
-    if( strlen(the_port) == 0 )
+    if( p_port->replay )                                                        // start the trace again
+        {
+        fseek(p_port->replay, TRACE_MAGIC_LEN, SEEK_SET);
+        p_port->record_len = 0;
+        p_port->record_pos = 0;
+        return NOERR;
+        }
+
+    if( strlen(p_port->name) == 0 )
         return ERR_NO_PORT;
 
-    the_handle = open(the_port, O_RDWR | O_NOCTTY);
-    if( the_handle < 0 )
+    p_port->handle = open(p_port->name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if( p_port->handle < 0 )
         return ERR_NO_HANDLE;
 
-    if( flock(the_handle, LOCK_EX) < 0 )
+    if( flock(p_port->handle, LOCK_EX) < 0 )
         {
         error = ERR_LOCKED;
         goto finish_ws_open;
@@ -133,133 +402,256 @@ ERRNO ws_open( void )
     control.c_lflag = 0;
     control.c_iflag = IGNBRK|IGNPAR;
     control.c_oflag &= ~OPOST;
-    control.c_cc[VTIME] = 10;                                                   // 1 sec timeout
-    control.c_cc[VMIN] = 0;                                                     // block read to first char
+    control.c_cc[VTIME] = 0;                                                    // timeouts are handled by poll()
+    control.c_cc[VMIN] = 0;
 
-    if( tcsetattr(the_handle, TCSANOW, &control) < 0 )
+    if( tcsetattr(p_port->handle, TCSANOW, &control) < 0 )
         {
         error = ERR_INIT_PORT;
         goto finish_ws_open;
         }
 
-    tcflush(the_handle, TCIOFLUSH);
+    tcflush(p_port->handle, TCIOFLUSH);
 
     // simulate the heavyweather behaviour
-    ioctl(the_handle, TIOCMGET, &portstatus);                                   // get current port status
+    ioctl(p_port->handle, TIOCMGET, &portstatus);                               // get current port status
     portstatus |= TIOCM_DTR;
     portstatus &= ~TIOCM_RTS;
-    ioctl(the_handle, TIOCMSET, &portstatus);                                   // set current port status
+    ioctl(p_port->handle, TIOCMSET, &portstatus);                               // set current port status
     usleep(10000);
     portstatus |= TIOCM_RTS;
-    ioctl(the_handle, TIOCMSET, &portstatus);                                   // set current port status
+    ioctl(p_port->handle, TIOCMSET, &portstatus);                               // set current port status
     usleep(46000);
     portstatus &= ~TIOCM_DTR;
-    ioctl(the_handle, TIOCMSET, &portstatus);                                   // set current port status
+    ioctl(p_port->handle, TIOCMSET, &portstatus);                               // set current port status
     sleep(2);
     return error;
 
 finish_ws_open:
-    close(the_handle);
+    close(p_port->handle);
+    p_port->handle = -1;
     return error;
     }
 
 
-/*  function        ERRNO ws_close( void )
+/*  function        ERRNO ws_close( serport_t * p_port )
 
     brief           close the 
 
+    param[in]       serport_t * p_port
+
     return          ERRNO
 */
-ERRNO ws_close( void )
+ERRNO ws_close( serport_t * p_port )
     {
     int portstatus;
 
+    if( p_port->replay )
+        return NOERR;
+
     // simulate the heavyweather behaviour
-    tcflush(the_handle, TCIOFLUSH);
+    tcflush(p_port->handle, TCIOFLUSH);
 
     usleep(100000);
 
-    ioctl(the_handle, TIOCMGET, &portstatus);                                   // get current port status
+    ioctl(p_port->handle, TIOCMGET, &portstatus);                               // get current port status
     portstatus |= TIOCM_DTR;
-    ioctl(the_handle, TIOCMSET, &portstatus);                                   // set current port status
+    ioctl(p_port->handle, TIOCMSET, &portstatus);                               // set current port status
     usleep(3000);
     portstatus &= ~TIOCM_DTR;
     portstatus &= ~TIOCM_RTS;
-    ioctl(the_handle, TIOCMSET, &portstatus);                                   // set current port status
+    ioctl(p_port->handle, TIOCMSET, &portstatus);                               // set current port status
 
-    tcflush(the_handle, TCIOFLUSH);
+    tcflush(p_port->handle, TCIOFLUSH);
 
-    close(the_handle);
+    close(p_port->handle);
+    p_port->handle = -1;
 
     return NOERR;
     }
 
 
-/*  function        size_t ws_read( uint8_t * dst, size_t n )
+/*  function        size_t ws_read( serport_t * p_port, uint8_t * dst, size_t n )
 
     brief           reads bytes from the weather station until no more byte are
                     sent or the destination buffer is full
 
+    param[in]       serport_t * p_port
     param[out]      uint8_t * dst, buffer to read into
     param[in]       size_t n, maximum number of bytes to read (size of destination buffer)
 
     return          size_t, number of bytes really read
 */
-size_t ws_read( uint8_t * dst, size_t n )
+size_t ws_read( serport_t * p_port, uint8_t * dst, size_t n )
     {
-    int i;
+    struct timespec deadline;
+    size_t done = 0;
+    ssize_t i;
 
-    do
-        i = read(the_handle, dst, n);
-    while( i == 0 && errno == EINTR );
+    if( p_port->replay )                                                        // the recorded answer ends at the next written byte
+        {
+        while( ( done < n ) && ( replay_peek(p_port) == TRACE_RX ) )
+            {
+            i = p_port->record_len - p_port->record_pos;
+            if( (size_t)i > n - done )
+                i = n - done;
+            memcpy(dst + done, p_port->record + p_port->record_pos, i);
+            p_port->record_pos += i;
+            done += i;
+            }
+        p_port->bytes_rx += done;
+        return done;
+        }
+
+    set_deadline(&deadline, p_port->response_timeout);
+
+    while( done < n )
+        {
+        if( wait_for(p_port, POLLIN, &deadline) <= 0 )                          // timeout or error
+            break;
+
+        i = read(p_port->handle, dst + done, n - done);
+        if( i < 0 && ( errno == EINTR || errno == EAGAIN ) )
+            continue;
+        if( i <= 0 )
+            break;
+
+        trace_record(p_port, TRACE_RX, dst + done, i);
+        done += i;
+        p_port->bytes_rx += i;
+        set_deadline(&deadline, p_port->byte_timeout);
+        }
 
-    return i;
+    return done;
     }
 
 
-/*  function        size_t ws_write( uint8_t * src, size_t n )
+/*  function        size_t ws_write( serport_t * p_port, uint8_t * src, size_t n )
 
     brief           writes the contents of src to the weather station
 
+    param[in]       serport_t * p_port
     param[in]       uint8_t * src, buffer to write
     param[in]       size_t n, number of bytes to write
 
     return          size_t, number of bytes really written
 */
-size_t ws_write( uint8_t * src, size_t n )
+size_t ws_write( serport_t * p_port, uint8_t * src, size_t n )
     {
-    n = write(the_handle, src, n);
+    struct timespec deadline;
+    size_t done = 0;
+    ssize_t i;
+    int dir;
+
+    if( p_port->replay )
+        {
+        while( done < n )
+            {
+            dir = replay_peek(p_port);
+            if( dir == 0 )                                                      // end of trace
+                break;
+            if( dir == TRACE_RX )                                               // answer not read completely by the caller
+                {
+                p_port->record_pos = p_port->record_len;
+                continue;
+                }
+            if( p_port->record[p_port->record_pos] != src[done] )
+                debug("Replay : written 0x%02x, recorded 0x%02x\n", src[done], p_port->record[p_port->record_pos]);
+            ++p_port->record_pos;
+            ++done;
+            }
+        p_port->bytes_tx += done;
+        return done;
+        }
 
-    tcdrain(the_handle);                                                        // wait for all output written
+    set_deadline(&deadline, p_port->response_timeout + (long)n * CHAR_TIME);
 
-    return n;
+    while( done < n )
+        {
+        if( wait_for(p_port, POLLOUT, &deadline) <= 0 )                         // timeout or error
+            break;
+
+        i = write(p_port->handle, src + done, n - done);
+        if( i < 0 && ( errno == EINTR || errno == EAGAIN ) )
+            continue;
+        if( i <= 0 )
+            break;
+
+        trace_record(p_port, TRACE_TX, src + done, i);
+        done += i;
+        }
+
+    tcdrain(p_port->handle);                                                    // wait for all output written
+
+    p_port->bytes_tx += done;
+
+    return done;
     }
 
 
-/*  function        ERRNO ws_flush( void )
+/*  function        void ws_counters( serport_t * p_port, unsigned long * tx, unsigned long * rx )
+
+    brief           returns the number of bytes written to and read from the
+                    weather station since the last call of ws_clear_counters()
+
+    param[in]       serport_t * p_port
+    param[out]      unsigned long * tx, bytes written
+    param[out]      unsigned long * rx, bytes read
+*/
+void ws_counters( serport_t * p_port, unsigned long * tx, unsigned long * rx )
+    {
+    *tx = p_port->bytes_tx;
+    *rx = p_port->bytes_rx;
+    }
+
+
+/*  function        void ws_clear_counters( serport_t * p_port )
+
+    brief           sets the byte counters to zero
+
+    param[in]       serport_t * p_port
+*/
+void ws_clear_counters( serport_t * p_port )
+    {
+    p_port->bytes_tx = 0;
+    p_port->bytes_rx = 0;
+    }
+
+
+/*  function        ERRNO ws_flush( serport_t * p_port )
 
     brief           flushes output buffer
 
+    param[in]       serport_t * p_port
+
     return          ERRNO
 */
-ERRNO ws_flush( void )
+ERRNO ws_flush( serport_t * p_port )
     {
-    if( tcflush(the_handle, TCOFLUSH) )
+    if( p_port->replay )
+        return NOERR;
+
+    if( tcflush(p_port->handle, TCOFLUSH) )
         return ERR_COMM_ERR;
 
     return NOERR;
     }
 
 
-/*  function        ERRNO ws_clear( void )
+/*  function        ERRNO ws_clear( serport_t * p_port )
 
     brief           flushes input buffer
 
+    param[in]       serport_t * p_port
+
     return          ERRNO
 */
-ERRNO ws_clear( void )
+ERRNO ws_clear( serport_t * p_port )
     {
-    if( tcflush(the_handle, TCIFLUSH) )
+    if( p_port->replay )
+        return NOERR;
+
+    if( tcflush(p_port->handle, TCIFLUSH) )
         return ERR_COMM_ERR;
 
     return NOERR;
@@ -0,0 +1,455 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        spool.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Lines for the log files on the server kept on disk until
+                they are sent
+
+    details     A record is written with one writev() and synced before
+                spool_add() returns. The checkpoint is written to a new
+                file that is synced and renamed over the old one, so it is
+                either the old or the new offset after a crash.
+
+                After all records are sent the segment is truncated first
+                and the checkpoint set to 0 after. A crash in between
+                leaves a checkpoint behind the end of the segment, which
+                spool_open() takes as an empty spool and sets to 0 on
+                disk before any new record is added. A crash before the
+                checkpoint is written sends the last records again.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The upload thread adds, reads and commits the records. The
+                readers hand the log lines they drop from a full upload
+                queue to the upload thread (upload.c) instead of adding
+                them, so the records keep the order of the lines. The other
+                threads only read the statistics. The lock is never held
+                during a transfer.
+
+    todo
+
+*/
+
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "debug.h"
+#include "spool.h"
+
+
+#define SPOOL_HEADER                            300                             // [bytes] of a record's header at most
+
+
+/*  function        static int read_header( spool_t * p_spool, long pos, char * logfile, size_t size, long * p_len )
+
+    brief           Reads the header of the record at pos
+
+    param[in]       spool_t * p_spool
+    param[in]       long pos, offset in the segment
+    param[out]      char * logfile, 0 : not needed
+    param[in]       size_t size, of logfile
+    param[out]      long * p_len, bytes of text
+
+    return          int, bytes of the header, 0 if there is no whole record
+                    at pos
+*/
+static int read_header( spool_t * p_spool, long pos, char * logfile, size_t size, long * p_len )
+    {
+    char header[SPOOL_HEADER + 1];
+    char * p_tab;
+    char * p_end;
+    ssize_t got;
+    long len;
+
+    got = pread(p_spool->fd, header, SPOOL_HEADER, pos);
+    if( got <= 0 )
+        return 0;
+    header[got] = 0;
+
+    p_end = memchr(header, '\n', got);
+    p_tab = memchr(header, '\t', got);
+    if( !p_end || !p_tab || p_tab > p_end )
+        return 0;
+    *p_end = 0;
+    len = strtol(p_tab + 1, 0, 10);
+    if( len <= 0 || pos + ( p_end + 1 - header ) + len > p_spool->size )        // cut off
+        return 0;
+
+    if( logfile )
+        {
+        *p_tab = 0;
+        snprintf(logfile, size, "%s", header);
+        }
+    *p_len = len;
+    return (int)( p_end + 1 - header );
+    }
+
+
+/*  function        static ERRNO write_checkpoint( spool_t * p_spool, long done )
+
+    brief           Replaces the checkpoint file, the directory is synced
+                    after the rename so the new name survives a crash
+
+    param[in]       spool_t * p_spool
+    param[in]       long done, offset of the first record not yet sent
+
+    return          ERRNO
+*/
+static ERRNO write_checkpoint( spool_t * p_spool, long done )
+    {
+    char name[sizeof(p_spool->checkpoint) + 8];
+    char * p_slash;
+    FILE * p_file;
+    int fd;
+
+    snprintf(name, sizeof(name), "%s.new", p_spool->checkpoint);
+    p_file = fopen(name, "w");
+    if( !p_file )
+        return ERR_SPOOL_FILE;
+
+    fprintf(p_file, "%ld\n", done);
+    fflush(p_file);
+    fsync(fileno(p_file));
+    fclose(p_file);
+    if( rename(name, p_spool->checkpoint) )
+        return ERR_SPOOL_FILE;
+
+    snprintf(name, sizeof(name), "%s", p_spool->checkpoint);                    // the path is a prefix, the directory ends at the last '/'
+    p_slash = strrchr(name, '/');
+    if( p_slash )
+        p_slash[1] = 0;
+    else
+        strcpy(name, ".");
+    fd = open(name, O_RDONLY | O_DIRECTORY);
+    if( fd < 0 )
+        return ERR_SPOOL_FILE;
+    fsync(fd);
+    close(fd);
+
+    return NOERR;
+    }
+
+
+/*  function        ERRNO spool_open( spool_t * p_spool, char const * path, long max )
+
+    brief           Opens the spool of a station, removes a record cut off
+                    by a crash
+
+    param[out]      spool_t * p_spool
+    param[in]       char const * path, prefix of the spool files, "" : no
+                    spool
+    param[in]       long max, [bytes] of records not yet sent
+
+    return          ERRNO
+*/
+ERRNO spool_open( spool_t * p_spool, char const * path, long max )
+    {
+    FILE * p_file;
+    long pos;
+    long len;
+    int header;
+
+    memset(p_spool, 0, sizeof(*p_spool));
+    p_spool->fd = -1;
+    pthread_mutex_init(&p_spool->lock, 0);
+    if( !*path )
+        return NOERR;
+
+    snprintf(p_spool->segment, sizeof(p_spool->segment), "%s%s", path, SPOOL_SEGMENT);
+    snprintf(p_spool->checkpoint, sizeof(p_spool->checkpoint), "%s%s", path, SPOOL_CHECKPOINT);
+    p_spool->max = max;
+    p_spool->fd = open(p_spool->segment, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if( p_spool->fd < 0 )
+        return ERR_SPOOL_FILE;
+    p_spool->size = lseek(p_spool->fd, 0, SEEK_END);
+
+    p_file = fopen(p_spool->checkpoint, "r");
+    if( p_file )
+        {
+        if( fscanf(p_file, "%ld", &p_spool->done) != 1 )
+            p_spool->done = 0;
+        fclose(p_file);
+        }
+    if( p_spool->done < 0 || p_spool->done > p_spool->size )                    // truncated after all records were sent
+        {
+        p_spool->done = 0;
+        if( write_checkpoint(p_spool, 0) )                                      // before new records, the old offset may point into them
+            return ERR_SPOOL_FILE;
+        }
+
+    for( pos = p_spool->done; pos < p_spool->size; pos += header + len )
+        {
+        header = read_header(p_spool, pos, 0, 0, &len);
+        if( !header )
+            {
+            debug("Spool %s cut off at %ld\n", p_spool->segment, pos);
+            if( ftruncate(p_spool->fd, pos) )
+                return ERR_SPOOL_FILE;
+            p_spool->size = pos;
+            break;
+            }
+        }
+
+    p_spool->next = p_spool->done;
+    p_spool->stats.pending = p_spool->size - p_spool->done;
+    p_spool->active = 1;
+    debug("Spool %s : %ld bytes not sent\n", p_spool->segment, p_spool->stats.pending);
+    return NOERR;
+    }
+
+
+/*  function        void spool_close( spool_t * p_spool )
+
+    brief           Closes the segment, the records not yet sent stay in it
+
+    param[in]       spool_t * p_spool
+*/
+void spool_close( spool_t * p_spool )
+    {
+    if( p_spool->fd >= 0 )
+        close(p_spool->fd);
+    p_spool->fd = -1;
+    p_spool->active = 0;
+    pthread_mutex_destroy(&p_spool->lock);
+    }
+
+
+/*  function        int spool_active( spool_t * p_spool )
+
+    brief           Tells whether the station has a spool
+
+    param[in]       spool_t * p_spool
+
+    return          int, 1 if spool_open() opened a segment
+*/
+int spool_active( spool_t * p_spool )
+    {
+    return p_spool->active;
+    }
+
+
+/*  function        long spool_pending( spool_t * p_spool )
+
+    brief           Returns the bytes of the records not yet sent
+
+    param[in]       spool_t * p_spool
+
+    return          long, 0 if there is no spool
+*/
+long spool_pending( spool_t * p_spool )
+    {
+    long pending;
+
+    if( !p_spool->active )
+        return 0;
+
+    pthread_mutex_lock(&p_spool->lock);
+    pending = p_spool->size - p_spool->done;
+    pthread_mutex_unlock(&p_spool->lock);
+
+    return pending;
+    }
+
+
+/*  function        ERRNO spool_add( spool_t * p_spool, char const * logfile, char const * text )
+
+    brief           Appends a record and syncs it to the disk
+
+    param[in]       spool_t * p_spool
+    param[in]       char const * logfile, remote path
+    param[in]       char const * text
+
+    return          ERRNO, ERR_SPOOL_FULL if the records not yet sent would
+                    exceed the size of the spool
+*/
+ERRNO spool_add( spool_t * p_spool, char const * logfile, char const * text )
+    {
+    char header[SPOOL_HEADER];
+    struct iovec parts[2];
+    long len = strlen(text);
+    ERRNO error = NOERR;
+    int header_len;
+
+    if( !p_spool->active )
+        return ERR_SPOOL_FILE;
+
+    header_len = snprintf(header, sizeof(header), "%s\t%ld\n", logfile, len);
+    if( header_len >= SPOOL_HEADER || len == 0 )
+        return ERR_SPOOL_FILE;
+
+    pthread_mutex_lock(&p_spool->lock);
+    if( p_spool->size - p_spool->done + header_len + len > p_spool->max )
+        {
+        ++p_spool->stats.dropped;
+        error = ERR_SPOOL_FULL;
+        goto end_spool_add;
+        }
+
+    parts[0].iov_base = header;
+    parts[0].iov_len = header_len;
+    parts[1].iov_base = (void *)text;
+    parts[1].iov_len = len;
+    if( writev(p_spool->fd, parts, 2) != header_len + len || fdatasync(p_spool->fd) )
+        {
+        if( ftruncate(p_spool->fd, p_spool->size) )                             // no half record, spool_open() would remove it anyway
+            debug("Spool %s not truncated\n", p_spool->segment);
+        error = ERR_SPOOL_FILE;
+        goto end_spool_add;
+        }
+    p_spool->size += header_len + len;
+    ++p_spool->stats.spooled;
+    p_spool->stats.pending = p_spool->size - p_spool->done;
+
+end_spool_add:
+    pthread_mutex_unlock(&p_spool->lock);
+    return error;
+    }
+
+
+/*  function        ERRNO spool_peek( spool_t * p_spool, char * logfile, size_t size, char ** pp_text )
+
+    brief           Reads the oldest records not yet sent that belong to the
+                    same log file, up to SPOOL_BATCH bytes of text, at least
+                    one record
+
+    param[in]       spool_t * p_spool
+    param[out]      char * logfile, remote path of the records
+    param[in]       size_t size, of logfile
+    param[out]      char ** pp_text, the texts of the records, to be freed
+                    by the caller
+
+    return          ERRNO, ERR_NO_LOG_DATA if all records are sent
+*/
+ERRNO spool_peek( spool_t * p_spool, char * logfile, size_t size, char ** pp_text )
+    {
+    char name[SPOOL_HEADER + 1];
+    char * p_text = 0;
+    char * p_more;
+    long total = 0;
+    long pos;
+    long len;
+    int header;
+    ERRNO error = NOERR;
+
+    *pp_text = 0;
+    if( !p_spool->active )
+        return ERR_NO_LOG_DATA;
+
+    pthread_mutex_lock(&p_spool->lock);
+    for( pos = p_spool->done; pos < p_spool->size; pos += header + len )
+        {
+        header = read_header(p_spool, pos, name, sizeof(name), &len);
+        if( !header )
+            break;
+        if( total == 0 )
+            snprintf(logfile, size, "%s", name);
+        else if( strcmp(name, logfile) != 0 || total + len > SPOOL_BATCH )      // one append per file
+            break;
+
+        p_more = realloc(p_text, total + len + 1);
+        if( !p_more )
+            {
+            error = ERR_OUT_OF_MEMORY;
+            break;
+            }
+        p_text = p_more;
+        if( pread(p_spool->fd, p_text + total, len, pos + header) != len )
+            {
+            error = ERR_SPOOL_FILE;
+            break;
+            }
+        total += len;
+        p_text[total] = 0;
+        }
+    p_spool->next = pos;
+    p_spool->next_text = total;
+    pthread_mutex_unlock(&p_spool->lock);
+
+    if( error || total == 0 )
+        {
+        free(p_text);
+        return error ? error : ERR_NO_LOG_DATA;
+        }
+
+    *pp_text = p_text;
+    return NOERR;
+    }
+
+
+/*  function        void spool_commit( spool_t * p_spool, long ms )
+
+    brief           Marks the records of the last spool_peek() as sent,
+                    empties the segment if no record is left
+
+    param[in]       spool_t * p_spool
+    param[in]       long ms, time it took to send them
+*/
+void spool_commit( spool_t * p_spool, long ms )
+    {
+    pthread_mutex_lock(&p_spool->lock);
+    ++p_spool->stats.flushes;
+    p_spool->stats.flushed += p_spool->next_text;
+    p_spool->stats.flush_time += ms;
+    p_spool->done = p_spool->next;
+    if( p_spool->done >= p_spool->size )
+        {
+        if( ftruncate(p_spool->fd, 0) == 0 )                                    // first, see the details above
+            {
+            p_spool->size = 0;
+            p_spool->done = 0;
+            p_spool->next = 0;
+            }
+        }
+    write_checkpoint(p_spool, p_spool->done);
+    p_spool->stats.pending = p_spool->size - p_spool->done;
+    pthread_mutex_unlock(&p_spool->lock);
+    }
+
+
+/*  function        void spool_stats( spool_t * p_spool, spoolstat_t * p_stats )
+
+    brief           Returns the statistics of the spool
+
+    param[in]       spool_t * p_spool
+    param[out]      spoolstat_t * p_stats, all 0 if there is no spool
+*/
+void spool_stats( spool_t * p_spool, spoolstat_t * p_stats )
+    {
+    memset(p_stats, 0, sizeof(*p_stats));
+    if( !p_spool->active )
+        return;
+
+    pthread_mutex_lock(&p_spool->lock);
+    *p_stats = p_spool->stats;
+    pthread_mutex_unlock(&p_spool->lock);
+    }
@@ -0,0 +1,139 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        station.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Context of one weather station
+
+    details     station_init() reads the configuration of a station and
+                prepares its link as set there : timeouts, shadow ages,
+                sampling periods, trace or replay, memory image and the
+                history position. The serial port is opened by the caller.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Each station_t is about 70 kB, the shadow of the station's
+                memory is the biggest part.
+
+    todo
+
+*/
+
+
+#include <string.h>
+#include "debug.h"
+#include "station.h"
+#include "ws23kmap.h"
+
+
+static station_t the_default_station;                                           // the station of the single station programs
+
+
+/*  function        station_t * station_default( void )
+
+    brief           Returns the station used by the single station programs
+                    and by the functions of data.c without a station parameter
+
+    return          station_t *
+*/
+station_t * station_default( void )
+    {
+    return &the_default_station;
+    }
+
+
+/*  function        ERRNO station_init( station_t * p_station, char const * name )
+
+    brief           Reads the configuration of a station and prepares its
+                    link, the serial port is not opened
+
+    param[out]      station_t * p_station
+    param[in]       char const * name, .ini file, 0 = default file
+
+    return          ERRNO
+*/
+ERRNO station_init( station_t * p_station, char const * name )
+    {
+    config_t * p_config = &p_station->config;
+    int i;
+    ERRNO error;
+
+    memset(p_station, 0, sizeof(*p_station));
+    history_set_position(&p_station->history, -1, 0);
+    windstat_init(&p_station->wind);
+    clocksync_init(&p_station->clock);
+
+    error = config_read(p_config, name);
+    if( error )
+        return error;
+
+    error = link_init(&p_station->link, p_config->com_port);
+    if( error )
+        return error;
+    ws_set_timeouts(&p_station->link.port, p_config->response_timeout, p_config->byte_timeout);
+    map_set_refresh(&p_station->link, REFRESH_SETTINGS, p_config->cache_settings); // live values win where classes share a byte
+    map_set_refresh(&p_station->link, REFRESH_MINMAX, p_config->cache_minmax);
+    map_set_refresh(&p_station->link, REFRESH_LIVE, p_config->cache_live);
+    shadow_set_age(&p_station->link, map_address(FLD_CLOCK_SECONDS), 2 * map_bytes(FLD_CLOCK_SECONDS), SHADOW_NEVER);
+    shadow_set_age(&p_station->link, map_address(FLD_CLOCK), 2 * map_bytes(FLD_CLOCK), SHADOW_NEVER); // the drift is measured, never cached
+    for( i = 0; i < SAMPLE_NUM_OF_GROUPS; ++i )
+        sched_set_group(&p_station->sched, i, p_config->sample_period[i]);
+
+    error = ws_set_trace(&p_station->link.port, p_config->trace_file, p_config->replay_file, p_config->replay_speed);
+    if( error )
+        return error;
+
+    if( *p_config->image_file )                                                 // decode an image instead of the station
+        {
+        error = link_load_image(&p_station->link, p_config->image_file);
+        if( error )
+            return error;
+        }
+
+    if( *p_config->history_file )
+        history_load_position(&p_station->history, p_config->history_file);     // no file : get all records
+
+    debug("Station %s initialized\n", p_config->com_port);
+    return NOERR;
+    }
+
+
+/*  function        void station_deinit( station_t * p_station )
+
+    brief           Closes the serial port and the trace files of a station
+                    and releases its configuration
+
+    param[in]       station_t * p_station
+*/
+void station_deinit( station_t * p_station )
+    {
+    if( p_station->link.port.handle >= 0 )
+        ws_close(&p_station->link.port);
+    ws_deinit(&p_station->link.port);
+    config_free(&p_station->config);
+    }
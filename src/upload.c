@@ -0,0 +1,924 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        upload.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Transfers to the ftp server done by one upload thread
+
+    details     The queue is a bounded ring of UPLOAD_SLOTS cells after
+                Dmitry Vyukov's MPMC queue. Each cell carries a sequence
+                number : a thread claims a position with a compare and
+                swap of the enqueue or dequeue counter, the sequence of the
+                cell tells it whether the cell is free or filled. There is
+                no lock, a reader is never held up by the upload thread.
+
+                The upload thread sleeps on a semaphore that is posted for
+                each payload put in. A filled cell may follow one that is
+                still being written, so the thread empties the whole queue
+                each time it wakes up.
+
+                A reader that finds the queue full takes the oldest payload
+                out itself and drops it. Dropped log lines are handed to
+                the upload thread in a list, only the upload thread writes
+                to the spools. The reader takes the oldest payload and puts
+                it into the list under the_drop_lock, the upload thread
+                takes the list and its next payload under the same lock,
+                so the lines in the list are older than that payload and
+                are spooled before it.
+
+                If a station collects its log lines ([FTP] flush) the
+                upload thread keeps a batch for each log file. A batch is
+                sent with one append when its first line is [FTP] flush
+                seconds old, when it reaches [FTP] flush_size or when the
+                day ends. The thread waits on the semaphore only until the
+                next batch is due.
+
+                Log lines that can't be sent go to the spool of the station
+                (spool.c). While the spool holds lines, new ones are put
+                behind them, and the spool is sent after the next transfer
+                that works, so the lines reach the server in order.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Only the latencies and the list of dropped log lines are
+                guarded by a mutex, the upload thread holds one while it
+                adds a latency or takes the list and its next payload.
+
+    todo
+
+*/
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "debug.h"
+#include "ftp.h"
+#include "station.h"
+#include "upload.h"
+
+
+#define UPLOAD_STOP_TIMEOUT                     30                              // [s] to send what is left when the program ends
+#define UPLOAD_BATCHES                          ( 2 * STATIONS_MAX )            // data and history log of each station
+
+
+typedef struct _payload
+    {
+    station_t * p_station;
+    atomic_uint * p_resend;                                                     // data string : gets CHG_ALL if it was not sent
+    char * logfile;                                                             // 0 : data string, else the log file to append to
+    struct timespec queued;                                                     // CLOCK_MONOTONIC
+    struct _payload * p_next;                                                   // in the list of dropped log lines
+    char text[];                                                                // the logfile's name follows the text
+    } payload_t;
+
+
+typedef struct _batch
+    {
+    station_t * p_station;                                                      // 0 : not used
+    char logfile[256];
+    char * text;                                                                // the lines collected so far
+    size_t len;
+    struct timespec queued;                                                     // CLOCK_MONOTONIC, of the first line
+    int day;                                                                    // of the year, local time, of the first line
+    } batch_t;
+
+
+typedef struct _cell
+    {
+    atomic_size_t sequence;                                                     // position + 1 : filled, position + UPLOAD_SLOTS : free
+    payload_t * p_payload;
+    } cell_t;
+
+
+static cell_t the_cells[UPLOAD_SLOTS];
+static atomic_size_t the_enqueue_pos;
+static atomic_size_t the_dequeue_pos;
+static sem_t the_ready;                                                         // posted for each payload put in and to stop
+static atomic_int the_stop;
+static struct timespec the_deadline;                                            // CLOCK_MONOTONIC, to give up sending when stopped
+static pthread_t the_thread;
+static int the_running = 0;
+
+static atomic_long the_queued;
+static atomic_long the_dropped;
+static atomic_int the_depth_max;
+static pthread_mutex_t the_lock = PTHREAD_MUTEX_INITIALIZER;                    // guards the_stats
+static uploadstat_t the_stats;                                                  // sent, failed, batches and latencies
+static batch_t the_batches[UPLOAD_BATCHES];                                     // used by the upload thread only
+static pthread_mutex_t the_drop_lock = PTHREAD_MUTEX_INITIALIZER;               // guards the list and the taking of the oldest payload
+static payload_t * the_dropped_lines;                                           // log lines dropped by the readers, oldest first
+static payload_t ** the_dropped_end = &the_dropped_lines;
+
+
+/*  function        static int queue_put( payload_t * p_payload )
+
+    brief           Fills the next free cell
+
+    param[in]       payload_t * p_payload
+
+    return          int, 0 if the queue is full
+*/
+static int queue_put( payload_t * p_payload )
+    {
+    size_t pos = atomic_load_explicit(&the_enqueue_pos, memory_order_relaxed);
+    cell_t * p_cell;
+    intptr_t diff;
+
+    for( ;; )
+        {
+        p_cell = &the_cells[pos & ( UPLOAD_SLOTS - 1 )];
+        diff = (intptr_t)atomic_load_explicit(&p_cell->sequence, memory_order_acquire) - (intptr_t)pos;
+        if( diff == 0 )                                                         // free, try to claim it
+            {
+            if( atomic_compare_exchange_weak_explicit(&the_enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed) )
+                break;
+            }
+        else if( diff < 0 )                                                     // still filled one round ago
+            return 0;
+        else                                                                    // claimed by another thread
+            pos = atomic_load_explicit(&the_enqueue_pos, memory_order_relaxed);
+        }
+
+    p_cell->p_payload = p_payload;
+    atomic_store_explicit(&p_cell->sequence, pos + 1, memory_order_release);
+    return 1;
+    }
+
+
+/*  function        static payload_t * queue_get( void )
+
+    brief           Takes the payload out of the oldest filled cell
+
+    return          payload_t *, 0 if the queue is empty or the oldest cell
+                    is still being filled
+*/
+static payload_t * queue_get( void )
+    {
+    size_t pos = atomic_load_explicit(&the_dequeue_pos, memory_order_relaxed);
+    payload_t * p_payload;
+    cell_t * p_cell;
+    intptr_t diff;
+
+    for( ;; )
+        {
+        p_cell = &the_cells[pos & ( UPLOAD_SLOTS - 1 )];
+        diff = (intptr_t)atomic_load_explicit(&p_cell->sequence, memory_order_acquire) - (intptr_t)( pos + 1 );
+        if( diff == 0 )                                                         // filled, try to claim it
+            {
+            if( atomic_compare_exchange_weak_explicit(&the_dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed) )
+                break;
+            }
+        else if( diff < 0 )                                                     // empty
+            return 0;
+        else                                                                    // claimed by another thread
+            pos = atomic_load_explicit(&the_dequeue_pos, memory_order_relaxed);
+        }
+
+    p_payload = p_cell->p_payload;
+    atomic_store_explicit(&p_cell->sequence, pos + UPLOAD_SLOTS, memory_order_release);
+    return p_payload;
+    }
+
+
+/*  function        static int queue_depth( void )
+
+    brief           Returns the number of payloads in the queue, only a
+                    snapshot while other threads use it
+
+    return          int
+*/
+static int queue_depth( void )
+    {
+    size_t out = atomic_load_explicit(&the_dequeue_pos, memory_order_relaxed);
+    size_t in = atomic_load_explicit(&the_enqueue_pos, memory_order_relaxed);
+
+    return ( in > out ) ? (int)( in - out ) : 0;
+    }
+
+
+/*  function        static void drop( payload_t * p_payload )
+
+    brief           Drops a payload that is not sent, a data string is sent
+                    again with the next upload and freed, log lines are put
+                    into the list for the upload thread, see keep_lines()
+
+    param[in]       payload_t * p_payload
+
+    note            the_drop_lock has to be held for log lines
+*/
+static void drop( payload_t * p_payload )
+    {
+    if( p_payload->logfile )
+        {
+        p_payload->p_next = 0;
+        *the_dropped_end = p_payload;
+        the_dropped_end = &p_payload->p_next;
+        return;
+        }
+
+    if( p_payload->p_resend )
+        atomic_fetch_or(p_payload->p_resend, CHG_ALL);
+    atomic_fetch_add(&the_dropped, 1);
+    free(p_payload);
+    }
+
+
+/*  function        static payload_t * take( payload_t ** pp_dropped )
+
+    brief           Takes the list of dropped log lines and the oldest payload
+                    out of the queue, for the upload thread
+
+    param[out]      payload_t ** pp_dropped, the list, its lines are older than
+                    the payload returned
+
+    return          payload_t *, 0 if the queue is empty
+*/
+static payload_t * take( payload_t ** pp_dropped )
+    {
+    payload_t * p_payload;
+
+    pthread_mutex_lock(&the_drop_lock);
+    *pp_dropped = the_dropped_lines;
+    the_dropped_lines = 0;
+    the_dropped_end = &the_dropped_lines;
+    p_payload = queue_get();
+    pthread_mutex_unlock(&the_drop_lock);
+
+    return p_payload;
+    }
+
+
+/*  function        static void put( payload_t * p_payload )
+
+    brief           Puts a payload into the queue, drops the oldest ones
+                    while the queue is full and wakes up the upload thread
+
+    param[in]       payload_t * p_payload
+*/
+static void put( payload_t * p_payload )
+    {
+    payload_t * p_oldest;
+    int depth_max;
+    int depth;
+
+    clock_gettime(CLOCK_MONOTONIC, &p_payload->queued);
+    while( !queue_put(p_payload) )                                              // the upload is stuck, keep the latest payloads
+        {
+        pthread_mutex_lock(&the_drop_lock);
+        p_oldest = queue_get();
+        if( p_oldest )
+            drop(p_oldest);
+        pthread_mutex_unlock(&the_drop_lock);
+        }
+    atomic_fetch_add(&the_queued, 1);
+
+    depth = queue_depth();
+    depth_max = atomic_load(&the_depth_max);
+    while( depth > depth_max && !atomic_compare_exchange_weak(&the_depth_max, &depth_max, depth) )
+        ;
+
+    sem_post(&the_ready);
+    }
+
+
+/*  function        static payload_t * payload_new( station_t * p_station, char const * logfile, char const * text )
+
+    brief           Copies a text and the name of its file into a new payload
+
+    param[in]       station_t * p_station
+    param[in]       char const * logfile, 0 : data string
+    param[in]       char const * text
+
+    return          payload_t *, 0 if out of memory
+*/
+static payload_t * payload_new( station_t * p_station, char const * logfile, char const * text )
+    {
+    size_t text_len = strlen(text) + 1;
+    size_t name_len = logfile ? strlen(logfile) + 1 : 0;
+    payload_t * p_payload;
+
+    p_payload = malloc(sizeof(payload_t) + text_len + name_len);
+    if( !p_payload )
+        return 0;
+
+    memset(p_payload, 0, sizeof(payload_t));
+    p_payload->p_station = p_station;
+    memcpy(p_payload->text, text, text_len);
+    if( logfile )
+        {
+        p_payload->logfile = p_payload->text + text_len;
+        memcpy(p_payload->logfile, logfile, name_len);
+        }
+
+    return p_payload;
+    }
+
+
+/*  function        static void flush_spool( station_t * p_station )
+
+    brief           Sends the records of the station's spool, one append for
+                    the lines of each log file, until the spool is empty or
+                    an append fails
+
+    param[in]       station_t * p_station
+*/
+static void flush_spool( station_t * p_station )
+    {
+    spool_t * p_spool = &p_station->spool;
+    char logfile[256];
+    struct timespec start;
+    struct timespec end;
+    char * text;
+    ERRNO error;
+
+    while( spool_peek(p_spool, logfile, sizeof(logfile), &text) == NOERR )
+        {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        error = AppendFile(p_station, logfile, text);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        free(text);
+        if( error )
+            break;
+        spool_commit(p_spool, ( end.tv_sec - start.tv_sec ) * 1000 + ( end.tv_nsec - start.tv_nsec ) / 1000000);
+        }
+    }
+
+
+/*  function        static ERRNO append( station_t * p_station, char const * logfile, char const * text )
+
+    brief           Appends log lines to their file on the server. If the
+                    station has a spool the lines go there when the server
+                    can't be reached, and behind the lines already waiting
+                    in it.
+
+    param[in]       station_t * p_station
+    param[in]       char const * logfile, remote path
+    param[in]       char const * text
+
+    return          ERRNO, of the transfer or of the spool
+*/
+static ERRNO append( station_t * p_station, char const * logfile, char const * text )
+    {
+    ERRNO error;
+
+    if( spool_pending(&p_station->spool) > 0 )                                  // keep the order of the lines
+        {
+        error = spool_add(&p_station->spool, logfile, text);
+        if( error )
+            printf("Error spooling log lines %d\n", error);
+        flush_spool(p_station);
+        return error;
+        }
+
+    error = AppendFile(p_station, (char *)logfile, (char *)text);
+    if( error )
+        {
+        printf("Error logging to server %d\n", error);
+        if( spool_active(&p_station->spool) && spool_add(&p_station->spool, logfile, text) )
+            printf("Spool full, log lines lost\n");
+        }
+
+    return error;
+    }
+
+
+/*  function        static void add_latency( struct timespec const * p_queued, ERRNO error )
+
+    brief           Counts a payload or a batch as sent or failed and adds
+                    the time since it was put into the queue
+
+    param[in]       struct timespec const * p_queued, CLOCK_MONOTONIC
+    param[in]       ERRNO error, of the transfer
+*/
+static void add_latency( struct timespec const * p_queued, ERRNO error )
+    {
+    struct timespec done;
+    long ms;
+
+    clock_gettime(CLOCK_MONOTONIC, &done);
+    ms = ( done.tv_sec - p_queued->tv_sec ) * 1000 + ( done.tv_nsec - p_queued->tv_nsec ) / 1000000;
+
+    pthread_mutex_lock(&the_lock);
+    if( error )
+        ++the_stats.failed;
+    else
+        ++the_stats.sent;
+    if( the_stats.sent + the_stats.failed == 1 || ms < the_stats.latency_min )
+        the_stats.latency_min = ms;
+    if( ms > the_stats.latency_max )
+        the_stats.latency_max = ms;
+    the_stats.latency_sum += ms;
+    the_stats.latency_last = ms;
+    pthread_mutex_unlock(&the_lock);
+    }
+
+
+/*  function        static int too_late( void )
+
+    brief           Tells whether the program ends and the time to send what
+                    is left is over
+
+    return          int, 1 if the payloads left are to be dropped
+*/
+static int too_late( void )
+    {
+    struct timespec now;
+
+    if( !atomic_load(&the_stop) )
+        return 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > the_deadline.tv_sec
+        || ( now.tv_sec == the_deadline.tv_sec && now.tv_nsec >= the_deadline.tv_nsec );
+    }
+
+
+/*  function        static void spool_batch( batch_t * p_batch )
+
+    brief           Puts the lines of a batch into the spool of its station
+                    without sending them and empties the batch
+
+    param[in]       batch_t * p_batch
+*/
+static void spool_batch( batch_t * p_batch )
+    {
+    if( spool_add(&p_batch->p_station->spool, p_batch->logfile, p_batch->text) )
+        atomic_fetch_add(&the_dropped, 1);
+    free(p_batch->text);
+    memset(p_batch, 0, sizeof(*p_batch));
+    }
+
+
+/*  function        static void flush_batch( batch_t * p_batch )
+
+    brief           Sends the lines of a batch with one append and empties it
+
+    param[in]       batch_t * p_batch
+*/
+static void flush_batch( batch_t * p_batch )
+    {
+    ERRNO error;
+
+    if( too_late() )                                                            // keep them for the next start
+        {
+        spool_batch(p_batch);
+        return;
+        }
+
+    debug("Flushing %ld bytes to %s\n", (long)p_batch->len, p_batch->logfile);
+    error = append(p_batch->p_station, p_batch->logfile, p_batch->text);
+    add_latency(&p_batch->queued, error);
+
+    pthread_mutex_lock(&the_lock);
+    ++the_stats.flushes;
+    pthread_mutex_unlock(&the_lock);
+
+    free(p_batch->text);
+    memset(p_batch, 0, sizeof(*p_batch));
+    }
+
+
+/*  function        static void keep_lines( payload_t * p_payload )
+
+    brief           Puts dropped log lines into the spool of their station
+                    behind the older lines of the same file that wait in a
+                    batch, and frees the payload. Without a spool the lines
+                    are lost.
+
+    param[in]       payload_t * p_payload
+*/
+static void keep_lines( payload_t * p_payload )
+    {
+    int i;
+
+    for( i = 0; spool_active(&p_payload->p_station->spool) && i < UPLOAD_BATCHES; ++i )
+        {
+        if( the_batches[i].p_station == p_payload->p_station && strcmp(the_batches[i].logfile, p_payload->logfile) == 0 )
+            spool_batch(&the_batches[i]);
+        }
+    if( spool_add(&p_payload->p_station->spool, p_payload->logfile, p_payload->text) )
+        atomic_fetch_add(&the_dropped, 1);
+    free(p_payload);
+    }
+
+
+/*  function        static int local_day( void )
+
+    brief           Returns the day of the year in local time, the log files
+                    are named by it
+
+    return          int
+*/
+static int local_day( void )
+    {
+    struct tm now;
+    time_t t = time(0);
+
+    return localtime_r(&t, &now)->tm_yday;
+    }
+
+
+/*  function        static void add_to_batch( payload_t * p_payload )
+
+    brief           Appends the lines of a payload to the batch of their log
+                    file, sends the batch if it reaches the flush size of the
+                    station
+
+    param[in]       payload_t * p_payload
+*/
+static void add_to_batch( payload_t * p_payload )
+    {
+    config_t const * p_config = &p_payload->p_station->config;
+    size_t len = strlen(p_payload->text);
+    batch_t * p_batch = 0;
+    char * p_more;
+    int i;
+
+    for( i = 0; i < UPLOAD_BATCHES; ++i )
+        {
+        if( the_batches[i].p_station == p_payload->p_station && strcmp(the_batches[i].logfile, p_payload->logfile) == 0 )
+            {
+            p_batch = &the_batches[i];
+            break;
+            }
+        if( !p_batch && !the_batches[i].p_station )
+            p_batch = &the_batches[i];
+        }
+    if( !p_batch )                                                              // all in use, make room
+        {
+        p_batch = &the_batches[0];
+        for( i = 1; i < UPLOAD_BATCHES; ++i )
+            {
+            if( the_batches[i].queued.tv_sec < p_batch->queued.tv_sec )
+                p_batch = &the_batches[i];
+            }
+        flush_batch(p_batch);
+        }
+
+    p_more = realloc(p_batch->text, p_batch->len + len + 1);
+    if( !p_more )                                                               // send the lines on their own
+        {
+        add_latency(&p_payload->queued, append(p_payload->p_station, p_payload->logfile, p_payload->text));
+        return;
+        }
+    if( !p_batch->p_station )
+        {
+        p_batch->p_station = p_payload->p_station;
+        snprintf(p_batch->logfile, sizeof(p_batch->logfile), "%s", p_payload->logfile);
+        p_batch->queued = p_payload->queued;
+        p_batch->day = local_day();
+        }
+    p_batch->text = p_more;
+    memcpy(p_batch->text + p_batch->len, p_payload->text, len + 1);
+    p_batch->len += len;
+
+    pthread_mutex_lock(&the_lock);
+    ++the_stats.batched;
+    pthread_mutex_unlock(&the_lock);
+
+    if( (long)p_batch->len >= p_config->ftp_flush_size )
+        flush_batch(p_batch);
+    }
+
+
+/*  function        static long flush_batches( int all )
+
+    brief           Sends the batches that are old enough or were started on
+                    an earlier day
+
+    param[in]       int all, 1 : sends all batches
+
+    return          long, [ms] until the next batch is due, -1 if there is
+                    no batch
+*/
+static long flush_batches( int all )
+    {
+    struct timespec now;
+    struct tm midnight;
+    time_t t = time(0);
+    long next = -1;
+    long due;
+    int day = local_day();
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for( i = 0; i < UPLOAD_BATCHES; ++i )
+        {
+        if( !the_batches[i].p_station )
+            continue;
+        due = ( the_batches[i].queued.tv_sec + the_batches[i].p_station->config.ftp_flush - now.tv_sec ) * 1000
+            + ( the_batches[i].queued.tv_nsec - now.tv_nsec ) / 1000000;
+        if( all || due <= 0 || the_batches[i].day != day )
+            flush_batch(&the_batches[i]);
+        else if( next < 0 || due < next )
+            next = due;
+        }
+
+    if( next >= 0 )                                                             // the next day starts a new log file
+        {
+        localtime_r(&t, &midnight);
+        midnight.tm_sec = 0;
+        midnight.tm_min = 0;
+        midnight.tm_hour = 0;
+        ++midnight.tm_mday;
+        midnight.tm_isdst = -1;
+        due = ( mktime(&midnight) - t ) * 1000;
+        if( due < next )
+            next = due;
+        }
+
+    return next;
+    }
+
+
+/*  function        static void send_payload( payload_t * p_payload )
+
+    brief           Transfers a payload, adds its latency and frees it. The
+                    lines for a log file are put into a batch if the station
+                    collects them.
+
+    param[in]       payload_t * p_payload
+*/
+static void send_payload( payload_t * p_payload )
+    {
+    ERRNO error;
+
+    if( p_payload->logfile && p_payload->p_station->config.ftp_flush > 0 )
+        {
+        add_to_batch(p_payload);
+        free(p_payload);
+        return;
+        }
+
+    if( p_payload->logfile )
+        error = append(p_payload->p_station, p_payload->logfile, p_payload->text);
+    else
+        {
+        error = PushFile(p_payload->p_station, p_payload->text);
+        if( error )
+            {
+            printf("FTP error : %d, programm continuing!\n", error);
+            if( p_payload->p_resend )
+                atomic_fetch_or(p_payload->p_resend, CHG_ALL);                  // send it again next time
+            }
+        else if( spool_pending(&p_payload->p_station->spool) > 0 )              // the server answers again
+            flush_spool(p_payload->p_station);
+        }
+    add_latency(&p_payload->queued, error);
+
+    free(p_payload);
+    }
+
+
+/*  function        static void wait_ready( long ms )
+
+    brief           Waits for the next payload or until a batch is due
+
+    param[in]       long ms, until the next batch is due, -1 : no batch
+*/
+static void wait_ready( long ms )
+    {
+    struct timespec until;
+
+    if( ms < 0 )
+        {
+        while( sem_wait(&the_ready) && errno == EINTR )
+            ;
+        return;
+        }
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += ms / 1000;
+    until.tv_nsec += ( ms % 1000 ) * 1000000;
+    if( until.tv_nsec >= 1000000000 )
+        {
+        ++until.tv_sec;
+        until.tv_nsec -= 1000000000;
+        }
+    while( sem_timedwait(&the_ready, &until) && errno == EINTR )
+        ;
+    }
+
+
+/*  function        static void * upload_thread( void * p_arg )
+
+    brief           Thread that transfers the payloads in the order they were
+                    put in, until upload_deinit()
+
+    param[in]       void * p_arg, not used
+
+    return          void *, 0
+*/
+static void * upload_thread( void * p_arg )
+    {
+    payload_t * p_payload;
+    payload_t * p_dropped;
+    payload_t * p_next;
+    long next = -1;
+    int stop;
+
+    (void)p_arg;
+    do
+        {
+        wait_ready(next);
+        stop = atomic_load(&the_stop);                                          // the readers are done, the queue holds all that is left
+        for( ;; )
+            {
+            p_payload = take(&p_dropped);
+            for( ; p_dropped; p_dropped = p_next )                              // older than p_payload
+                {
+                p_next = p_dropped->p_next;
+                keep_lines(p_dropped);
+                }
+            if( !p_payload )
+                break;
+            if( !too_late() )
+                send_payload(p_payload);
+            else if( p_payload->logfile )
+                keep_lines(p_payload);
+            else
+                drop(p_payload);
+            }
+        next = flush_batches(stop);
+        }
+    while( !stop );
+
+    return 0;
+    }
+
+
+/*  function        ERRNO upload_init( void )
+
+    brief           Prepares the empty queue and starts the upload thread,
+                    after FtpInit()
+
+    return          ERRNO
+*/
+ERRNO upload_init( void )
+    {
+    sigset_t signals;
+    sigset_t old;
+    size_t i;
+    int error;
+
+    for( i = 0; i < UPLOAD_SLOTS; ++i )
+        atomic_init(&the_cells[i].sequence, i);
+    atomic_init(&the_enqueue_pos, 0);
+    atomic_init(&the_dequeue_pos, 0);
+    atomic_init(&the_stop, 0);
+    atomic_init(&the_queued, 0);
+    atomic_init(&the_dropped, 0);
+    atomic_init(&the_depth_max, 0);
+    memset(&the_stats, 0, sizeof(the_stats));
+    memset(the_batches, 0, sizeof(the_batches));
+    if( sem_init(&the_ready, 0, 0) )
+        return ERR_THREAD;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &old);                                 // the signals stop the readers, not this thread
+    error = pthread_create(&the_thread, 0, upload_thread, 0);
+    pthread_sigmask(SIG_SETMASK, &old, 0);
+    if( error )
+        {
+        sem_destroy(&the_ready);
+        return ERR_THREAD;
+        }
+
+    the_running = 1;
+    debug("Upload thread started\n");
+    return NOERR;
+    }
+
+
+/*  function        void upload_deinit( void )
+
+    brief           Sends the payloads left for up to UPLOAD_STOP_TIMEOUT
+                    seconds and stops the upload thread, no reader may put
+                    in any more payloads
+
+    note            A transfer that already runs is not broken off.
+*/
+void upload_deinit( void )
+    {
+    if( !the_running )
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &the_deadline);
+    the_deadline.tv_sec += UPLOAD_STOP_TIMEOUT;
+    atomic_store(&the_stop, 1);
+    sem_post(&the_ready);
+    pthread_join(the_thread, 0);
+    sem_destroy(&the_ready);
+    the_running = 0;
+    debug("Upload thread stopped\n");
+    }
+
+
+/*  function        ERRNO upload_push( station_t * p_station, char const * data, atomic_uint * p_resend )
+
+    brief           Puts a copy of the data string of a station into the
+                    queue
+
+    param[in]       station_t * p_station
+    param[in]       char const * data, the filled in template
+    param[in,out]   atomic_uint * p_resend, gets CHG_ALL if the string is
+                    dropped or could not be sent
+
+    return          ERRNO
+*/
+ERRNO upload_push( station_t * p_station, char const * data, atomic_uint * p_resend )
+    {
+    payload_t * p_payload;
+
+    if( !data )
+        return ERR_NO_LOG_DATA;
+
+    p_payload = payload_new(p_station, 0, data);
+    if( !p_payload )
+        return ERR_OUT_OF_MEMORY;
+    p_payload->p_resend = p_resend;
+
+    put(p_payload);
+    return NOERR;
+    }
+
+
+/*  function        ERRNO upload_append( station_t * p_station, char const * logfile, char const * text )
+
+    brief           Puts a copy of lines to be appended to a log file on the
+                    server into the queue
+
+    param[in]       station_t * p_station
+    param[in]       char const * logfile, remote path
+    param[in]       char const * text
+
+    return          ERRNO
+*/
+ERRNO upload_append( station_t * p_station, char const * logfile, char const * text )
+    {
+    payload_t * p_payload;
+
+    if( !text )
+        return ERR_NO_LOG_DATA;
+
+    p_payload = payload_new(p_station, logfile, text);
+    if( !p_payload )
+        return ERR_OUT_OF_MEMORY;
+
+    put(p_payload);
+    return NOERR;
+    }
+
+
+/*  function        void upload_stats( uploadstat_t * p_stats )
+
+    brief           Returns the statistics of the queue and the latencies of
+                    the payloads sent
+
+    param[out]      uploadstat_t * p_stats
+*/
+void upload_stats( uploadstat_t * p_stats )
+    {
+    pthread_mutex_lock(&the_lock);
+    *p_stats = the_stats;
+    pthread_mutex_unlock(&the_lock);
+
+    p_stats->queued = atomic_load(&the_queued);
+    p_stats->dropped = atomic_load(&the_dropped);
+    p_stats->depth = queue_depth();
+    p_stats->depth_max = atomic_load(&the_depth_max);
+    }
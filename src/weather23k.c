@@ -22,7 +22,7 @@
 
     file        weather23k.c
 
-    date        22.10.2017
+    date        17.10.2026
 
     author      Uwe Jantzen (jantzen@klabautermann-software.de)
 
@@ -35,7 +35,16 @@
                     log data to log file
                     push data to ftp server
 
-    details
+    details     With one configuration file the jobs run in the main thread.
+                Each further configuration file adds a station : then every
+                station is read by its own thread with its own jobs and the
+                readings go through the pipeline to one output thread that
+                uploads and logs them. The min/max reset and the history of
+                a station are done by its reader, they need the port.
+
+                The transfers to the ftp server are made by the upload
+                thread (upload.c), the jobs only put the rendered strings
+                into its queue and never wait for the server.
 
     project     weather23k
     target      Linux
@@ -48,40 +57,861 @@
 */
 
 
+#define _GNU_SOURCE                                                             // pthread_timedjoin_np()
+
 #include <unistd.h>
+#include <signal.h>
 #include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "debug.h"
 #include "data.h"
 #include "getargs.h"
+#include "jobs.h"
 #include "ws23k.h"
 #include "ftp.h"
 #include "log.h"
+#include "pipeline.h"
 #include "sercom.h"
 #include "ws23kcom.h"
+#include "ws23khist.h"
+#include "ws23kmap.h"
+#include "ws23ksched.h"
+#include "station.h"
+#include "upload.h"
 
 
-/*  function        int main( int argc, char *argv[] )
-
+typedef struct _reader
+    {
+    station_t * p_station;
+    pipeline_t * p_pipeline;                                                    // 0 = single station, readings are put out at once
+    jobs_t jobs;                                                                // run by the reader's thread
+    pthread_t thread;
+    long cycles;                                                                // number of measured readings
+    long cycle_min;                                                             // [ms]
+    long cycle_max;                                                             // [ms]
+    long long cycle_sum;                                                        // [ms]
+    int reset_day;                                                              // day of the year of the last min/max reset, -2 = not started
+    time_t upload_due;                                                          // next upload, used by the output thread only
+    time_t rollup_due;                                                          // next log entry, used by the output thread only
+    unsigned int upload_changes;                                                // CHG_xxx since the last upload
+    atomic_uint resend;                                                         // CHG_ALL if the upload thread did not send the data string
+    history_record_t history[HISTORY_RECORDS];                                  // records fetched by history_sync()
+    } reader_t;
+
+
+#define STOP_TIMEOUT                            10                              // [s] for a reader to end its current job
+
+
+static reader_t * the_readers = 0;                                              // one for each station
+static int the_reader_count = 0;
+
+
+/*  function        static long add_cycle( reader_t * p_reader, struct timespec const * start )
+
+    brief           Adds the duration of a reading cycle to the statistics
+
+    param[in]       reader_t * p_reader
+    param[in]       struct timespec const * start, time the cycle started
+
+    return          long, duration of the cycle [ms]
+*/
+static long add_cycle( reader_t * p_reader, struct timespec const * start )
+    {
+    struct timespec now;
+    long duration;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    duration = (now.tv_sec - start->tv_sec) * 1000L + (now.tv_nsec - start->tv_nsec) / 1000000L;
+
+    if( p_reader->cycles == 0 || duration < p_reader->cycle_min )
+        p_reader->cycle_min = duration;
+    if( duration > p_reader->cycle_max )
+        p_reader->cycle_max = duration;
+    p_reader->cycle_sum += duration;
+    ++p_reader->cycles;
+
+    return duration;
+    }
+
+
+/*  function        static int minmax_reset_due( reader_t * p_reader, time_t now )
+
+    brief           Checks if the daily reset of all minimum and maximum values
+                    is due. If the program is started after the reset time the
+                    first reset is done the next day.
+
+    param[in]       reader_t * p_reader
+    param[in]       time_t now
+
+    return          int, 1 if minmax_reset_all() has to be called
+*/
+static int minmax_reset_due( reader_t * p_reader, time_t now )
+    {
+    int reset_time = p_reader->p_station->config.reset_minmax;
+    struct tm tm_now;
+    int due;
+
+    if( reset_time < 0 )
+        return 0;
+
+    localtime_r(&now, &tm_now);
+    due = ( tm_now.tm_hour * 60 + tm_now.tm_min >= reset_time );
+    if( p_reader->reset_day == -2 )
+        {
+        p_reader->reset_day = due ? tm_now.tm_yday : -1;
+        return 0;
+        }
+    if( !due || tm_now.tm_yday == p_reader->reset_day )
+        return 0;
+
+    p_reader->reset_day = tm_now.tm_yday;
+    return 1;
+    }
+
+
+/*  function        static time_t next_multiple( time_t now, int period )
+
+    brief           Returns the first multiple of a period after now, like the
+                    start times of the jobs
+
+    param[in]       time_t now
+    param[in]       int period, [s] > 0
+
+    return          time_t
+*/
+static time_t next_multiple( time_t now, int period )
+    {
+    return ( now / period + 1 ) * period;
+    }
+
+
+/*  function        static reader_t * reader_of( station_t const * p_station )
+
+    brief           Returns the reader of a station
+
+    param[in]       station_t const * p_station
+
+    return          reader_t *, 0 if the station is unknown
+*/
+static reader_t * reader_of( station_t const * p_station )
+    {
+    int i;
+
+    for( i = 0; i < the_reader_count; ++i )
+        {
+        if( the_readers[i].p_station == p_station )
+            return &the_readers[i];
+        }
+
+    return 0;
+    }
+
+
+/*  function        static void print_jobs( jobs_t const * p_jobs )
+
+    brief           Prints how late the jobs started
+
+    param[in]       jobs_t const * p_jobs
+*/
+static void print_jobs( jobs_t const * p_jobs )
+    {
+    jobstat_t stats;
+    int i;
+
+    for( i = 0; i < jobs_count(p_jobs); ++i )
+        {
+        job_stats(p_jobs, i, &stats);
+        if( stats.runs == 0 )
+            continue;
+        printf("Verspätung %-8s :     %4ld ms (min %ld, max %ld ms, %ld Starts, %ld ausgelassen)\n", job_name(p_jobs, i),
+            (long)(stats.late_sum / stats.runs), stats.late_min, stats.late_max, stats.runs, stats.skipped);
+        }
+    if( jobs_clock_jumps(p_jobs) )
+        printf("Uhr gestellt :            %3ld\n", jobs_clock_jumps(p_jobs));
+    }
+
+
+/*  function        static void print_reading( reading_t const * p_reading )
+
+    brief           Prints a reading in verbose mode
+
+    param[in]       reading_t const * p_reading
+*/
+static void print_reading( reading_t const * p_reading )
+    {
+    weatherdata_t const * p_weatherdata = &p_reading->data;
+
+    if( !verbose() )
+        return;
+
+    if( the_reader_count > 1 )
+        printf("Station : %s\n", p_reading->p_station->config.com_port);
+    printf("Zeit : %s\n", p_weatherdata->act_time);
+    printf("Temperatur innen :        %6.2f °C\n", p_weatherdata->temperature_in); // temperature [٠C]
+    printf("Temperatur aussen :       %6.2f °C\n", p_weatherdata->temperature); // temperature [٠C]
+    printf("Luftdruck (abs.) :       %6.1f hPa\n", p_weatherdata->pressure);    // absolute pressure [hPa]
+    printf("Luftdruck (rel.) :       %6.1f hPa\n", GetRelPressure(p_weatherdata)); // relative pressure [hPa]
+    printf("Luftfeuchtigkeit innen :  %3d %%\n", p_weatherdata->humidity_in);   // relative humudity [%]
+    printf("Luftfeuchtigkeit aussen : %3d %%\n", p_weatherdata->humidity);      // relative humudity [%]
+    if( p_weatherdata->sensor_connected == 0 )
+        {
+        printf("Windrichtung :            %5.1f °\n", p_weatherdata->direction); // wind direction [٠]
+        printf("Windrichtung :            %3s\n", p_weatherdata->dir);          // wind direction
+        printf("Windgeschwindigkeit :      %4.1f m/sec\n", p_weatherdata->speed[0]); // wind speed [m/sec]
+        printf("                          %5.1f km/h\n", p_weatherdata->speed[1]); // wind speed [km/h]
+        printf("                          %5.1f kn\n", p_weatherdata->speed[2]); // wind speed [kn]
+        printf("                           %2d bft\n", (int)p_weatherdata->speed[3]); // wind speed [bft]
+        if( p_weatherdata->wind.samples )
+            {
+            struct tm tm;
+
+            localtime_r(&p_weatherdata->wind.gust_time, &tm);
+            printf("Wind 10 min :              %4.1f m/sec, Böe %4.1f m/sec um %02d:%02d:%02d (%d Werte)\n",
+                p_weatherdata->wind.mean, p_weatherdata->wind.gust, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                p_weatherdata->wind.samples);
+            printf("Windrichtung 10 min :     %5.1f ° (Streuung %4.1f °)\n", p_weatherdata->wind.direction,
+                p_weatherdata->wind.deviation);
+            }
+        }
+    else
+        {
+        printf("Windsensor nicht angeschlossen!\n");
+        }
+    printf("Taupunkt :                %6.2f °C\n", p_weatherdata->dewpoint);    // dewpoint [٠]
+    printf("Gefühlte Temp. :          %6.2f °C\n", p_weatherdata->windchill);   // windchill [٠]
+    printf("Regen / Stunde :          %5.1f mm\n", p_weatherdata->rain_per_hour); // rain_per_hour [l]
+    printf("Regen / 24 Stunden :      %5.1f mm\n", p_weatherdata->rain_per_day); // rain_per_day [l]
+    if( p_weatherdata->clock.samples > 0 )
+        {
+        printf("Stationsuhr :            %+6.1f s (%d Messungen, %d mal gestellt)\n", p_weatherdata->clock.offset,
+            p_weatherdata->clock.samples, p_weatherdata->clock.jumps);
+        if( p_weatherdata->clock.rated )
+            printf("Gangabweichung :         %+6.2f s/Tag\n", p_weatherdata->clock.rate);
+        }
+    printf("Telegramme :              %3d (%d Wiederholungen, %d Resets)\n", p_reading->stats.transactions,
+        p_reading->stats.retries, p_reading->stats.resyncs);
+    printf("Bytes gesendet/empfangen : %3lu / %lu\n", p_reading->stats.bytes_tx, p_reading->stats.bytes_rx);
+    printf("Zwischenspeicher :        %3d Treffer, %d gelesen, %d Telegramme unverändert\n", p_reading->stats.cache_hits,
+        p_reading->stats.cache_misses, p_reading->stats.windows_unchanged);
+    printf("Geänderte Werte :        0x%04x\n", p_reading->data.changed);
+    if( p_reading->data.changed & CHG_ALARM )
+        printf("Alarm :                   gesetzt 0x%07lx, aktiv 0x%013lx\n", p_reading->data.alarm_set,
+            p_reading->data.alarm_active);
+    if( p_reading->ticks > 0 )
+        printf("Abtastungen :             %3d (%d Felder)\n", p_reading->ticks, p_reading->fields);
+    printf("Lesezeit :               %6ld ms (min %ld, mittel %ld, max %ld ms)\n", p_reading->duration,
+        p_reading->cycle_min, p_reading->cycle_mean, p_reading->cycle_max);
+    }
+
+
+#ifndef NIX
+/*  function        static void print_upload( void )
+
+    brief           Prints the statistics of the upload queue in verbose mode
+*/
+static void print_upload( void )
+    {
+    uploadstat_t stats;
+    long done;
+
+    if( !verbose() )
+        return;
+
+    upload_stats(&stats);
+    printf("Warteschlange :           %3d (max %d), %ld eingereiht, %ld verworfen\n",
+        stats.depth, stats.depth_max, stats.queued, stats.dropped);
+    if( stats.batched > 0 )
+        printf("Log gesammelt :        %6ld Zeilen, %ld Übertragungen\n", stats.batched, stats.flushes);
+    done = stats.sent + stats.failed;
+    if( done > 0 )
+        printf("Eingereiht bis gesendet : %6ld ms (min %ld, mittel %ld, max %ld ms)\n", stats.latency_last,
+            stats.latency_min, (long)(stats.latency_sum / done), stats.latency_max);
+    }
+
+
+/*  function        static void print_ftp( station_t * p_station )
+
+    brief           Prints the transfer statistics of each server of a station,
+                    of its spool and of the upload queue in verbose mode
+
+    param[in]       station_t * p_station
+*/
+static void print_ftp( station_t * p_station )
+    {
+    spoolstat_t spool;
+    ftpstat_t stats;
+    char name[16];
+    int i;
+
+    if( !verbose() )
+        return;
+
+    for( i = 0; i < FTP_DESTINATIONS; ++i )
+        {
+        if( strlen(p_station->config.ftp[i].server) == 0 )
+            continue;
+        FtpStats(p_station, i, &stats);
+        if( i == 0 )
+            strcpy(name, "FTP :");
+        else
+            sprintf(name, "FTP%d :", i + 1);                                    // the section of the mirror
+        printf("%-26s%3ld Übertragungen (%ld Fehler), %ld Verbindungen, %ld wiederverwendet\n",
+            name, stats.transfers, stats.failures, stats.connects, stats.reused);
+        if( stats.transfers > 0 )
+            printf("Übertragungszeit :       %6ld ms (min %ld, mittel %ld, max %ld ms)\n", stats.time_last,
+                stats.time_min, (long)(stats.time_sum / stats.transfers), stats.time_max);
+        }
+    if( spool_active(&p_station->spool) )
+        {
+        spool_stats(&p_station->spool, &spool);
+        printf("Spool :                %6ld Bytes offen, %ld Zeilen gespoolt, %ld verworfen\n",
+            spool.pending, spool.spooled, spool.dropped);
+        if( spool.flushes > 0 )
+            printf("Nachgesendet :         %6lld Bytes in %ld Übertragungen, %lld kB/s\n", spool.flushed,
+                spool.flushes, spool.flushed / ( spool.flush_time > 0 ? spool.flush_time : 1 ));
+        }
+    print_upload();
+    }
+#endif  // NIX
+
+
+/*  function        static void upload( reader_t * p_reader, weatherdata_t const * p_weatherdata )
+
+    brief           Puts the data string of a reading into the upload queue
+                    if one of the template's variables or an alarm flag
+                    changed since the last upload
+
+    param[in,out]   reader_t * p_reader, its upload_changes are cleared if
+                    the string was put into the queue
+    param[in]       weatherdata_t const * p_weatherdata
+*/
+static void upload( reader_t * p_reader, weatherdata_t const * p_weatherdata )
+    {
+    station_t * p_station = p_reader->p_station;
+    unsigned int * p_changes = &p_reader->upload_changes;
+    ERRNO error;
+
+    *p_changes |= atomic_exchange(&p_reader->resend, 0);                        // the last string was dropped or not sent
+    debug("Preparing data string\n");
+    if( !SetFtpString(p_station, p_weatherdata, *p_changes) && !( *p_changes & CHG_ALARM ) )
+        {
+        debug("Data string unchanged, not sent\n");
+        return;
+        }
+#ifndef NIX
+    if( p_weatherdata->temperature < 75.0 )
+        {
+        debug("Queueing data string\n");
+        error = upload_push(p_station, p_station->config.ftp_string, &p_reader->resend);
+        print_ftp(p_station);
+        if( error )
+            {
+            printf("FTP error : %d, programm continuing!\n", error);
+            *p_changes = CHG_ALL;                                               // send it again next time
+            return;
+            }
+        }
+#else                                                                           // NIX
+    (void)error;
+#endif    // NIX
+    *p_changes = 0;
+    }
+
+
+/*  function        static void rollup( station_t * p_station, weatherdata_t const * p_weatherdata )
+
+    brief           Appends a reading to the log files
+
+    param[in]       station_t * p_station
+    param[in]       weatherdata_t const * p_weatherdata
+*/
+static void rollup( station_t * p_station, weatherdata_t const * p_weatherdata )
+    {
+    ERRNO error;
+
+    debug("Logging\n");
+    if( (error = Log(p_station, p_weatherdata)) != NOERR )
+        printf("Logging error : %d, programm continuing!\n", error);
+    }
+
+
+/*  function        static void job_sample( void * p_arg )
+
+    brief           Job : reads the fields that are sampled more often than
+                    the station is read
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_sample( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+
+    SampleData(p_reader->p_station);
+    }
+
+
+/*  function        static void job_read( void * p_arg )
+
+    brief           Job : reads the weather station, puts the reading into the
+                    pipeline or prints it in verbose mode
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_read( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+    station_t * p_station = p_reader->p_station;
+    reading_t reading;
+    struct timespec start;
+
+    memset(&reading, 0, sizeof(reading));
+    reading.p_station = p_station;
+    time(&reading.time);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ReadData(p_station);
+    reading.duration = add_cycle(p_reader, &start);
+    reading.cycle_min = p_reader->cycle_min;
+    reading.cycle_mean = (long)(p_reader->cycle_sum / p_reader->cycles);
+    reading.cycle_max = p_reader->cycle_max;
+    reading.data = p_station->weatherdata;
+    get_comm_stats(&p_station->link, &reading.stats);
+    if( sched_active(&p_station->sched) )
+        sched_stats(&p_station->sched, &reading.ticks, &reading.fields);
+
+    if( p_reader->p_pipeline )
+        {
+        pipeline_put(p_reader->p_pipeline, &reading);
+        return;
+        }
+
+    p_reader->upload_changes |= reading.data.changed;
+    print_reading(&reading);
+    if( verbose() )
+        print_jobs(&p_reader->jobs);
+    if( reading.data.changed & CHG_ALARM )                                      // don't wait for the next upload
+        upload(p_reader, &p_station->weatherdata);
+    }
+
+
+/*  function        static void job_alarm( void * p_arg )
+
+    brief           Job : polls the alarm flags, reads the station at once if
+                    one of them changed
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_alarm( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+
+    if( PollAlarms(p_reader->p_station) )
+        {
+        debug("Alarm flags changed\n");
+        job_read(p_reader);                                                     // out of cycle, the reading is uploaded at once
+        }
+    }
+
+
+/*  function        static void job_upload( void * p_arg )
+
+    brief           Job : sends the data string to the ftp server
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_upload( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+
+    upload(p_reader, &p_reader->p_station->weatherdata);
+    }
+
+
+/*  function        static void job_rollup( void * p_arg )
+
+    brief           Job : appends the data to the log files
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_rollup( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+    char act_time[11];
+    time_t basictime;
+    struct tm tm_now;
+
+    rollup(p_reader->p_station, &p_reader->p_station->weatherdata);
+
+    time(&basictime);
+    strftime(act_time, sizeof(act_time)-1, "%H:%M:%S", localtime_r(&basictime, &tm_now));
+    act_time[10] = 0;
+
+    if( verbose() )
+        printf("%s\n", act_time);
+    }
+
+
+/*  function        static void job_reset( void * p_arg )
+
+    brief           Job : resets the minimum and maximum values once a day
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_reset( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+    struct timespec start;
+    struct timespec end;
+
+    if( !minmax_reset_due(p_reader, time(0)) )
+        return;
+
+    debug("Resetting minimum and maximum values\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    minmax_reset_all(p_reader->p_station);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if( verbose() )
+        printf("Min/Max zurückgesetzt :  %6ld ms\n",
+            (end.tv_sec - start.tv_sec) * 1000L + (end.tv_nsec - start.tv_nsec) / 1000000L);
+    }
+
+
+/*  function        static void job_history( void * p_arg )
+
+    brief           Job : fetches new history records, corrects their time by
+                    the drift of the station's clock and logs them
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_history( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+    station_t * p_station = p_reader->p_station;
+    int records;
+    int i;
+
+    debug("Fetching history\n");
+    records = history_sync(&p_station->history, &p_station->link, p_reader->history, HISTORY_RECORDS);
+    if( records > 0 )
+        {
+        for( i = 0; i < records; ++i )                                          // the records are saved by the station's clock
+            p_reader->history[i].time = clocksync_to_host(&p_station->clock, p_reader->history[i].time);
+        LogHistory(p_station, p_reader->history, records);
+        history_save_position(&p_station->history, p_station->config.history_file);
+        }
+    if( verbose() && records >= 0 )
+        printf("Historie : %d neue Datensätze\n", records);
+    }
+
+
+/*  function        static void job_port( void * p_arg )
+
+    brief           Job : closes the serial port for a while if it is not
+                    kept open
+
+    param[in]       void * p_arg, reader_t *
+*/
+static void job_port( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+
+    ws_close(&p_reader->p_station->link.port);
+    sleep(20);
+    ws_open(&p_reader->p_station->link.port);
+    link_invalidate(&p_reader->p_station->link);
+    }
+
+
+/*  function        static ERRNO reader_init( reader_t * p_reader, station_t * p_station, pipeline_t * p_pipeline )
+
+    brief           Prepares the jobs, the ftp handle and the spool of a
+                    station. Without a pipeline the reader uploads and logs
+                    the readings itself.
+
+    param[out]      reader_t * p_reader
+    param[in]       station_t * p_station
+    param[in]       pipeline_t * p_pipeline, 0 = single station
+
+    return          ERRNO
+*/
+static ERRNO reader_init( reader_t * p_reader, station_t * p_station, pipeline_t * p_pipeline )
+    {
+    config_t const * p_config = &p_station->config;
+    int persistent = p_config->persistent_port || link_image(&p_station->link);
+    int sample = 0;
+    ERRNO error;
+    int i;
+
+    memset(p_reader, 0, sizeof(*p_reader));
+    p_reader->p_station = p_station;
+    p_reader->p_pipeline = p_pipeline;
+    p_reader->reset_day = -2;
+    p_reader->upload_due = next_multiple(time(0), p_config->upload_period);
+    p_reader->rollup_due = next_multiple(time(0), p_config->rollup_period);
+
+    for( i = 0; i < SAMPLE_NUM_OF_GROUPS; ++i )
+        {
+        if( p_config->sample_period[i] > 0 && ( sample == 0 || p_config->sample_period[i] < sample ) )
+            sample = p_config->sample_period[i];                                // shortest sampling period
+        }
+
+    error = jobs_init(&p_reader->jobs);
+    if( error )
+        return error;
+    error = FtpOpen(p_station);                                                 // the connection is kept from upload to upload
+    if( error )
+        return error;
+    error = spool_open(&p_station->spool, p_config->spool_path, p_config->spool_size);
+    if( error )
+        return error;
+
+    job_add(&p_reader->jobs, "read", p_config->read_period, job_read, p_reader); // jobs due at the same time run in this order
+    if( sample > 0 && sample < p_config->read_period && persistent )
+        job_add(&p_reader->jobs, "sample", sample, job_sample, p_reader);
+    if( p_config->alarm_period > 0 && persistent )
+        job_add(&p_reader->jobs, "alarm", p_config->alarm_period, job_alarm, p_reader);
+    if( !p_pipeline )                                                           // else done by the output thread
+        {
+        job_add(&p_reader->jobs, "upload", p_config->upload_period, job_upload, p_reader);
+        job_add(&p_reader->jobs, "rollup", p_config->rollup_period, job_rollup, p_reader);
+        }
+    if( p_config->reset_minmax >= 0 )
+        job_add(&p_reader->jobs, "reset", 60, job_reset, p_reader);
+    if( *p_config->history_file )
+        job_add(&p_reader->jobs, "history", p_config->history_period, job_history, p_reader);
+    if( !persistent )                                                           // else the port is only reopened by handle_comm_error()
+        job_add(&p_reader->jobs, "port", p_config->read_period, job_port, p_reader);
+
+    return NOERR;
+    }
+
+
+/*  function        static void reader_open( reader_t * p_reader )
+
+    brief           Opens the serial port of a station
+
+    param[in]       reader_t * p_reader
+*/
+static void reader_open( reader_t * p_reader )
+    {
+    station_t * p_station = p_reader->p_station;
+
+    if( link_image(&p_station->link) )
+        return;
+
+    if( !p_station->config.persistent_port )
+        {
+        ws_close(&p_station->link.port);
+        debug("Serial port closed\n");
+
+        sleep(15);
+        }
+    ws_open(&p_station->link.port);
+    link_invalidate(&p_station->link);
+    debug("Serial port %s open\n", p_station->config.com_port);
+    }
+
+
+/*  function        static void * reader_thread( void * p_arg )
+
+    brief           Thread of one station : opens its port and runs its jobs
+                    until they are stopped. A slow or faulty link delays only
+                    its own station.
+
+    param[in]       void * p_arg, reader_t *
+
+    return          void *, 0
+*/
+static void * reader_thread( void * p_arg )
+    {
+    reader_t * p_reader = p_arg;
+    ERRNO error;
+
+    reader_open(p_reader);
+    if( !p_reader->jobs.stop )
+        job_read(p_reader);                                                     // don't wait for the first full minute
+    error = jobs_run(&p_reader->jobs);
+    if( error )
+        printf("Timer error of station %s : %d\n", p_reader->p_station->config.com_port, error);
+
+    return 0;
+    }
+
+
+/*  function        static void * output_thread( void * p_arg )
+
+    brief           Thread that prints, uploads and logs the readings of all
+                    stations in the order they were taken
+
+    param[in]       void * p_arg, pipeline_t *
+
+    return          void *, 0
+*/
+static void * output_thread( void * p_arg )
+    {
+    pipeline_t * p_pipeline = p_arg;
+    reader_t * p_reader;
+    reading_t reading;
+    config_t const * p_config;
+
+    while( pipeline_get(p_pipeline, &reading) )
+        {
+        p_reader = reader_of(reading.p_station);
+        if( !p_reader )
+            continue;
+        p_config = &reading.p_station->config;
+
+        print_reading(&reading);
+        p_reader->upload_changes |= reading.data.changed;
+        if( ( reading.data.changed & CHG_ALARM ) || reading.time >= p_reader->upload_due )
+            {
+            upload(p_reader, &reading.data);
+            p_reader->upload_due = next_multiple(reading.time, p_config->upload_period);
+            }
+        if( reading.time >= p_reader->rollup_due )
+            {
+            rollup(reading.p_station, &reading.data);
+            p_reader->rollup_due = next_multiple(reading.time, p_config->rollup_period);
+            }
+        }
+
+    return 0;
+    }
+
+
+/*  function        static void on_signal( int signal )
+
+    brief           Stops the jobs and the retries of the link on SIGINT and
+                    SIGTERM
+
+    param[in]       int signal
+*/
+static void on_signal( int signal )
+    {
+    (void)signal;
+    jobs_stop(&the_readers[0].jobs);
+    link_stop(&the_readers[0].p_station->link);                                 // only sets a flag, a faulty link may retry for minutes
+    }
+
+
+/*  function        static ERRNO run_single( void )
+
+    brief           Reads one station, the jobs run in the main thread
+
+    return          ERRNO
+*/
+static ERRNO run_single( void )
+    {
+    struct sigaction action;
+
+    reader_open(&the_readers[0]);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;                                              // no SA_RESTART, the timer wait has to end
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+
+    job_read(&the_readers[0]);                                                  // don't wait for the first full minute
+    return jobs_run(&the_readers[0].jobs);
+    }
+
+
+/*  function        static ERRNO run_multi( pipeline_t * p_pipeline )
+
+    brief           Reads all stations, each one in its own thread, and puts
+                    the readings out in one more thread. The main thread waits
+                    for SIGINT or SIGTERM, then stops all threads.
+
+    param[in]       pipeline_t * p_pipeline
+
+    return          ERRNO
+*/
+static ERRNO run_multi( pipeline_t * p_pipeline )
+    {
+    pthread_t output;
+    struct timespec deadline;
+    sigset_t signals;
+    long put;
+    long dropped;
+    int started;
+    int sig;
+    ERRNO error = NOERR;
+    int i;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, 0);                                    // inherited by all threads, only sigwait() gets them
+
+    if( pthread_create(&output, 0, output_thread, p_pipeline) )
+        return ERR_THREAD;
+    for( started = 0; started < the_reader_count; ++started )
+        {
+        if( pthread_create(&the_readers[started].thread, 0, reader_thread, &the_readers[started]) )
+            {
+            error = ERR_THREAD;
+            break;
+            }
+        }
+
+    if( !error )
+        sigwait(&signals, &sig);
+
+    for( i = 0; i < started; ++i )
+        {
+        jobs_stop(&the_readers[i].jobs);
+        link_stop(&the_readers[i].p_station->link);                             // a faulty link may retry for minutes
+        }
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += STOP_TIMEOUT;
+    for( i = 0; i < started; ++i )
+        {
+        if( pthread_timedjoin_np(the_readers[i].thread, 0, &deadline) == 0 )
+            continue;
+        printf("Station %s antwortet nicht, warte auf das Ende des Lesens\n", the_readers[i].p_station->config.com_port);
+        pthread_join(the_readers[i].thread, 0);                                 // not cancelled, it may hold a lock of the upload queue
+        }
+    pipeline_close(p_pipeline);
+    pthread_join(output, 0);
+
+    if( verbose() )
+        {
+        pipeline_stats(p_pipeline, &put, &dropped);
+        printf("Messungen : %ld (%ld verworfen)\n", put, dropped);
+        for( i = 0; i < the_reader_count; ++i )
+            {
+            printf("Station : %s\n", the_readers[i].p_station->config.com_port);
+            print_jobs(&the_readers[i].jobs);
+            }
+        }
+
+    return error;
+    }
+
+
+/*  function        int main( int argc, char *argv[] )
+
     brief           main function :
                         reads arguments,
-                        prepares weather statio and ftp connection
-                        loops
-                            reads data from weather station
-                            logs data to ftp server
-                            prints messages and data to cobnsole if in debug mode
-
-    param[in]       int argc, number of command line parameters
-    param[in]       char *argv[], command line parameter list
-
-    return          int, error code
-*/
+                        prepares weather stations and ftp connection
+                        runs the jobs until SIGINT or SIGTERM
+                            reads data from weather stations
+                            sends data to ftp server
+                            logs data
+                            fetches history records
+                            prints messages and data to cobnsole if in debug mode
+
+    param[in]       int argc, number of command line parameters
+    param[in]       char *argv[], command line parameter list
+
+    return          int, error code
+*/
 int main( int argc, char *argv[] )
     {
-    weatherdata_t * p_weatherdata;
-    char act_time[11];
-    time_t basictime;
+    pipeline_t pipeline;
+    station_t * p_station;
     int i;
     ERRNO error = NOERR;
 
@@ -95,99 +925,96 @@ int main( int argc, char *argv[] )
             }
         }
 
-    error = Init();
+    error = Init();                                                             // configuration, serial port, trace, image and history position
     if( error )
         {
         printf("General initialization error : %d, programm exiting!\n", error);
         return error;
         }
-    error = ws_init(com_port());
-    if( error )
+    the_readers = calloc(ini_files(), sizeof(reader_t));
+    if( !the_readers )
         {
-        printf("Serial port initialization error : %d, programm exiting!\n", error);
-        return error;
+        DeInit();
+        return ERR_OUT_OF_MEMORY;
         }
     error = FtpInit();
     if( error )
         {
         printf("FTP initialization error : %d, programm exiting!\n", error);
-        return error;
+        goto end_main;
+        }
+    error = pipeline_init(&pipeline);
+    if( error )
+        {
+        printf("Thread initialization error : %d, programm exiting!\n", error);
+        goto end_main;
+        }
+    error = upload_init();
+    if( error )
+        {
+        printf("Thread initialization error : %d, programm exiting!\n", error);
+        pipeline_deinit(&pipeline);
+        goto end_main;
         }
 
-    ws_close();
-    debug("Serial port closed\n");
-
-    sleep(15);
-    ws_open();
-    debug("Serial port open\n");
-
-    for( ; ; )
+    for( i = 0; i < ini_files(); ++i )
         {
-        ReadData();
-        p_weatherdata = get_weatherdata_ptr();
-        if( verbose() )
+        p_station = station_default();
+        if( i > 0 )
             {
-            printf("Zeit : %s\n", p_weatherdata->act_time);
-            printf("Temperatur innen :        %6.2f °C\n", p_weatherdata->temperature_in);      // temperature [٠C]
-            printf("Temperatur aussen :       %6.2f °C\n", p_weatherdata->temperature);         // temperature [٠C]
-            printf("Luftdruck (abs.) :       %6.1f hPa\n", p_weatherdata->pressure);            // absolute pressure [hPa]
-            printf("Luftdruck (rel.) :       %6.1f hPa\n", GetRelPressure());                   // relative pressure [hPa]
-            printf("Luftfeuchtigkeit innen :  %3d %%\n", p_weatherdata->humidity_in);           // relative humudity [%]
-            printf("Luftfeuchtigkeit aussen : %3d %%\n", p_weatherdata->humidity);              // relative humudity [%]
-            if( p_weatherdata->sensor_connected == 0 )
+            p_station = malloc(sizeof(station_t));
+            if( !p_station )
                 {
-                printf("Windrichtung :            %5.1f °\n", p_weatherdata->direction);        // wind direction [٠]
-                printf("Windrichtung :            %3s\n", p_weatherdata->dir);                  // wind direction
-                printf("Windgeschwindigkeit :      %4.1f m/sec\n", p_weatherdata->speed[0]);    // wind speed [m/sec]
-                printf("                          %5.1f km/h\n", p_weatherdata->speed[1]);      // wind speed [km/h]
-                printf("                          %5.1f kn\n", p_weatherdata->speed[2]);        // wind speed [kn]
-                printf("                           %2d bft\n", (int)p_weatherdata->speed[3]);   // wind speed [bft]
+                error = ERR_OUT_OF_MEMORY;
+                break;
                 }
-            else
+            error = station_init(p_station, ini_file(i));
+            if( error )
                 {
-                printf("Windsensor nicht angeschlossen!\n");
+                printf("Initialization error of %s : %d, programm exiting!\n", ini_file(i), error);
+                station_deinit(p_station);
+                free(p_station);
+                break;
                 }
-            printf("Taupunkt :                %6.2f °C\n", p_weatherdata->dewpoint);            // dewpoint [٠]
-            printf("Gefühlte Temp. :          %6.2f °C\n", p_weatherdata->windchill);           // windchill [٠]
-            printf("Regen / Stunde :          %5.1f mm\n", p_weatherdata->rain_per_hour);       // rain_per_hour [l]
-            printf("Regen / 24 Stunden :      %5.1f mm\n", p_weatherdata->rain_per_day);        // rain_per_day [l]
             }
-        debug("Preparing data string\n");
-        SetFtpString();
-#ifndef NIX
-        if( p_weatherdata->temperature < 75.0 )
+        error = reader_init(&the_readers[i], p_station, ( ini_files() > 1 ) ? &pipeline : 0);
+        ++the_reader_count;
+        if( error )
             {
-            debug("Sending data string\n");
-            error = PushFile();
-            if( error )
-                {
-                printf("FTP error : %d, programm continuing!\n", error);
-                }
+            printf("Station initialization error : %d, programm exiting!\n", error);
+            break;
             }
+        }
 
-#endif    // NIX
-        debug("Logging\n");
-        if( Log() )
-            printf("Logging error : %d, programm continuing!\n", error);
-
-        time(&basictime);
-        strftime(act_time, sizeof(act_time)-1, "%H:%M:%S", localtime(&basictime));
-        act_time[10] = 0;
-
-        if( verbose() )
-            printf("%s\n", act_time);
-
-        ws_close();
-        sleep(20);
-        ws_open();
-
-        WaitForNextMinute();
+    if( !error )
+        {
+        error = ( the_reader_count > 1 ) ? run_multi(&pipeline) : run_single();
+        if( error )
+            printf("Timer error : %d, programm exiting!\n", error);
         }
 
+    upload_deinit();                                                            // sends what the readers left in the queue
+#ifndef NIX
+    print_upload();
+#endif  // NIX
     printf("\n");
 
+    for( i = 0; i < the_reader_count; ++i )
+        {
+        jobs_deinit(&the_readers[i].jobs);
+        FtpClose(the_readers[i].p_station);
+        spool_close(&the_readers[i].p_station->spool);
+        if( i > 0 )
+            {
+            station_deinit(the_readers[i].p_station);
+            free(the_readers[i].p_station);
+            }
+        }
+    pipeline_deinit(&pipeline);
+end_main:
     FtpCleanup();
+    free(the_readers);
     DeInit();
 
-    return NOERR;
+    return error;
     }
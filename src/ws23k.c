@@ -22,7 +22,7 @@
 
     file        ws23k.c
 
-    date        08.12.2018
+    date        17.10.2026
 
     author      Uwe Jantzen (jantzen@klabautermann-software.de)
 
@@ -45,40 +45,43 @@
 #include "debug.h"
 #include "data.h"
 #include "ws23kcom.h"
+#include "ws23kmap.h"
+#include "ws23ksched.h"
 #include "ws23k.h"
+#include "station.h"
 #include <string.h>
 #include <math.h>
 #include <time.h>
 #include <unistd.h>
 
 
-#define WRITE_NIBBBLE                           0x42
 #define MAXWINDRETRIES                          20
 
 
-static weatherdata_t the_weatherdata;
-
-
-/*  function        weatherdata_t * get_weatherdata_ptr( void )
+/*  function        weatherdata_t * get_weatherdata_ptr( station_t * p_station )
 
     brief           returns tointer to the global weatherdata structue
 
+    param[in]       station_t * p_station
+
     return          weatherdata_t     *, pointer to the global weatherdata structue
 */
-weatherdata_t * get_weatherdata_ptr( void )
+weatherdata_t * get_weatherdata_ptr( station_t * p_station )
     {
-    return &the_weatherdata;
+    return &p_station->weatherdata;
     }
 
 
-/*  function        double GetRelPressure( void )
+/*  function        double GetRelPressure( weatherdata_t const * p_weatherdata )
 
     brief           calculates the relativer air pressure from the absolute pressure and temperature
                     from the weather station and a giver height
 
+    param[in]       weatherdata_t const * p_weatherdata, a reading of the station
+
     return          double, relative pressure
 */
-double GetRelPressure( void )
+double GetRelPressure( weatherdata_t const * p_weatherdata )
     {
     double const G0 = 9.80665;
     double const R_STAR = 287.05;
@@ -89,1686 +92,1532 @@ double GetRelPressure( void )
     double p;
     double e_approx;
 
-    if( the_weatherdata.temperature < 9.1 )
+    if( p_weatherdata->temperature < 9.1 )
         {
-        x = 0.06 * the_weatherdata.temperature;
+        x = 0.06 * p_weatherdata->temperature;
         e_approx = 5.6402 * (exp(x) - 0.0916);
         }
     else
         {
-        x = -0.0666 * the_weatherdata.temperature;
+        x = -0.0666 * p_weatherdata->temperature;
         e_approx = 18.2194 * (1.0463 - exp(x));
         }
 
-    x = R_STAR * ((the_weatherdata.temperature+KELVIN) + CH*e_approx + A*HEIGHT/2);
+    x = R_STAR * ((p_weatherdata->temperature+KELVIN) + CH*e_approx + A*HEIGHT/2);
     x = G0 * HEIGHT / x;
-    p = the_weatherdata.pressure * exp(x);
+    p = p_weatherdata->pressure * exp(x);
 
     return p;
     }
 
-
-/*  function        static double temperature_indoor( void )
-
-    brief           Read current indoor temperature
 
-    return          double, teperature [°C]
-*/
-double temperature_indoor( void )
-    {
-    uint8_t data[2];
-    int address = 0x346;
-    int bytes = 2;
+/*  function        static void read_plan( station_t * p_station, readplan_t * p_plan )
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           Reads all fields of a plan, communication errors are handled
+                    here
+
+    param[in]       station_t * p_station
+    param[in,out]   readplan_t * p_plan
+*/
+static void read_plan( station_t * p_station, readplan_t * p_plan )
+    {
+    ERRNO error;
 
-    return (((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0) - 30.0);
+    if( (error = plan_read(&p_station->link, p_plan)) != NOERR )
+        handle_comm_error(&p_station->link, error);
     }
 
 
-/*  function        void temperature_indoor_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read indoor minimum and maximum temperatures with timestamps
-
-    param[out]      double * temp_min
-    param[out]      double * temp_max
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-*/
-void temperature_indoor_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
-    {
-    uint8_t data[15];
-    int address = 0x34B;
-    int bytes = 15;
+/*  function        static void plan_unsampled( station_t * p_station, readplan_t * p_plan, int field )
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           Adds a field to a read plan if it is not sampled by the
+                    scheduler
 
-    *temp_min = ((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4)/10.0 + (data[0] & 0x0f) / 100.0) - 30.0;
-    *temp_max = ((data[4] & 0x0f) * 10 + (data[3] >> 4) + (data[3] & 0x0f)/10.0 + (data[2] >> 4) / 100.0) - 30.0;
+    param[in]       station_t * p_station
+    param[out]      readplan_t * p_plan
+    param[in]       int field, FLD_xxx
+*/
+static void plan_unsampled( station_t * p_station, readplan_t * p_plan, int field )
+    {
+    if( sched_period(&p_station->sched, field) == SAMPLE_OFF )
+        map_plan(p_plan, field);
+    }
 
-    time_min->minute = ((data[5] & 0x0f) * 10) + (data[4] >> 4);
-    time_min->hour = ((data[6] & 0x0f) * 10) + (data[5] >> 4);
-    time_min->day = ((data[7] & 0x0f) * 10) + (data[6] >> 4);
-    time_min->month = ((data[8] & 0x0f) * 10) + (data[7] >> 4);
-    time_min->year = 2000 + ((data[9] & 0x0f) * 10) + (data[8] >> 4);
 
-    time_max->minute = ((data[10] & 0x0f) * 10) + (data[9] >> 4);
-    time_max->hour = ((data[11] & 0x0f) * 10) + (data[10] >> 4);
-    time_max->day = ((data[12] & 0x0f) * 10) + (data[11] >> 4);
-    time_max->month = ((data[13] & 0x0f) * 10) + (data[12] >> 4);
-    time_max->year = 2000 + ((data[14] & 0x0f) * 10) + (data[13] >> 4);
-    }
+/*  function        static ERRNO get_sampled( station_t * p_station, readplan_t const * p_plan, int field, double * value )
 
+    brief           Gets a field from the scheduler's latest sample or, if it
+                    is not sampled, from a read plan
 
-/*  function        void temperature_indoor_reset( uint8_t minmax )
-
-    brief           Reset indoor minimum and maximum temperatures with timestamp
-
-    param[in]       uint8_t minmax, bit field to control which temperature entry is reseted
-*/
-void temperature_indoor_reset( uint8_t minmax )
+    param[in]       station_t * p_station
+    param[in]       readplan_t const * p_plan
+    param[in]       int field, FLD_xxx
+    param[out]      double * value, unchanged if the field is not available
+
+    return          ERRNO
+*/
+static ERRNO get_sampled( station_t * p_station, readplan_t const * p_plan, int field, double * value )
     {
-    uint8_t data_read[6];
-    uint8_t data_value[4];
-    uint8_t data_time[10];
-    int address = 0x346;                                                        // current temperature
-    int number = 2;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
-    data_value[2] = data_read[1] & 0x0f;
-    data_value[3] = data_read[1] >> 4;
-
-    address = 0x23b;                                                            // current time
-    number = 6;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
+    sample_t const * p_sample;
 
-    if( minmax & RESET_MIN )
-        {
-        address = 0x34B;                                                        // set min value
-        number = 4;
+    if( sched_period(&p_station->sched, field) == SAMPLE_OFF )
+        return map_get(p_plan, field, value);
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    p_sample = sched_sample(&p_station->sched, field);
+    if( !p_sample->valid )
+        return ERR_COMM_READ;
 
-        address = 0x354;                                                        // set min value timestamp
-        number = 10;
+    *value = p_sample->value;
+    return NOERR;
+    }
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x350;                                                        // set max value
-        number = 4;
+/*  function        static ERRNO get_sampled_raw( station_t * p_station, readplan_t const * p_plan, int field, unsigned long * raw )
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    brief           Gets the raw value of a field from the scheduler's latest
+                    sample or, if it is not sampled, from a read plan
 
-        address = 0x35e;                                                        // set max value timestamp
-        number = 10;
+    param[in]       station_t * p_station
+    param[in]       readplan_t const * p_plan
+    param[in]       int field, FLD_xxx
+    param[out]      unsigned long * raw, unchanged if the field is not available
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    return          ERRNO
+*/
+static ERRNO get_sampled_raw( station_t * p_station, readplan_t const * p_plan, int field, unsigned long * raw )
+    {
+    sample_t const * p_sample;
+
+    if( sched_period(&p_station->sched, field) == SAMPLE_OFF )
+        return map_get_raw(p_plan, field, raw);
+
+    p_sample = sched_sample(&p_station->sched, field);
+    if( !p_sample->valid )
+        return ERR_COMM_READ;
+
+    *raw = p_sample->raw;
+    return NOERR;
     }
 
 
-/*  function        double temperature_outdoor( void )
-
-    brief           Read current outdoor temperature
-
-    return          double, teperature [°C]
-*/
-double temperature_outdoor( void )
-    {
-    uint8_t data[2];
-    int address = 0x373;
-    int bytes = 2;
+/*  function        static int unchanged( station_t * p_station, readplan_t const * p_plan, int field )
+
+    brief           Tells whether a field that is not sampled was read with
+                    the same bytes as by the last ReadData()
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       station_t * p_station
+    param[in]       readplan_t const * p_plan
+    param[in]       int field, FLD_xxx
 
-    return (((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0) - 30.0);
+    return          int, 1 : the decoded value is still valid, 0 : decode it
+*/
+static int unchanged( station_t * p_station, readplan_t const * p_plan, int field )
+    {
+    return sched_period(&p_station->sched, field) == SAMPLE_OFF && map_changed(p_plan, field) == 0;
     }
 
 
-/*  function        void temperature_outdoor_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read outdoor minimum and maximum temperatures with timestamps
-
-    param[out]      double * temp_min
-    param[out]      double * temp_max
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-*/
-void temperature_outdoor_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
-    {
-    uint8_t data[15];
-    int address = 0x378;
-    int bytes = 15;
+/*  function        static int update_sampled( station_t * p_station, readplan_t const * p_plan, int field, double * value )
+
+    brief           Gets a field like get_sampled() but doesn't decode it if
+                    its telegram didn't change
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       station_t * p_station
+    param[in]       readplan_t const * p_plan
+    param[in]       int field, FLD_xxx
+    param[in,out]   double * value, unchanged if the field is not available
 
-    *temp_min = ((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4)/10.0 + (data[0] & 0x0f) / 100.0) - 30.0;
-    *temp_max = ((data[4] & 0x0f) * 10 + (data[3] >> 4) + (data[3] & 0x0f)/10.0 + (data[2] >> 4) / 100.0) - 30.0;
+    return          int, 1 if value was changed
+*/
+static int update_sampled( station_t * p_station, readplan_t const * p_plan, int field, double * value )
+    {
+    double v;
+
+    if( unchanged(p_station, p_plan, field) )
+        return 0;
 
-    time_min->minute = ((data[5] & 0x0f) * 10) + (data[4] >> 4);
-    time_min->hour = ((data[6] & 0x0f) * 10) + (data[5] >> 4);
-    time_min->day = ((data[7] & 0x0f) * 10) + (data[6] >> 4);
-    time_min->month = ((data[8] & 0x0f) * 10) + (data[7] >> 4);
-    time_min->year = 2000 + ((data[9] & 0x0f) * 10) + (data[8] >> 4);
+    if( get_sampled(p_station, p_plan, field, &v) != NOERR || v == *value )
+        return 0;
 
-    time_max->minute = ((data[10] & 0x0f) * 10) + (data[9] >> 4);
-    time_max->hour = ((data[11] & 0x0f) * 10) + (data[10] >> 4);
-    time_max->day = ((data[12] & 0x0f) * 10) + (data[11] >> 4);
-    time_max->month = ((data[13] & 0x0f) * 10) + (data[12] >> 4);
-    time_max->year = 2000 + ((data[14] & 0x0f) * 10) + (data[13] >> 4);
+    *value = v;
+    return 1;
     }
 
 
-/*  function        void temperature_outdoor_reset( uint8_t minmax )
-
-    brief           Reset outdoor minimum and maximum temperatures with timestamp
-
-    param[in]       uint8_t minmax, bit field to control which temperature entry is reseted
-*/
-void temperature_outdoor_reset( uint8_t minmax )
-    {
-    uint8_t data_read[6];
-    uint8_t data_value[4];
-    uint8_t data_time[10];
-    int address = 0x373;                                                        // current temperature
-    int number = 2;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
-    data_value[2] = data_read[1] & 0x0f;
-    data_value[3] = data_read[1] >> 4;
-
-    address = 0x23b;                                                            // current time
-    number = 6;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
+/*  function        static int station_time( readplan_t const * p_plan, time_t * t )
 
-    if( minmax & RESET_MIN )
-        {
-        address = 0x378;                                                        // set min value
-        number = 4;
+    brief           Takes the station's clock out of a read plan, the date of
+                    FLD_CLOCK and the time of FLD_CLOCK_SECONDS
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    param[in]       readplan_t const * p_plan
+    param[out]      time_t * t, unchanged if a field is not available
 
-        address = 0x381;                                                        // set min value timestamp
-        number = 10;
+    return          int, 1 if the clock was read
+*/
+static int station_time( readplan_t const * p_plan, time_t * t )
+    {
+    struct timestamp ts;
+    struct tm now;
+    unsigned long hms;
+    time_t minute;
+    time_t second;
+
+    if( map_get_timestamp(p_plan, FLD_CLOCK, &ts) != NOERR || map_get_raw(p_plan, FLD_CLOCK_SECONDS, &hms) != NOERR )
+        return 0;
+
+    memset(&now, 0, sizeof(now));
+    now.tm_min = ts.minute;
+    now.tm_hour = ts.hour;
+    now.tm_mday = ts.day;
+    now.tm_mon = ts.month - 1;
+    now.tm_year = ts.year - 1900;
+    now.tm_isdst = -1;                                                          // the station runs on local time
+    minute = mktime(&now);
+
+    now.tm_sec = (int)( hms % 100 );
+    now.tm_min = (int)( hms / 100 % 100 );
+    now.tm_hour = (int)( hms / 10000 );
+    now.tm_mday = ts.day;
+    now.tm_mon = ts.month - 1;
+    now.tm_year = ts.year - 1900;
+    now.tm_isdst = -1;
+    second = mktime(&now);
+    if( minute == (time_t)-1 || second == (time_t)-1 )
+        return 0;
+
+    if( second - minute > 43200 )                                               // the two telegrams were read across midnight
+        second -= 86400;
+    else if( minute - second > 43200 )
+        second += 86400;
+
+    *t = second;
+    return 1;
+    }
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x37d;                                                        // set max value
-        number = 4;
+/*  function        static double read_value( station_t * p_station, int field )
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    brief           Reads and decodes a single field
 
-        address = 0x38b;                                                        // set max value timestamp
-        number = 10;
+    param[in]       station_t * p_station
+    param[in]       int field, FLD_xxx
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    return          double, value in the field's unit
+*/
+static double read_value( station_t * p_station, int field )
+    {
+    readplan_t plan;
+    double value = 0.0;
+
+    plan_clear(&plan);
+    map_plan(&plan, field);
+    read_plan(p_station, &plan);
+    map_get(&plan, field, &value);
+
+    return value;
     }
 
 
-/*  function        double dewpoint( void )
-
-    brief           Read current dewpoint
-
-    return          double dewpoint
-*/
-double dewpoint( void )
+/*  function        static void read_minmax( station_t * p_station, int f_min, int f_max, int f_tmin, int f_tmax, double * v_min, double * v_max, struct timestamp * time_min, struct timestamp * time_max )
+
+    brief           Reads minimum and maximum values with timestamps
+                    If a pointer is 0 the corresponding field will be ignored
+
+    param[in]       station_t * p_station
+    param[in]       int f_min, FLD_xxx of the minimum
+    param[in]       int f_max, FLD_xxx of the maximum
+    param[in]       int f_tmin, FLD_xxx of the minimum's timestamp
+    param[in]       int f_tmax, FLD_xxx of the maximum's timestamp
+    param[out]      double * v_min
+    param[out]      double * v_max
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+static void read_minmax( station_t * p_station, int f_min, int f_max, int f_tmin, int f_tmax, double * v_min, double * v_max, struct timestamp * time_min, struct timestamp * time_max )
     {
-    uint8_t data[2];
-    int address = 0x3ce;
-    int bytes = 2;
+    readplan_t plan;
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    plan_clear(&plan);
+    if( v_min )
+        map_plan(&plan, f_min);
+    if( v_max )
+        map_plan(&plan, f_max);
+    if( time_min )
+        map_plan(&plan, f_tmin);
+    if( time_max )
+        map_plan(&plan, f_tmax);
+    read_plan(p_station, &plan);
 
-    return (((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0) - 30.0);
+    if( v_min )
+        map_get(&plan, f_min, v_min);
+    if( v_max )
+        map_get(&plan, f_max, v_max);
+    if( time_min )
+        map_get_timestamp(&plan, f_tmin, time_min);
+    if( time_max )
+        map_get_timestamp(&plan, f_tmax, time_max);
     }
 
 
-/*  function        void dewpoint_minmax( double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read outdoor minimum and maximum dewpoint with timestamps
-
-    param[out]      double * dp_min
-    param[out]      double * dp_max
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-*/
-void dewpoint_minmax( double * dp_min, double * dp_max, struct timestamp * time_min, struct timestamp * time_max )
+/*  function        static void write_plan( station_t * p_station, writeplan_t * p_plan )
+
+    brief           Writes all nibbles of a write plan, communication errors
+                    are handled here
+
+    param[in]       station_t * p_station
+    param[in,out]   writeplan_t * p_plan
+*/
+static void write_plan( station_t * p_station, writeplan_t * p_plan )
     {
-    uint8_t data[15];
-    int address = 0x3d3;
-    int bytes = 15;
+    ERRNO error;
+
+    if( (error = wplan_write(&p_station->link, p_plan)) != NOERR )
+        handle_comm_error(&p_station->link, error);
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    *dp_min = ((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4)/10.0 + (data[0] & 0x0f) / 100.0) - 30.0;
-    *dp_max = ((data[4] & 0x0f) * 10 + (data[3] >> 4) + (data[3] & 0x0f)/10.0 + (data[2] >> 4) / 100.0) - 30.0;
+/*  function        static void plan_field( writeplan_t * p_plan, int field, uint8_t const * nibbles )
 
-    time_min->minute = ((data[5] & 0x0f) * 10) + (data[4] >> 4);
-    time_min->hour = ((data[6] & 0x0f) * 10) + (data[5] >> 4);
-    time_min->day = ((data[7] & 0x0f) * 10) + (data[6] >> 4);
-    time_min->month = ((data[8] & 0x0f) * 10) + (data[7] >> 4);
-    time_min->year = 2000 + ((data[9] & 0x0f) * 10) + (data[8] >> 4);
+    brief           Adds all nibbles of a field to a write plan
 
-    time_max->minute = ((data[10] & 0x0f) * 10) + (data[9] >> 4);
-    time_max->hour = ((data[11] & 0x0f) * 10) + (data[10] >> 4);
-    time_max->day = ((data[12] & 0x0f) * 10) + (data[11] >> 4);
-    time_max->month = ((data[13] & 0x0f) * 10) + (data[12] >> 4);
-    time_max->year = 2000 + ((data[14] & 0x0f) * 10) + (data[13] >> 4);
+    param[out]      writeplan_t * p_plan
+    param[in]       int field, FLD_xxx
+    param[in]       uint8_t const * nibbles, one nibble per byte
+*/
+static void plan_field( writeplan_t * p_plan, int field, uint8_t const * nibbles )
+    {
+    wplan_add(p_plan, map_address(field), nibbles, map_field(field)->nibbles);
     }
 
 
-/*  function        void dewpoint_reset( uint8_t minmax )
-
-    brief           Reset outdoor minimum and maximum dewpoints with timestamp
-
-    param[in]       uint8_t minmax, bit field to control which dewpoint entry is reseted
-*/
-void dewpoint_reset( uint8_t minmax )
+/*  function        static void write_minmax( writeplan_t * p_plan, uint8_t const * value, struct timestamp const * now, int f_min, int f_max, int f_tmin, int f_tmax, uint8_t minmax )
+
+    brief           Plans to overwrite minimum and/or maximum with a value and
+                    their timestamps with the given time depending on the bits
+                    set in "minmax". A field id < 0 is skipped.
+
+    param[out]      writeplan_t * p_plan
+    param[in]       uint8_t const * value, nibbles of the new minimum/maximum
+    param[in]       struct timestamp const * now
+    param[in]       int f_min, FLD_xxx of the minimum
+    param[in]       int f_max, FLD_xxx of the maximum
+    param[in]       int f_tmin, FLD_xxx of the minimum's timestamp
+    param[in]       int f_tmax, FLD_xxx of the maximum's timestamp
+    param[in]       uint8_t minmax, bit field
+*/
+static void write_minmax( writeplan_t * p_plan, uint8_t const * value, struct timestamp const * now, int f_min, int f_max, int f_tmin, int f_tmax, uint8_t minmax )
     {
-    uint8_t data_read[6];
-    uint8_t data_value[4];
     uint8_t data_time[10];
-    int address = 0x3ce;                                                        // current dewpoint
-    int number = 2;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
-    data_value[2] = data_read[1] & 0x0f;
-    data_value[3] = data_read[1] >> 4;
-
-    address = 0x23b;                                                            // current time
-    number = 6;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
+
+    map_encode_timestamp(now, data_time);
 
     if( minmax & RESET_MIN )
         {
-        address = 0x3d3;                                                        // set min value
-        number = 4;
-
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-
-        address = 0x3dc;                                                        // set min value timestamp
-        number = 10;
-
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+        if( f_min >= 0 )
+            plan_field(p_plan, f_min, value);                                   // set min value
+        if( f_tmin >= 0 )
+            plan_field(p_plan, f_tmin, data_time);                              // set min value timestamp
         }
 
     if( minmax & RESET_MAX )
         {
-        address = 0x3d8;                                                        // set max value
-        number = 4;
+        if( f_max >= 0 )
+            plan_field(p_plan, f_max, value);                                   // set max value
+        if( f_tmax >= 0 )
+            plan_field(p_plan, f_tmax, data_time);                              // set max value timestamp
+        }
+    }
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
 
-        address = 0x3e6;                                                        // set max value timestamp
-        number = 10;
+/*  function        static void reset_minmax( station_t * p_station, int f_value, int f_min, int f_max, int f_tmin, int f_tmax, uint8_t minmax )
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    brief           Sets minimum and/or maximum to the current value and their
+                    timestamps to the station's clock depending on the bits set
+                    in "minmax"
+
+    param[in]       station_t * p_station
+    param[in]       int f_value, FLD_xxx of the current value
+    param[in]       int f_min, FLD_xxx of the minimum
+    param[in]       int f_max, FLD_xxx of the maximum
+    param[in]       int f_tmin, FLD_xxx of the minimum's timestamp
+    param[in]       int f_tmax, FLD_xxx of the maximum's timestamp
+    param[in]       uint8_t minmax, bit field
+*/
+static void reset_minmax( station_t * p_station, int f_value, int f_min, int f_max, int f_tmin, int f_tmax, uint8_t minmax )
+    {
+    readplan_t plan;
+    writeplan_t wplan;
+    uint8_t data_value[6];
+    struct timestamp now;
+
+    plan_clear(&plan);
+    map_plan(&plan, f_value);                                                   // current value
+    map_plan(&plan, FLD_CLOCK);                                                 // current time
+    read_plan(p_station, &plan);
+
+    memset(data_value, 0, sizeof(data_value));
+    memset(&now, 0, sizeof(now));
+    map_get_nibbles(&plan, f_value, data_value);
+    map_get_timestamp(&plan, FLD_CLOCK, &now);
+
+    wplan_clear(&wplan);
+    write_minmax(&wplan, data_value, &now, f_min, f_max, f_tmin, f_tmax, minmax);
+    write_plan(p_station, &wplan);
     }
 
 
-/*  function        int humidity_indoor( void )
-
-    brief           Read current indoor relative humidity
-
-    return          int, relative humidity [%]
-*/
-int humidity_indoor( void )
-    {
-    uint8_t data;
-    int address = 0x3fb;
-    int bytes = 1;
+/*  function        static int wind_invalid( unsigned long speed )
 
-    if( read_data(&data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           Checks if the station is just measuring a new wind value
 
-    return (data >> 4) * 10 + (data & 0x0f);
+    param[in]       unsigned long speed, raw wind speed
+
+    return          int, 0 if the wind data is valid
+*/
+static int wind_invalid( unsigned long speed )
+    {
+    return ( (speed & 0x0ff) == 0x0ff ) && ( (speed >> 8) <= 1 );
     }
 
 
-/*  function        int humidity_indoor_all( int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read both current indoor humidity and minimum and maximum values with timestamps
-
-    param[out]      double * hum_min [%]
-    param[out]      double * hum_max [%]
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-
-    return          int, relative humidity [%]
-*/
-int humidity_indoor_all( int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
+/*  function        static void read_wind( station_t * p_station, readplan_t * p_plan, int last, int strict )
+
+    brief           Reads the current wind until the station delivers a valid
+                    measurement or MAXWINDRETRIES is reached
+
+    param[in]       station_t * p_station
+    param[out]      readplan_t * p_plan, plan holding the wind fields
+    param[in]       int last, last field to read, FLD_WIND_DIR .. FLD_WIND_DIR5
+    param[in]       int strict, if set sensor flags and minimum code have to be 0 too
+*/
+static void read_wind( station_t * p_station, readplan_t * p_plan, int last, int strict )
     {
-    uint8_t data[13];
-    int address = 0x3fb;
-    int bytes = 13;
+    int i;
+    int field;
+    unsigned long speed = 0;
+    unsigned long flags = 0;
+    unsigned long minimum_code = 0;
+
+    for( i = 0; i < MAXWINDRETRIES; ++i )
+        {
+        plan_clear(p_plan);
+        for( field = FLD_WIND_FLAGS; field <= last; ++field )                   // windspeed and direction
+            map_plan(p_plan, field);
+        read_plan(p_station, p_plan);
+
+        map_get_raw(p_plan, FLD_WIND_SPEED, &speed);
+        map_get_raw(p_plan, FLD_WIND_FLAGS, &flags);
+        map_get_raw(p_plan, FLD_WIND_MINCODE, &minimum_code);
+
+        if( wind_invalid(speed) || ( strict && ( flags || minimum_code ) ) )    // invalid wind data
+            {
+            usleep(10000);                                                      // wait 10 seconds for new wind measurement
+            continue;
+            }
+        else
+            break;
+        }
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    *hum_min = (data[1] >> 4) * 10 + (data[1] & 0x0f);
-    *hum_max = (data[2] >> 4) * 10 + (data[2] & 0x0f);
+/*  function        static double temperature_indoor( station_t * p_station )
 
-    time_min->minute = ((data[3] >> 4) * 10) + (data[3] & 0x0f);
-    time_min->hour = ((data[4] >> 4) * 10) + (data[4] & 0x0f);
-    time_min->day = ((data[5] >> 4) * 10) + (data[5] & 0x0f);
-    time_min->month = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_min->year = 2000 + ((data[7] >> 4) * 10) + (data[7] & 0x0f);
+    brief           Read current indoor temperature
 
-    time_max->minute = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-    time_max->hour = ((data[9] >> 4) * 10) + (data[9] & 0x0f);
-    time_max->day = ((data[10] >> 4) * 10) + (data[10] & 0x0f);
-    time_max->month = ((data[11] >> 4) * 10) + (data[11] & 0x0f);
-    time_max->year = 2000 + ((data[12] >> 4) * 10) + (data[12] & 0x0f);
+    param[in]       station_t * p_station
 
-    return (data[0] >> 4) * 10 + (data[0] & 0x0f);
+    return          double, teperature [°C]
+*/
+double temperature_indoor( station_t * p_station )
+    {
+    return read_value(p_station, FLD_TEMP_IN);
     }
 
 
-/*  function        void humidity_indoor_reset( uint8_t minmax )
-
-    brief           Reset indoor minimum and maximum humidity with timestamp
-
-    param[in]       uint8_t minmax, bit field to control which humidity entry is reseted
-*/
-void humidity_indoorr_reset( uint8_t minmax )
+/*  function        void temperature_indoor_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
+
+    brief           Read indoor minimum and maximum temperatures with timestamps
+
+    param[in]       station_t * p_station
+    param[out]      double * temp_min
+    param[out]      double * temp_max
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+void temperature_indoor_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
     {
-    uint8_t data_read[6];
-    uint8_t data_value[4];
-    uint8_t data_time[10];
-    int address = 0x3fb;                                                        // current humidity
-    int number = 1;
+    read_minmax(p_station, FLD_TEMP_IN_MIN, FLD_TEMP_IN_MAX, FLD_TEMP_IN_TMIN, FLD_TEMP_IN_TMAX, temp_min, temp_max, time_min, time_max);
+    }
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
 
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
+/*  function        void temperature_indoor_reset( station_t * p_station, uint8_t minmax )
 
-    address = 0x23b;                                                            // current time
-    number = 6;
+    brief           Reset indoor minimum and maximum temperatures with timestamp
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field to control which temperature entry is reseted
+*/
+void temperature_indoor_reset( station_t * p_station, uint8_t minmax )
+    {
+    reset_minmax(p_station, FLD_TEMP_IN, FLD_TEMP_IN_MIN, FLD_TEMP_IN_MAX, FLD_TEMP_IN_TMIN, FLD_TEMP_IN_TMAX, minmax);
+    }
 
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
 
-    if( minmax & RESET_MIN )
-        {
-        address = 0x3fd;                                                        // set min value
-        number = 2;
+/*  function        double temperature_outdoor( station_t * p_station )
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    brief           Read current outdoor temperature
 
-        address = 0x401;                                                        // set min value timestamp
-        number = 10;
+    param[in]       station_t * p_station
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    return          double, teperature [°C]
+*/
+double temperature_outdoor( station_t * p_station )
+    {
+    return read_value(p_station, FLD_TEMP_OUT);
+    }
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x3ff;                                                        // set max value
 
-        number = 2;
+/*  function        void temperature_outdoor_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
+
+    brief           Read outdoor minimum and maximum temperatures with timestamps
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    param[in]       station_t * p_station
+    param[out]      double * temp_min
+    param[out]      double * temp_max
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+void temperature_outdoor_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
+    {
+    read_minmax(p_station, FLD_TEMP_OUT_MIN, FLD_TEMP_OUT_MAX, FLD_TEMP_OUT_TMIN, FLD_TEMP_OUT_TMAX, temp_min, temp_max, time_min, time_max);
+    }
 
-        address = 0x40b;                                                        // set max value timestamp
-        number = 10;
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+/*  function        void temperature_outdoor_reset( station_t * p_station, uint8_t minmax )
+
+    brief           Reset outdoor minimum and maximum temperatures with timestamp
+
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field to control which temperature entry is reseted
+*/
+void temperature_outdoor_reset( station_t * p_station, uint8_t minmax )
+    {
+    reset_minmax(p_station, FLD_TEMP_OUT, FLD_TEMP_OUT_MIN, FLD_TEMP_OUT_MAX, FLD_TEMP_OUT_TMIN, FLD_TEMP_OUT_TMAX, minmax);
     }
 
 
-/*  function        int humidity_outdoor( void )
-
-    brief           Read current outdoor relative humidity
-
-    return          int, relative humidity [%]
-*/
-int humidity_outdoor( void )
+/*  function        double dewpoint( station_t * p_station )
+
+    brief           Read current dewpoint
+
+    param[in]       station_t * p_station
+
+    return          double dewpoint
+*/
+double dewpoint( station_t * p_station )
     {
-    uint8_t data[20];
-    int address = 0x419;
-    int bytes = 1;
+    return read_value(p_station, FLD_DEWPOINT);
+    }
+
+
+/*  function        void dewpoint_minmax( station_t * p_station, double * temp_min, double * temp_max, struct timestamp * time_min, struct timestamp * time_max )
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           Read outdoor minimum and maximum dewpoint with timestamps
 
-    return (data[0] >> 4) * 10 + (data[0] & 0x0f);
+    param[in]       station_t * p_station
+    param[out]      double * dp_min
+    param[out]      double * dp_max
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+void dewpoint_minmax( station_t * p_station, double * dp_min, double * dp_max, struct timestamp * time_min, struct timestamp * time_max )
+    {
+    read_minmax(p_station, FLD_DEWPOINT_MIN, FLD_DEWPOINT_MAX, FLD_DEWPOINT_TMIN, FLD_DEWPOINT_TMAX, dp_min, dp_max, time_min, time_max);
     }
 
 
-/*  function        int humidity_outdoor_all( int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read both current outdoor humidity and minimum and maximum values with timestamps
-
-    param[out]      double * hum_min [%]
-    param[out]      double * hum_max [%]
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-
-    return          int, relative humidity [%]
-*/
-int humidity_outdoor_all( int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
+/*  function        void dewpoint_reset( station_t * p_station, uint8_t minmax )
+
+    brief           Reset outdoor minimum and maximum dewpoints with timestamp
+
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field to control which dewpoint entry is reseted
+*/
+void dewpoint_reset( station_t * p_station, uint8_t minmax )
     {
-    uint8_t data[13];
-    int address = 0x419;
-    int bytes = 13;
+    reset_minmax(p_station, FLD_DEWPOINT, FLD_DEWPOINT_MIN, FLD_DEWPOINT_MAX, FLD_DEWPOINT_TMIN, FLD_DEWPOINT_TMAX, minmax);
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    *hum_min = (data[1] >> 4) * 10 + (data[1] & 0x0f);
-    *hum_max = (data[2] >> 4) * 10 + (data[2] & 0x0f);
+/*  function        int humidity_indoor( station_t * p_station )
 
-    time_min->minute = ((data[3] >> 4) * 10) + (data[3] & 0x0f);
-    time_min->hour = ((data[4] >> 4) * 10) + (data[4] & 0x0f);
-    time_min->day = ((data[5] >> 4) * 10) + (data[5] & 0x0f);
-    time_min->month = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_min->year = 2000 + ((data[7] >> 4) * 10) + (data[7] & 0x0f);
+    brief           Read current indoor relative humidity
 
-    time_max->minute = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-    time_max->hour = ((data[9] >> 4) * 10) + (data[9] & 0x0f);
-    time_max->day = ((data[10] >> 4) * 10) + (data[10] & 0x0f);
-    time_max->month = ((data[11] >> 4) * 10) + (data[11] & 0x0f);
-    time_max->year = 2000 + ((data[12] >> 4) * 10) + (data[12] & 0x0f);
+    param[in]       station_t * p_station
 
-    return (data[0] >> 4) * 10 + (data[0] & 0x0f);
+    return          int, relative humidity [%]
+*/
+int humidity_indoor( station_t * p_station )
+    {
+    return (int)read_value(p_station, FLD_HUM_IN);
     }
 
 
-/*  function        void humidity_outdoor_reset( uint8_t minmax )
-
-    brief           Reset outdoor minimum and maximum humidiy with timestamp
-
-    param[in]       uint8_t minmax, bit field to control which humidity entry is reseted
-*/
-void humidity_outdoor_reset( uint8_t minmax )
+/*  function        int humidity_indoor_all( station_t * p_station, int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
+
+    brief           Read both current indoor humidity and minimum and maximum values with timestamps
+
+    param[in]       station_t * p_station
+    param[out]      double * hum_min [%]
+    param[out]      double * hum_max [%]
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+
+    return          int, relative humidity [%]
+*/
+int humidity_indoor_all( station_t * p_station, int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
     {
-    uint8_t data_read[6];
-    uint8_t data_value[4];
-    uint8_t data_time[10];
-    int address = 0x419;                                                        // current humidity
-    int number = 1;
+    readplan_t plan;
+    double value[3] = { 0.0, 0.0, 0.0 };
+
+    plan_clear(&plan);
+    map_plan(&plan, FLD_HUM_IN);
+    map_plan(&plan, FLD_HUM_IN_MIN);
+    map_plan(&plan, FLD_HUM_IN_MAX);
+    map_plan(&plan, FLD_HUM_IN_TMIN);
+    map_plan(&plan, FLD_HUM_IN_TMAX);
+    read_plan(p_station, &plan);
+
+    map_get(&plan, FLD_HUM_IN, &value[0]);
+    map_get(&plan, FLD_HUM_IN_MIN, &value[1]);
+    map_get(&plan, FLD_HUM_IN_MAX, &value[2]);
+    map_get_timestamp(&plan, FLD_HUM_IN_TMIN, time_min);
+    map_get_timestamp(&plan, FLD_HUM_IN_TMAX, time_max);
+
+    *hum_min = (int)value[1];
+    *hum_max = (int)value[2];
+
+    return (int)value[0];
+    }
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
 
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
+/*  function        void humidity_indoor_reset( uint8_t minmax )
 
-    address = 0x23b;                                                            // current time
-    number = 6;
+    brief           Reset indoor minimum and maximum humidity with timestamp
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       uint8_t minmax, bit field to control which humidity entry is reseted
+*/
+void humidity_indoorr_reset( station_t * p_station, uint8_t minmax )
+    {
+    reset_minmax(p_station, FLD_HUM_IN, FLD_HUM_IN_MIN, FLD_HUM_IN_MAX, FLD_HUM_IN_TMIN, FLD_HUM_IN_TMAX, minmax);
+    }
 
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
 
-    if( minmax & RESET_MIN )
-        {
-        address = 0x41b;                                                        // set min value
-        number = 2;
+/*  function        int humidity_outdoor( station_t * p_station )
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    brief           Read current outdoor relative humidity
 
-        address = 0x41f;                                                        // set min value timestamp
-        number = 10;
+    param[in]       station_t * p_station
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    return          int, relative humidity [%]
+*/
+int humidity_outdoor( station_t * p_station )
+    {
+    return (int)read_value(p_station, FLD_HUM_OUT);
+    }
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x41d;                                                        // set max value
-        number = 2;
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+/*  function        int humidity_outdoor_all( station_t * p_station, int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
 
-        address = 0x429;                                                        // set max value timestamp
-        number = 10;
+    brief           Read both current outdoor humidity and minimum and maximum values with timestamps
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    param[in]       station_t * p_station
+    param[out]      double * hum_min [%]
+    param[out]      double * hum_max [%]
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+
+    return          int, relative humidity [%]
+*/
+int humidity_outdoor_all( station_t * p_station, int * hum_min, int * hum_max, struct timestamp * time_min, struct timestamp * time_max )
+    {
+    readplan_t plan;
+    double value[3] = { 0.0, 0.0, 0.0 };
+
+    plan_clear(&plan);
+    map_plan(&plan, FLD_HUM_OUT);
+    map_plan(&plan, FLD_HUM_OUT_MIN);
+    map_plan(&plan, FLD_HUM_OUT_MAX);
+    map_plan(&plan, FLD_HUM_OUT_TMIN);
+    map_plan(&plan, FLD_HUM_OUT_TMAX);
+    read_plan(p_station, &plan);
+
+    map_get(&plan, FLD_HUM_OUT, &value[0]);
+    map_get(&plan, FLD_HUM_OUT_MIN, &value[1]);
+    map_get(&plan, FLD_HUM_OUT_MAX, &value[2]);
+    map_get_timestamp(&plan, FLD_HUM_OUT_TMIN, time_min);
+    map_get_timestamp(&plan, FLD_HUM_OUT_TMAX, time_max);
+
+    *hum_min = (int)value[1];
+    *hum_max = (int)value[2];
+
+    return (int)value[0];
     }
 
 
-/*  function        double wind_current( double * winddir )
-
-    brief           Read wind speed and wind direction
-
-    param[out]      double * winddir [°]
-
-    return          double, wind speed [m/s]
-*/
-double wind_current( double * winddir )
+/*  function        void humidity_outdoor_reset( station_t * p_station, uint8_t minmax )
+
+    brief           Reset outdoor minimum and maximum humidiy with timestamp
+
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field to control which humidity entry is reseted
+*/
+void humidity_outdoor_reset( station_t * p_station, uint8_t minmax )
     {
-    int i;
-    uint8_t data[3];
-    int address = 0x527;                                                        // windspeed and direction
-    int bytes = 3;
+    reset_minmax(p_station, FLD_HUM_OUT, FLD_HUM_OUT_MIN, FLD_HUM_OUT_MAX, FLD_HUM_OUT_TMIN, FLD_HUM_OUT_TMAX, minmax);
+    }
 
-    for( i = 0; i < MAXWINDRETRIES; ++i )
-        {
-        if( read_data(data, address, bytes) != bytes )                          // wind
-            handle_comm_error(ERR_COMM_READ);
 
-        if( ( data[0] != 0x00 ) ||                                              // invalid wind data
-            ( ( data[1] == 0x0fF ) && ( ((data[2] & 0x0f) == 0 ) || ( (data[2] & 0x0f) == 1 ) ) ) )
-            {
-            usleep(10000);                                                      // wait 10 seconds for new wind measurement
-            continue;
-            }
-        else
-            break;
-        }
+/*  function        double wind_current( station_t * p_station, double * winddir )
+
+    brief           Read wind speed and wind direction
+
+    param[in]       station_t * p_station
+    param[out]      double * winddir [°]
 
-    *winddir = (data[2] >> 4) * 22.5;
+    return          double, wind speed [m/s]
+*/
+double wind_current( station_t * p_station, double * winddir )
+    {
+    readplan_t plan;
+    double speed = 0.0;
+
+    read_wind(p_station, &plan, FLD_WIND_DIR, 1);
 
-    return (((data[2] & 0x0f) << 8) + data[1]) / 10.0;
+    map_get(&plan, FLD_WIND_DIR, winddir);
+    map_get(&plan, FLD_WIND_SPEED, &speed);
+
+    return speed;
     }
 
 
-/*  function        double wind_current_flags( double * winddir, int * sensor_connected, int * minimum_code )
-
-    brief           Read wind speed, wind direction, sensor flags, minimum code
-
-    param[out]      double * winddir [°]
-    param[out]      int * sensor_connected, flag : 0 = normal, 5 = sensor disconnencted
-    param[out]      int * minimum_code
-
-    return          double, wind speed [m/s]
-*/
-double wind_current_flags( double * winddir, int * sensor_connected, int * minimum_code )
-    {
-    uint8_t data[3];
-    int i;
-    int address = 0x527;                                                        // windspeed and direction
-    int bytes = 3;
+/*  function        double wind_current_flags( station_t * p_station, double * winddir, int * sensor_connected, int * minimum_code )
 
-    for( i = 0; i < MAXWINDRETRIES; ++i )
-        {
-        if( read_data(data, address, bytes) != bytes )                          // wind
-            handle_comm_error(ERR_COMM_READ);
+    brief           Read wind speed, wind direction, sensor flags, minimum code
 
-        if( ( data[1] == 0x0fF ) && ( ( (data[2] & 0x0f) == 0 ) || ( (data[2] & 0x0f) == 1 )) )
-            {
-            usleep(10000);                                                      // wait 10 seconds for new wind measurement
-            continue;
-            }
-        else
-            break;
-        }
+    param[in]       station_t * p_station
+    param[out]      double * winddir [°]
+    param[out]      int * sensor_connected, flag : 0 = normal, 5 = sensor disconnencted
+    param[out]      int * minimum_code
+
+    return          double, wind speed [m/s]
+*/
+double wind_current_flags( station_t * p_station, double * winddir, int * sensor_connected, int * minimum_code )
+    {
+    readplan_t plan;
+    double speed = 0.0;
+    unsigned long raw;
+
+    read_wind(p_station, &plan, FLD_WIND_DIR, 0);
 
-    *winddir = (data[2] >> 4) * 22.5;
-    *sensor_connected = data[0] & 0x0f;
-    *minimum_code = (data[0] >> 4) & 0x0f;
+    map_get(&plan, FLD_WIND_DIR, winddir);
+    if( map_get_raw(&plan, FLD_WIND_FLAGS, &raw) == NOERR )
+        *sensor_connected = (int)raw;
+    if( map_get_raw(&plan, FLD_WIND_MINCODE, &raw) == NOERR )
+        *minimum_code = (int)raw;
+    map_get(&plan, FLD_WIND_SPEED, &speed);
 
-    return (((data[2] & 0x0f) << 8) + data[1]) / 10.0;
+    return speed;
     }
 
 
-/*  function        double wind_all( int * winddir_index, double * winddir )
-
-    brief           Read wind speed, wind direction and last 5 wind directions
-
+/*  function        double wind_all( station_t * p_station, int * winddir_index, double * winddir )
+
+    brief           Read wind speed, wind direction and last 5 wind directions
+
+    param[in]       station_t * p_station
     param[out]      int * winddir_index,
                         Current wind direction expressed as ticks from North
-                        where North=0. Used to convert to direction string
-    param[out]      double * winddir,
+                        where North=0. Used to convert to direction string
+    param[out]      double * winddir,
                         Array of doubles containing current wind direction
                         in winddir[0] and the last 5 in the following
                         positions all given in degrees
-
-    return          double, wind speed [m/s]
-*/
-double wind_all( int * winddir_index, double * winddir )
+
+    return          double, wind speed [m/s]
+*/
+double wind_all( station_t * p_station, int * winddir_index, double * winddir )
     {
-    uint8_t data[6];
+    readplan_t plan;
+    double speed = 0.0;
+    unsigned long raw;
     int i;
-    int address = 0x527;                                                        // windspeed and direction
-    int bytes = 6;
 
-    for( i = 0; i < MAXWINDRETRIES; ++i )
-        {
-        if( read_data(data, address, bytes) != bytes )                          // wind
-            handle_comm_error(ERR_COMM_READ);
-
-        if( ( data[0]!=0x00 ) ||                                                // invalid wind data
-           ( ( data[1] == 0x0fF ) && ( ((data[2] & 0x0f) == 0 )||( (data[2] & 0x0f) == 1 ) ) ) )
-            {
-            usleep(10000);                                                      // wait 10 seconds for new wind measurement
-            continue;
-            }
-        else
-            break;
-        }
+    read_wind(p_station, &plan, FLD_WIND_DIR5, 1);
 
-    *winddir_index = data[2] >> 4;
-    winddir[0] = (data[2] >> 4) * 22.5;
-    winddir[1] = (data[3] & 0x0f) * 22.5;
-    winddir[2] = (data[3] >> 4) * 22.5;
-    winddir[3] = (data[4] & 0x0f) * 22.5;
-    winddir[4] = (data[4] >> 4) * 22.5;
-    winddir[5] = (data[5] & 0x0f) * 22.5;
+    if( map_get_raw(&plan, FLD_WIND_DIR, &raw) == NOERR )
+        *winddir_index = (int)raw;
+    for( i = 0; i <= FLD_WIND_DIR5 - FLD_WIND_DIR; ++i )
+        map_get(&plan, FLD_WIND_DIR + i, &winddir[i]);
+    map_get(&plan, FLD_WIND_SPEED, &speed);
 
-    return (((data[2] & 0x0f) << 8) + data[1]) / 10.0;
+    return speed;
     }
 
 
-/*  function        double wind_minmax( double * wind_min, double * wind_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read minimum and maximum wind speeds with timestamps
-                    If a pointer is 0 the corresponding value will be ignored
-
-    param[out]      double * wind_min [m/s]
-    param[out]      double * wind_max [m/s]
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-
-    return          double, maximum wind speed [m/s]
-*/
-double wind_minmax( double * wind_min, double * wind_max, struct timestamp * time_min, struct timestamp * time_max )
-    {
-    uint8_t data[15];
-    int address = 0x4ee;
-    int bytes = 15;
-
-    if( read_data(data, address, bytes) != bytes )
-            handle_comm_error(ERR_COMM_READ);
-
-    if( wind_min )
-        *wind_min = (data[1] * 256 + data[0]) / 360.0;
-    if( wind_max )
-        *wind_max = (data[4] * 256 + data[3]) / 360.0;
-
-    if( time_min )
-        {
-        time_min->minute = ((data[5] >> 4) * 10) + (data[5] & 0x0f);
-        time_min->hour = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-        time_min->day = ((data[7] >> 4) * 10) + (data[7] & 0x0f);
-        time_min->month = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-        time_min->year = 2000 + ((data[9] >> 4) * 10) + (data[9] & 0x0f);
-        }
-
-    if( time_max )
-        {
-        time_max->minute = ((data[10] >> 4) * 10) + (data[10] & 0x0f);
-        time_max->hour = ((data[11] >> 4) * 10) + (data[11] & 0x0f);
-        time_max->day = ((data[12] >> 4) * 10) + (data[12] & 0x0f);
-        time_max->month = ((data[13] >> 4) * 10) + (data[13] & 0x0f);
-        time_max->year = 2000 + ((data[14] >> 4) * 10) + (data[14] & 0x0f);
-        }
+/*  function        double wind_minmax( station_t * p_station, double * wind_min, double * wind_max, struct timestamp * time_min, struct timestamp * time_max )
 
-    return (data[4] * 256 + data[3]) / 360.0;
-    }
+    brief           Read minimum and maximum wind speeds with timestamps
+                    If a pointer is 0 the corresponding value will be ignored
 
+    param[in]       station_t * p_station
+    param[out]      double * wind_min [m/s]
+    param[out]      double * wind_max [m/s]
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
 
-/*  function        void wind_reset( uint8_t minmax )
-
-    brief           Reset minimum and/or maximum wind with timestamps depending
-                    on the bits set in "minmax"
-
-    param[in]       uint8_t minmax, bit field
-*/
-void wind_reset( uint8_t minmax )
+    return          double, maximum wind speed [m/s]
+*/
+double wind_minmax( station_t * p_station, double * wind_min, double * wind_max, struct timestamp * time_min, struct timestamp * time_max )
     {
-    int i;
-    uint8_t data_read[6];
-    uint8_t data_value[6];
-    uint8_t data_time[10];
-    int address;
-    int number;
-    int current_wind;
+    double max = 0.0;
 
-    address = 0x527;                                                            // windspeed
-    number = 3;
-
-    for( i = 0; i < MAXWINDRETRIES; ++i )
-        {
-        if( read_data(data_read, address, number) != number )
-            handle_comm_error(ERR_COMM_READ);
+    read_minmax(p_station, FLD_WIND_MIN, FLD_WIND_MAX, FLD_WIND_TMIN, FLD_WIND_TMAX, wind_min, &max, time_min, time_max);
+    if( wind_max )
+        *wind_max = max;
 
-        if( ( data_read[0] != 0x00 ) ||                                         // invalid wind data
-            ( ( data_read[1] == 0x0ff ) && ( ( (data_read[2] & 0x0f) == 0 ) || ( (data_read[2] & 0x0f) == 1 ) ) ) )
-            {
-            usleep(10000);                                                      // wait 10 seconds for new wind measurement
-            continue;
-            }
-        else
-            break;
-        }
+    return max;
+    }
 
-    current_wind = (((data_read[2] & 0x0f) << 8) + data_read[1]) * 36;
 
-    data_value[0] = current_wind&0x0f;
-    data_value[1] = (current_wind>>4) & 0x0f;
-    data_value[2] = (current_wind>>8) & 0x0f;
-    data_value[3] = (current_wind>>12) & 0x0f;
+/*  function        void wind_reset( station_t * p_station, uint8_t minmax )
 
-    address = 0x23b;                                                            // current time
-    number = 6;
+    brief           Reset minimum and/or maximum wind with timestamps depending
+                    on the bits set in "minmax"
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field
+*/
+void wind_reset( station_t * p_station, uint8_t minmax )
+    {
+    readplan_t plan;
+    writeplan_t wplan;
+    uint8_t data_value[4];
+    unsigned long current_wind = 0;
+    struct timestamp now;
+
+    read_wind(p_station, &plan, FLD_WIND_DIR, 1);
+    map_get_raw(&plan, FLD_WIND_SPEED, &current_wind);
+    current_wind *= 36;                                                         // 0.1 m/s to 1/360 m/s
+
+    data_value[0] = current_wind & 0x0f;
+    data_value[1] = (current_wind >> 4) & 0x0f;
+    data_value[2] = (current_wind >> 8) & 0x0f;
+    data_value[3] = (current_wind >> 12) & 0x0f;
+
+    plan_clear(&plan);
+    map_plan(&plan, FLD_CLOCK);                                                 // current time
+    read_plan(p_station, &plan);
+    memset(&now, 0, sizeof(now));
+    map_get_timestamp(&plan, FLD_CLOCK, &now);
+
+    wplan_clear(&wplan);
+    write_minmax(&wplan, data_value, &now, FLD_WIND_MIN, FLD_WIND_MAX, FLD_WIND_TMIN, FLD_WIND_TMAX, minmax);
+    write_plan(p_station, &wplan);
+    }
 
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
 
-    if( minmax & RESET_MIN )
-        {
-        address = 0x4ee;                                                        // set min value
-        number = 4;
+/*  function        double windchill( station_t * p_station )
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    brief           Read current wind chill temperature
 
-        address = 0x4F8;                                                        // set min value timestamp
-        number = 10;
+    param[in]       station_t * p_station
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    return          double, current wind chill temperature
+*/
+double windchill( station_t * p_station )
+    {
+    return read_value(p_station, FLD_WINDCHILL);
+    }
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x4f4;                                                        // set max value
-        number = 4;
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+/*  function        void windchill_minmax( station_t * p_station, double * wc_min, double * wc_max, struct timestamp * time_min, struct timestamp * time_max )
 
-        address = 0x502;                                                        // set max value timestamp
-        number = 10;
+    brief           Read minimum and maximum wind chill with timestamps
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    param[in]       station_t * p_station
+    param[out]      double * wc_min [m/s]
+    param[out]      double * wc_max [m/s]
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+void windchill_minmax( station_t * p_station, double * wc_min, double * wc_max, struct timestamp * time_min, struct timestamp * time_max )
+    {
+    read_minmax(p_station, FLD_WINDCHILL_MIN, FLD_WINDCHILL_MAX, FLD_WINDCHILL_TMIN, FLD_WINDCHILL_TMAX, wc_min, wc_max, time_min, time_max);
     }
 
 
-/*  function        double windchill( void )
-
-    brief           Read current wind chill temperature
-
-    return          double, current wind chill temperature
-*/
-double windchill( void )
-    {
-    uint8_t data[2];
-    int address = 0x3a0;
-    int bytes = 2;
+/*  function        void windchill_reset( station_t * p_station, uint8_t minmax )
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           Reset minimum and/or maximum windchill with timestamps depending
+                    on the bits set in "minmax"
 
-    return (((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0) - 30.0);
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field to control which windchill entry is reseted
+*/
+void windchill_reset( station_t * p_station, uint8_t minmax )
+    {
+    reset_minmax(p_station, FLD_WINDCHILL, FLD_WINDCHILL_MIN, FLD_WINDCHILL_MAX, FLD_WINDCHILL_TMIN, FLD_WINDCHILL_TMAX, minmax);
     }
 
 
-/*  function        void windchill_minmax( double * wc_min, double * wc_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read minimum and maximum wind chill with timestamps
-
-    param[out]      double * wc_min [m/s]
-    param[out]      double * wc_max [m/s]
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-*/
-void windchill_minmax( double * wc_min, double * wc_max, struct timestamp * time_min, struct timestamp * time_max )
-    {
-    uint8_t data[15];
-    int address = 0x3a5;
-    int bytes = 15;
-
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+/*  function        double rain_1h( station_t * p_station )
 
-    *wc_min = ((data[1] >> 4) * 10 + (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0 ) - 30.0;
-    *wc_max = ((data[4] & 0x0f) * 10 + (data[3] >> 4) + (data[3] & 0x0f) / 10.0 + (data[2] >> 4) / 100.0 ) - 30.0;
+    brief           Rain fallen in the last hour, current value
 
-    time_min->minute = ((data[5] & 0x0f) * 10) + (data[4] >> 4);
-    time_min->hour = ((data[6] & 0x0f) * 10) + (data[5] >> 4);
-    time_min->day = ((data[7] & 0x0f) * 10) + (data[6] >> 4);
-    time_min->month = ((data[8] & 0x0f) * 10) + (data[7] >> 4);
-    time_min->year = 2000 + ((data[9] & 0x0f) * 10) + (data[8] >> 4);
+    param[in]       station_t * p_station
 
-    time_max->minute = ((data[10] & 0x0f) * 10) + (data[9] >> 4);
-    time_max->hour = ((data[11] & 0x0f) * 10) + (data[10] >> 4);
-    time_max->day = ((data[12] & 0x0f) * 10) + (data[11] >> 4);
-    time_max->month = ((data[13] & 0x0f) * 10) + (data[12] >> 4);
-    time_max->year = 2000 + ((data[14] & 0x0f) * 10) + (data[13] >> 4);
+    return          double
+*/
+double rain_1h( station_t * p_station )
+    {
+    return read_value(p_station, FLD_RAIN_1H);
     }
 
 
-/*  function        void windchill_reset( uint8_t minmax )
-
-    brief           Reset minimum and/or maximum windchill with timestamps depending
-                    on the bits set in "minmax"
-
-    param[in]       uint8_t minmax, bit field to control which windchill entry is reseted
-*/
-void windchill_reset( uint8_t minmax )
-    {
-    uint8_t data_read[6];
-    uint8_t data_value[4];
-    uint8_t data_time[10];
-    int address = 0x3a0;                                                        // current windchill
-    int number = 2;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
-    data_value[2] = data_read[1] & 0x0f;
-    data_value[3] = data_read[1] >> 4;
-
-    address = 0x23b;                                                            // current time
-    number = 6;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
+/*  function        double rain_1h_all( station_t * p_station, double * rain_max, struct timestamp * time_max )
 
-    if( minmax & RESET_MIN )
-        {
-        address = 0x3a5;                                                        // set min value
-        number = 4;
+    brief           Current read rain of last 1 hour and 1h rain maximum with timestamp
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    param[in]       station_t * p_station
+    param[out]      double * rain_max
+    param[out]      struct timestamp * time_max
 
-        address = 0x3ae;                                                        // set min value timestamp
-        number = 10;
+    return          double
+*/
+double rain_1h_all( station_t * p_station, double * rain_max, struct timestamp * time_max )
+    {
+    readplan_t plan;
+    double rain = 0.0;
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    plan_clear(&plan);
+    map_plan(&plan, FLD_RAIN_1H);
+    map_plan(&plan, FLD_RAIN_1H_MAX);
+    map_plan(&plan, FLD_RAIN_1H_TMAX);
+    read_plan(p_station, &plan);
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x3aa;                                                        // set max value
-        number = 4;
+    map_get(&plan, FLD_RAIN_1H_MAX, rain_max);
+    map_get_timestamp(&plan, FLD_RAIN_1H_TMAX, time_max);
+    map_get(&plan, FLD_RAIN_1H, &rain);
 
-        if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    return rain;
+    }
 
-        address = 0x3b8;                                                        // set max value timestamp
-        number = 10;
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
-    }
+/*  function        void rain_1h_max_reset( station_t * p_station )
 
+    brief           Reset max rain 1h with timestamps
 
-/*  function        double rain_1h( void )
-
-    brief           Rain fallen in the last hour, current value
-
-    return          double
-*/
-double rain_1h( void )
+    param[in]       station_t * p_station
+*/
+void rain_1h_max_reset( station_t * p_station )
     {
-    uint8_t data[3];
-    int address = 0x4b4;
-    int bytes = 3;
+    reset_minmax(p_station, FLD_RAIN_1H, -1, FLD_RAIN_1H_MAX, -1, FLD_RAIN_1H_TMAX, RESET_MAX);
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    return (data[2] >> 4) * 1000 + (data[2] & 0x0f) * 100 + (data[1] >> 4) * 10 +
-           (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0;
-    }
+/*  function        void rain_1h_reset( station_t * p_station )
 
+    brief           Clear current rain 1h
 
-/*  function        double rain_1h_all( double * rain_max, struct timestamp * time_max )
-
-    brief           Current read rain of last 1 hour and 1h rain maximum with timestamp
-
-    param[out]      double * rain_max
-    param[out]      struct timestamp * time_max
-
-    return          double
-*/
-double rain_1h_all( double * rain_max, struct timestamp * time_max )
+    param[in]       station_t * p_station
+*/
+void rain_1h_reset( station_t * p_station )
     {
-    uint8_t data[11];
-    int address = 0x4b4;
-    int bytes = 11;
+    writeplan_t wplan;
+    uint8_t data[30];
+
+    memset(&data, 0, sizeof(data));
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    wplan_clear(&wplan);
+    plan_field(&wplan, FLD_RAIN_1H_AREA, data);                                 // overwrite 1h rain history with zeros
+    plan_field(&wplan, FLD_RAIN_1H, data);                                      // set value to zero
+    write_plan(p_station, &wplan);
+    }
 
-    *rain_max = (data[5] >> 4) * 1000 + (data[5] & 0x0f) * 100 + (data[4] >> 4) * 10 +
-                (data[4] & 0x0f) + (data[3] >> 4) / 10.0 + (data[3] & 0x0f) / 100.0;
 
-    time_max->minute = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_max->hour = ((data[7] >> 4) * 10) + (data[7] & 0x0f);
-    time_max->day = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-    time_max->month = ((data[9] >> 4) * 10) + (data[9] & 0x0f);
-    time_max->year = 2000 + ((data[10] >> 4) * 10) + (data[10] & 0x0f);
+/*  function        double rain_24h( station_t * p_station )
 
-    return (data[2] >> 4) * 1000 + (data[2] & 0x0f) * 100 + (data[1] >> 4) * 10 +
-           (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0;
-    }
+    brief           Rain fallen in the 24 hours, current value
 
+    param[in]       station_t * p_station
 
-/*  function        void rain_1h_max_reset( void )
-
-    brief           Reset max rain 1h with timestamps
-*/
-void rain_1h_max_reset( void )
+    return          double
+*/
+double rain_24h( station_t * p_station )
     {
-    uint8_t data_read[6];
-    uint8_t data_value[6];
-    uint8_t data_time[10];
-    int address = 0x4b4;                                                        // current rain 1h
-    int number = 3;
+    return read_value(p_station, FLD_RAIN_24H);
+    }
+
+
+/*  function        double rain_24h_all( station_t * p_station, double * rain_max, struct timestamp * time_max )
+
+    brief           Current read rain of last 24 hours and 1h rain maximum with timestamp
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       station_t * p_station
+    param[out]      double * rain_max
+    param[out]      struct timestamp * time_max
 
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
-    data_value[2] = data_read[1] & 0x0f;
-    data_value[3] = data_read[1] >> 4;
-    data_value[4] = data_read[2] & 0x0f;
-    data_value[5] = data_read[2] >> 4;
+    return          double
+*/
+double rain_24h_all( station_t * p_station, double * rain_max, struct timestamp * time_max )
+    {
+    readplan_t plan;
+    double rain = 0.0;
 
-    address = 0x23b;                                                            // current time
-    number = 6;
+    plan_clear(&plan);
+    map_plan(&plan, FLD_RAIN_24H);
+    map_plan(&plan, FLD_RAIN_24H_MAX);
+    map_plan(&plan, FLD_RAIN_24H_TMAX);
+    read_plan(p_station, &plan);
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    map_get(&plan, FLD_RAIN_24H_MAX, rain_max);
+    map_get_timestamp(&plan, FLD_RAIN_24H_TMAX, time_max);
+    map_get(&plan, FLD_RAIN_24H, &rain);
 
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
+    return rain;
+    }
 
-    address = 0x4ba;                                                            // set max value
-    number = 6;
 
-    if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+/*  function        void rain_24h_max_reset( station_t * p_station )
 
-    address = 0x4c0;                                                            // set max value timestamp
-    number = 10;
+    brief           Reset max rain 1h with timestamps
 
-    if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+    param[in]       station_t * p_station
+*/
+void rain_24h_max_reset( station_t * p_station )
+    {
+    reset_minmax(p_station, FLD_RAIN_24H, -1, FLD_RAIN_24H_MAX, -1, FLD_RAIN_24H_TMAX, RESET_MAX);
     }
 
 
-/*  function        void rain_1h_reset( void )
-
-    brief           Clear current rain 1h
-*/
-void rain_1h_reset( void )
+/*  function        void rain_24h_reset( station_t * p_station )
+
+    brief           Clear current rain 1h
+
+    param[in]       station_t * p_station
+*/
+void rain_24h_reset( station_t * p_station )
     {
-    uint8_t data[30];
-    int address = 0x479;                                                        // overwrite 1h rain history with zeros
-    int number = 30;
+    writeplan_t wplan;
+    uint8_t data[48];
 
     memset(&data, 0, sizeof(data));
 
-    if( write_data(data, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+    wplan_clear(&wplan);
+    plan_field(&wplan, FLD_RAIN_24H_AREA, data);                                // overwrite 24h rain history with zeros
+    plan_field(&wplan, FLD_RAIN_24H, data);                                     // set value to zero
+    write_plan(p_station, &wplan);
+    }
 
-    address = 0x4b4;                                                            // set value to zero
-    number = 6;
 
-    if( write_data(data, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
-    }
+/*  function        double rain_total( station_t * p_station )
 
+    brief           Read the current accumulated total rain
 
-/*  function        double rain_24h( void )
-
-    brief           Rain fallen in the 24 hours, current value
+    param[in]       station_t * p_station
 
-    return          double
-*/
-double rain_24h( void )
+    return          double
+*/
+double rain_total( station_t * p_station )
     {
-    uint8_t data[3];
-    int address = 0x497;
-    int bytes = 3;
+    return read_value(p_station, FLD_RAIN_TOTAL);
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    return (data[2] >> 4) * 1000 + (data[2] & 0x0f) * 100 + (data[1] >> 4) * 10 +
-           (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0;
-    }
+/*  function        double rain_total_all( station_t * p_station, struct timestamp *time_since )
 
+    brief           Read the current accumulated total rain with timestamp
 
-/*  function        double rain_24h_all( double * rain_max, struct timestamp * time_max )
-
-    brief           Current read rain of last 24 hours and 1h rain maximum with timestamp
-
-    param[out]      double * rain_max
-    param[out]      struct timestamp * time_max
-
-    return          double
-*/
-double rain_24h_all( double * rain_max, struct timestamp * time_max )
-    {
-    uint8_t data[11];
-    int address = 0x497;
-    int bytes = 11;
+    param[in]       station_t * p_station
+    param[out]      struct timestamp * time_since
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    return          double
+*/
+double rain_total_all( station_t * p_station, struct timestamp * time_since )
+    {
+    readplan_t plan;
+    double rain = 0.0;
 
-    *rain_max = (data[5] >> 4) * 1000 + (data[5] & 0x0f) * 100 + (data[4] >> 4) * 10 +
-                (data[4] & 0x0f) + (data[3] >> 4)/10.0 + (data[3] & 0x0f) / 100.0;
+    plan_clear(&plan);
+    map_plan(&plan, FLD_RAIN_TOTAL);
+    map_plan(&plan, FLD_RAIN_TOTAL_TRESET);
+    read_plan(p_station, &plan);
 
-    time_max->minute = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_max->hour = ((data[7] >> 4) * 10) + (data[7] & 0x0f);
-    time_max->day = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-    time_max->month = ((data[9] >> 4) * 10) + (data[9] & 0x0f);
-    time_max->year = 2000 + ((data[10] >> 4) * 10) + (data[10] & 0x0f);
+    map_get_timestamp(&plan, FLD_RAIN_TOTAL_TRESET, time_since);
+    map_get(&plan, FLD_RAIN_TOTAL, &rain);
 
-    return (data[2] >> 4) * 1000 + (data[2] & 0x0f) * 100 + (data[1] >> 4) * 10 +
-           (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0;
+    return rain;
     }
 
 
-/*  function        void rain_24h_max_reset( void )
-
-    brief           Reset max rain 1h with timestamps
-*/
-void rain_24h_max_reset( void )
+/*  function        void rain_total_reset( station_t * p_station )
+
+    brief           Reset total rain value
+
+    param[in]       station_t * p_station
+*/
+void rain_total_reset( station_t * p_station )
     {
-    uint8_t data_read[6];
-    uint8_t data_value[6];
+    readplan_t plan;
+    writeplan_t wplan;
+    uint8_t data_value[7];
     uint8_t data_time[10];
-    int address = 0x497;                                                        // current rain 24h
-    int number = 3;
+    struct timestamp now;
+    int address = map_address(FLD_RAIN_TOTAL) - 1;                              // the nibble in front of the value is cleared too
+    int number = map_field(FLD_RAIN_TOTAL)->nibbles + 1;
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    plan_clear(&plan);
+    map_plan(&plan, FLD_CLOCK);                                                 // current time
+    read_plan(p_station, &plan);
+    memset(&now, 0, sizeof(now));
+    map_get_timestamp(&plan, FLD_CLOCK, &now);
+    map_encode_timestamp(&now, data_time);
 
-    data_value[0] = data_read[0] & 0x0f;
-    data_value[1] = data_read[0] >> 4;
-    data_value[2] = data_read[1] & 0x0f;
-    data_value[3] = data_read[1] >> 4;
-    data_value[4] = data_read[2] & 0x0f;
-    data_value[5] = data_read[2] >> 4;
-
-    address = 0x23b;                                                            // current time
-    number = 6;
+    memset(&data_value, 0, sizeof(data_value));
 
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
+    wplan_clear(&wplan);
+    wplan_add(&wplan, address, data_value, number);                             // set value to zero
+    plan_field(&wplan, FLD_RAIN_TOTAL_TRESET, data_time);                       // set reset timestamp
+    write_plan(p_station, &wplan);
+    }
 
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
 
-    address = 0x49d;                                                            // set max value
-    number = 6;
+/*  function        double rel_pressure( station_t * p_station )
 
-    if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+    brief           Read current relative air pressure
 
-    address = 0x4a3;                                                            // set max value timestamp
-    number = 10;
+    param[in]       station_t * p_station
 
-    if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+    return          double
+*/
+double rel_pressure( station_t * p_station )
+    {
+    return read_value(p_station, FLD_PRESS_REL);
     }
 
 
-/*  function        void rain_24h_reset( void )
-
-    brief           Clear current rain 1h
-*/
-void rain_24h_reset( void )
-    {
-    uint8_t data[30];
-    int address = 0x446;                                                        // overwrite 24h rain history with zeros
-    int number = 48;
+/*  function        void rel_pressure_minmax( station_t * p_station, double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
 
-    memset(&data, 0, sizeof(data));
+    brief           Read relative pressure minimum and maximum with timestamps
 
-    if( write_data(data, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+    param[in]       station_t * p_station
+    param[out]      double * pres_min
+    param[out]      double * pres_max
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+void rel_pressure_minmax( station_t * p_station, double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
+    {
+    read_minmax(p_station, FLD_PRESS_REL_MIN, FLD_PRESS_REL_MAX, FLD_PRESS_TMIN, FLD_PRESS_TMAX, pres_min, pres_max, time_min, time_max);
+    }
 
-    address = 0x497;                                                            // set value to zero
-    number = 6;
 
-    if( write_data(data, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
-    }
+/*  function        double abs_pressure( station_t * p_station )
 
+    brief           Read current absolute air pressure
 
-/*  function        double rain_total( void )
-
-    brief           Read the current accumulated total rain
-
-    return          double
-*/
-double rain_total( void )
+    param[in]       station_t * p_station
+
+    return          double
+*/
+double abs_pressure( station_t * p_station )
     {
-    uint8_t data[3];
-    int address = 0x4d2;
-    int bytes = 3;
+    return read_value(p_station, FLD_PRESS_ABS);
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    return (data[2] >> 4) * 1000 + (data[2] & 0x0f) * 100 + (data[1] >> 4) * 10 +
-           (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0;
-    }
+/*  function        void abs_pressure_minmax( station_t * p_station, double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
 
+    brief           Read absolute pressure minimum and maximum with timestamps
 
-/*  function        double rain_total_all( struct timestamp *time_since )
-
-    brief           Read the current accumulated total rain with timestamp
-
-    param[out]      struct timestamp * time_since
-
-    return          double
-*/
-double rain_total_all( struct timestamp * time_since )
+    param[in]       station_t * p_station
+    param[out]      double * pres_min
+    param[out]      double * pres_max
+    param[out]      struct timestamp * time_min
+    param[out]      struct timestamp * time_max
+*/
+void abs_pressure_minmax( station_t * p_station, double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
     {
-    uint8_t data[8];
-    int address = 0x4d2;
-    int bytes = 8;
+    read_minmax(p_station, FLD_PRESS_ABS_MIN, FLD_PRESS_ABS_MAX, FLD_PRESS_TMIN, FLD_PRESS_TMAX, pres_min, pres_max, time_min, time_max);
+    }
+
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+/*  function        void pressure_reset( station_t * p_station, uint8_t minmax )
 
-    time_since->minute = ((data[3] >> 4) * 10) + (data[3] & 0x0f);
-    time_since->hour = ((data[4] >> 4) * 10) + (data[4] & 0x0f);
-    time_since->day = ((data[5] >> 4) * 10) + (data[5] & 0x0f);
-    time_since->month = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_since->year = 2000 + ((data[7] >> 4) * 10) + (data[7] & 0x0f);
+    brief           Reset minimum and/or maximum pressure with timestamps depending
+                    on the bits set in "minmax"
 
-    return (data[2] >> 4) * 1000 + (data[2] & 0x0f) * 100 + (data[1] >> 4) * 10 +
-           (data[1] & 0x0f) + (data[0] >> 4) / 10.0 + (data[0] & 0x0f) / 100.0;
+    param[in]       station_t * p_station
+    param[in]       uint8_t minmax, bit field to control which pressure entry is reseted
+*/
+void pressure_reset( station_t * p_station, char minmax )
+    {
+    readplan_t plan;
+    writeplan_t wplan;
+    uint8_t data_value_abs[5];
+    uint8_t data_value_rel[5];
+    struct timestamp now;
+
+    plan_clear(&plan);
+    map_plan(&plan, FLD_PRESS_ABS);                                             // current abs/rel pressure
+    map_plan(&plan, FLD_PRESS_REL);
+    map_plan(&plan, FLD_CLOCK);                                                 // current time
+    read_plan(p_station, &plan);
+
+    memset(data_value_abs, 0, sizeof(data_value_abs));
+    memset(data_value_rel, 0, sizeof(data_value_rel));
+    memset(&now, 0, sizeof(now));
+    map_get_nibbles(&plan, FLD_PRESS_ABS, data_value_abs);
+    map_get_nibbles(&plan, FLD_PRESS_REL, data_value_rel);
+    map_get_timestamp(&plan, FLD_CLOCK, &now);
+
+    wplan_clear(&wplan);
+    write_minmax(&wplan, data_value_abs, &now, FLD_PRESS_ABS_MIN, FLD_PRESS_ABS_MAX, FLD_PRESS_TMIN, FLD_PRESS_TMAX, minmax);
+    write_minmax(&wplan, data_value_rel, &now, FLD_PRESS_REL_MIN, FLD_PRESS_REL_MAX, -1, -1, minmax);
+    write_plan(p_station, &wplan);
     }
 
 
-/*  function        void rain_total_reset( void )
-
-    brief           Reset total rain value
-*/
-void rain_total_reset( void )
-    {
-    uint8_t data_read[6];
-    uint8_t data_value[7];
-    uint8_t data_time[10];
-    int address = 0x23b;                                                        // current time
-    int number = 6;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
-
-    address = 0x4d1;                                                            // set value to zero
-    number = 7;
-    memset(&data_value, 0, sizeof(data_value));
+/*  function        void minmax_reset_all( station_t * p_station )
 
-    if( write_data(data_value, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
+    brief           Sets all minimum and maximum values to the current values
+                    and their timestamps to the station's clock. The current
+                    values and the clock are read with one read plan, all
+                    minimum and maximum values are written with one write plan.
 
-    address = 0x4d8;                                                            // set max value timestamp
-    number = 10;
+    param[in]       station_t * p_station
+*/
+void minmax_reset_all( station_t * p_station )
+    {
+    static int const minmax_fields[][5] =                                       // current value, min, max, time of min, time of max
+        {
+        { FLD_TEMP_IN,   FLD_TEMP_IN_MIN,   FLD_TEMP_IN_MAX,   FLD_TEMP_IN_TMIN,   FLD_TEMP_IN_TMAX },
+        { FLD_TEMP_OUT,  FLD_TEMP_OUT_MIN,  FLD_TEMP_OUT_MAX,  FLD_TEMP_OUT_TMIN,  FLD_TEMP_OUT_TMAX },
+        { FLD_DEWPOINT,  FLD_DEWPOINT_MIN,  FLD_DEWPOINT_MAX,  FLD_DEWPOINT_TMIN,  FLD_DEWPOINT_TMAX },
+        { FLD_WINDCHILL, FLD_WINDCHILL_MIN, FLD_WINDCHILL_MAX, FLD_WINDCHILL_TMIN, FLD_WINDCHILL_TMAX },
+        { FLD_HUM_IN,    FLD_HUM_IN_MIN,    FLD_HUM_IN_MAX,    FLD_HUM_IN_TMIN,    FLD_HUM_IN_TMAX },
+        { FLD_HUM_OUT,   FLD_HUM_OUT_MIN,   FLD_HUM_OUT_MAX,   FLD_HUM_OUT_TMIN,   FLD_HUM_OUT_TMAX },
+        { FLD_RAIN_1H,   -1,                FLD_RAIN_1H_MAX,   -1,                 FLD_RAIN_1H_TMAX },
+        { FLD_RAIN_24H,  -1,                FLD_RAIN_24H_MAX,  -1,                 FLD_RAIN_24H_TMAX },
+        { FLD_PRESS_ABS, FLD_PRESS_ABS_MIN, FLD_PRESS_ABS_MAX, FLD_PRESS_TMIN,     FLD_PRESS_TMAX },
+        { FLD_PRESS_REL, FLD_PRESS_REL_MIN, FLD_PRESS_REL_MAX, -1,                 -1 },
+        };
+    readplan_t plan;
+    writeplan_t wplan;
+    uint8_t data_value[6];
+    unsigned long current_wind = 0;
+    struct timestamp now;
+    int i;
 
-    if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-        handle_comm_error(ERR_COMM_WRITE);
-    }
+    read_wind(p_station, &plan, FLD_WIND_DIR, 1);                               // the wind needs a valid measurement
+    map_get_raw(&plan, FLD_WIND_SPEED, &current_wind);
+    current_wind *= 36;                                                         // 0.1 m/s to 1/360 m/s
 
+    data_value[0] = current_wind & 0x0f;
+    data_value[1] = (current_wind >> 4) & 0x0f;
+    data_value[2] = (current_wind >> 8) & 0x0f;
+    data_value[3] = (current_wind >> 12) & 0x0f;
 
-/*  function        double rel_pressure( void )
-
-    brief           Read current relative air pressure
-
-    return          double
-*/
-double rel_pressure( void )
-    {
-    uint8_t data[3];
-    int address = 0x5e2;
-    int bytes = 3;
+    plan_clear(&plan);
+    for( i = 0; i < (int)(sizeof(minmax_fields) / sizeof(minmax_fields[0])); ++i )
+        map_plan(&plan, minmax_fields[i][0]);                                   // current values
+    map_plan(&plan, FLD_CLOCK);                                                 // current time
+    read_plan(p_station, &plan);
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    memset(&now, 0, sizeof(now));
+    map_get_timestamp(&plan, FLD_CLOCK, &now);
 
-    return (data[2] & 0x0f) * 1000 + (data[1] >> 4) * 100 + (data[1] & 0x0f) * 10 +
-           (data[0] >> 4) + (data[0] & 0x0f) / 10.0;
+    wplan_clear(&wplan);
+    write_minmax(&wplan, data_value, &now, FLD_WIND_MIN, FLD_WIND_MAX, FLD_WIND_TMIN, FLD_WIND_TMAX, RESET_MIN | RESET_MAX);
+    for( i = 0; i < (int)(sizeof(minmax_fields) / sizeof(minmax_fields[0])); ++i )
+        {
+        memset(data_value, 0, sizeof(data_value));
+        map_get_nibbles(&plan, minmax_fields[i][0], data_value);
+        write_minmax(&wplan, data_value, &now, minmax_fields[i][1], minmax_fields[i][2], minmax_fields[i][3], minmax_fields[i][4], RESET_MIN | RESET_MAX);
+        }
+    write_plan(p_station, &wplan);
     }
 
 
-/*  function        void rel_pressure_minmax( double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read relative pressure minimum and maximum with timestamps
-
-    param[out]      double * pres_min
-    param[out]      double * pres_max
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-*/
-void rel_pressure_minmax( double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
-    {
-    uint8_t data[13];
-    int address = 0x600;
-    int bytes = 13;
+/*  function        double pressure_correction( station_t * p_station )
+
+    brief           Read the correction from absolute to relaive air pressure
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    param[in]       station_t * p_station
 
-    *pres_min = (data[2] & 0x0f) * 1000 + (data[1] >> 4) * 100 + (data[1] & 0x0f) * 10 +
-                (data[0] >> 4) + (data[0] & 0x0f) / 10.0;
-    *pres_max = (data[12] & 0x0f) * 1000 + (data[11] >> 4) * 100 + (data[11] & 0x0f) * 10 +
-                (data[10] >> 4) + (data[10] & 0x0f) / 10.0;
+    return          double, correction factor
+*/
+double pressure_correction( station_t * p_station )
+    {
+    return read_value(p_station, FLD_PRESS_CORR);
+    }
 
-    address = 0x61e;                                                            // relative pressure time and date for min/max
-    bytes = 10;
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+/*  function        void tendency_forecast( station_t * p_station, int * tendency, int * forecast )
 
-    time_min->minute = ((data[0] >> 4) * 10) + (data[0] & 0x0f);
-    time_min->hour = ((data[1] >> 4) * 10) + (data[1] & 0x0f);
-    time_min->day = ((data[2] >> 4) * 10) + (data[2] & 0x0f);
-    time_min->month = ((data[3] >> 4) * 10) + (data[3] & 0x0f);
-    time_min->year = 2000 + ((data[4] >> 4) * 10) + (data[4] & 0x0f);
+    brief           Read pressure tendency and weather forecast
 
-    time_max->minute = ((data[5] >> 4) * 10) + (data[5] & 0x0f);
-    time_max->hour = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_max->day = ((data[7] >> 4) * 10) + (data[7] & 0x0f);
-    time_max->month = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-    time_max->year = 2000 + ((data[9] >> 4) * 10) + (data[9] & 0x0f);
+    param[in]       station_t * p_station
+    param[out]      int * tendency, 0 = steady, 1 = rising, 2 = falling
+    param[out]      int * forecast, 0 = rainy, 1 = cloudy, 2 = sunny
+*/
+void tendency_forecast( station_t * p_station, int * tendency, int * forecast )
+    {
+    readplan_t plan;
+    unsigned long raw;
+
+    plan_clear(&plan);
+    map_plan(&plan, FLD_FORECAST);
+    map_plan(&plan, FLD_TENDENCY);
+    read_plan(p_station, &plan);
+
+    if( map_get_raw(&plan, FLD_TENDENCY, &raw) == NOERR )
+        *tendency = (int)raw;
+    if( map_get_raw(&plan, FLD_FORECAST, &raw) == NOERR )
+        *forecast = (int)raw;
     }
 
 
-/*  function        double abs_pressure( void )
-
-    brief           Read current absolute air pressure
-
-    return          double
-*/
-double abs_pressure( void )
+/*  function        void light( station_t * p_station, int set )
+
+    brief           Turns display light on and off
+
+    param[in]       station_t * p_station
+    param[in]       int set, boolean value : 0 = off, else = on
+*/
+void light( station_t * p_station, int set )
     {
-    uint8_t data[3];
-    int address = 0x5d8;
-    int bytes = 3;
+    uint8_t data;
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    data = 0;                                                                   // bit 0 is the backlight
 
-    return (data[2] & 0x0f) * 1000 + (data[1] >> 4) * 100 + (data[1] & 0x0f) * 10 +
-           (data[0] >> 4) + (data[0] & 0x0f) / 10.0;
+    if( write_data(&p_station->link, &data, map_address(FLD_SETTINGS), 1, (set) ? BIT_SET : BIT_CLEAR) != 1 )
+        handle_comm_error(&p_station->link, ERR_COMM_WRITE);
     }
 
 
-/*  function        void abs_pressure_minmax( double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
-
-    brief           Read absolute pressure minimum and maximum with timestamps
-
-    param[out]      double * pres_min
-    param[out]      double * pres_max
-    param[out]      struct timestamp * time_min
-    param[out]      struct timestamp * time_max
-*/
-void abs_pressure_minmax( double * pres_min, double * pres_max, struct timestamp * time_min, struct timestamp * time_max )
-    {
-    uint8_t data[13];
-    int address = 0x5f6;
-    int bytes = 13;
+/*  function        static int is_alarm_threshold( int field )
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           Checks if a field is one of the alarm thresholds
 
-    *pres_min = (data[2] & 0x0f) * 1000 + (data[1] >> 4) * 100 + (data[1] & 0x0f) * 10 +
-                (data[0] >> 4) + (data[0] & 0x0f) / 10.0;
-    *pres_max = (data[12] & 0x0f) * 1000 + (data[11] >> 4) * 100 + (data[11] & 0x0f) * 10 +
-                (data[10] >> 4) + (data[10] & 0x0f) / 10.0;
+    param[in]       int field, FLD_xxx
 
-    address = 0x61e;                                                            // relative pressure time and date for min/max
-    bytes = 10;
+    return          int, 0 if not
+*/
+static int is_alarm_threshold( int field )
+    {
+    return field >= FLD_ALARM_TEMP_IN_LO && field <= FLD_ALARM_PRESS_HI;
+    }
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
 
-    time_min->minute = ((data[0] >> 4) * 10) + (data[0] & 0x0f);
-    time_min->hour = ((data[1] >> 4) * 10) + (data[1] & 0x0f);
-    time_min->day = ((data[2] >> 4) * 10) + (data[2] & 0x0f);
-    time_min->month = ((data[3] >> 4) * 10) + (data[3] & 0x0f);
-    time_min->year = 2000 + ((data[4] >> 4) * 10) + (data[4] & 0x0f);
+/*  function        ERRNO alarm_flags( station_t * p_station, unsigned long * set, unsigned long * active )
 
-    time_max->minute = ((data[5] >> 4) * 10) + (data[5] & 0x0f);
-    time_max->hour = ((data[6] >> 4) * 10) + (data[6] & 0x0f);
-    time_max->day = ((data[7] >> 4) * 10) + (data[7] & 0x0f);
-    time_max->month = ((data[8] >> 4) * 10) + (data[8] & 0x0f);
-    time_max->year = 2000 + ((data[9] >> 4) * 10) + (data[9] & 0x0f);
-    }
+    brief           Reads the alarm set and alarm active flags with a single
+                    telegram, bit 4 * i + b is bit b of the i-th nibble as
+                    listed in doc/memory_map_2300.txt
 
+    param[in]       station_t * p_station
+    param[out]      unsigned long * set, unchanged on error
+    param[out]      unsigned long * active, unchanged on error
 
-/*  function        void pressure_reset( uint8_t minmax )
-
-    brief           Reset minimum and/or maximum pressure with timestamps depending
-                    on the bits set in "minmax"
-
-    param[in]       uint8_t minmax, bit field to control which pressure entry is reseted
-*/
-void pressure_reset( char minmax )
+    return          ERRNO
+*/
+ERRNO alarm_flags( station_t * p_station, unsigned long * set, unsigned long * active )
     {
-    uint8_t data_read[8];
-    uint8_t data_value_abs[5];
-    uint8_t data_value_rel[5];
-    uint8_t data_time[10];
-    int address = 0x5d8;                                                        // current abs/rel pressure
-    int number = 8;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_value_abs[0] = data_read[0] & 0x0f;
-    data_value_abs[1] = data_read[0] >> 4;
-    data_value_abs[2] = data_read[1] & 0x0f;
-    data_value_abs[3] = data_read[1] >> 4;
-    data_value_abs[4] = data_read[2] & 0x0f;
-
-    data_value_rel[0] = data_read[5] & 0x0f;
-    data_value_rel[1] = data_read[5] >> 4;
-    data_value_rel[2] = data_read[6] & 0x0f;
-    data_value_rel[3] = data_read[6] >> 4;
-    data_value_rel[4] = data_read[7] & 0x0f;
-
-    address = 0x23b;                                                            // current time
-    number = 6;
-
-    if( read_data(data_read, address, number) != number )
-        handle_comm_error(ERR_COMM_READ);
-
-    data_time[0] = data_read[0] & 0x0f;
-    data_time[1] = data_read[0] >> 4;
-    data_time[2] = data_read[1] & 0x0f;
-    data_time[3] = data_read[1] >> 4;
-    data_time[4] = data_read[2] >> 4;
-    data_time[5] = data_read[3] & 0x0f;
-    data_time[6] = data_read[3] >> 4;
-    data_time[7] = data_read[4] & 0x0f;
-    data_time[8] = data_read[4] >> 4;
-    data_time[9] = data_read[5] & 0x0f;
+    readplan_t plan;
+    ERRNO error;
 
-    if( minmax & RESET_MIN )
+    plan_clear(&plan);
+    map_plan(&plan, FLD_ALARM_SET);
+    map_plan(&plan, FLD_ALARM_ACTIVE);
+    if( (error = plan_read(&p_station->link, &plan)) != NOERR )
         {
-        address = 0x5f6;                                                        // set min abs value
-        number = 5;
+        handle_comm_error(&p_station->link, error);
+        return error;
+        }
 
-        if( write_data(data_value_abs, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    map_get_raw(&plan, FLD_ALARM_SET, set);
+    map_get_raw(&plan, FLD_ALARM_ACTIVE, active);
+    return NOERR;
+    }
 
-        address = 0x600;                                                        // set min rel value
-        number = 5;
 
-        if( write_data(data_value_rel, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+/*  function        ERRNO alarm_thresholds( station_t * p_station, int const * fields, double * values, int n )
 
-        address = 0x61e;                                                        // set min value timestamp
-        number = 10;
+    brief           Reads alarm thresholds, all of them with one read plan
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
+    param[in]       station_t * p_station
+    param[in]       int const * fields, FLD_ALARM_xxx of the thresholds
+    param[out]      double * values, unchanged for thresholds that could not
+                    be read
+    param[in]       int n, number of thresholds
 
-    if( minmax & RESET_MAX )
-        {
-        address = 0x60a;                                                        // set max abs value
-        number = 5;
+    return          ERRNO, ERR_NO_ALARM if a field is not an alarm threshold
+*/
+ERRNO alarm_thresholds( station_t * p_station, int const * fields, double * values, int n )
+    {
+    readplan_t plan;
+    ERRNO error = NOERR;
+    int i;
 
-        if( write_data(data_value_abs, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
+    plan_clear(&plan);
+    for( i = 0; i < n; ++i )
+        {
+        if( !is_alarm_threshold(fields[i]) )
+            return ERR_NO_ALARM;
+        map_plan(&plan, fields[i]);
+        }
+    read_plan(p_station, &plan);
 
-        address = 0x614;                                                        // set max rel value
-        number = 5;
+    for( i = 0; i < n; ++i )
+        {
+        if( map_get(&plan, fields[i], &values[i]) != NOERR )
+            error = ERR_COMM_READ;
+        }
+    return error;
+    }
 
-        if( write_data(data_value_rel, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
 
-        address = 0x628;                                                        // set max value timestamp
-        number = 10;
+/*  function        ERRNO alarm_set_thresholds( station_t * p_station, int const * fields, double const * values, int n )
 
-        if( write_data(data_time, address, number, WRITE_NIBBBLE) != number )
-            handle_comm_error(ERR_COMM_WRITE);
-        }
-    }
+    brief           Writes alarm thresholds, all of them with one verified
+                    write plan. Only the thresholds are written, the alarms
+                    are switched on at the station.
 
+    param[in]       station_t * p_station
+    param[in]       int const * fields, FLD_ALARM_xxx of the thresholds
+    param[in]       double const * values, in the unit of the measured value
+    param[in]       int n, number of thresholds
 
-/*  function        double pressure_correction( void )
-
-    brief           Read the correction from absolute to relaive air pressure
-
-    return          double, correction factor
-*/
-double pressure_correction( void )
+    return          ERRNO, ERR_NO_ALARM if a field is not an alarm threshold
+*/
+ERRNO alarm_set_thresholds( station_t * p_station, int const * fields, double const * values, int n )
     {
-    uint8_t data[3];
-    int address = 0x5ec;
-    int bytes = 3;
+    writeplan_t wplan;
+    uint8_t nibbles[6];
+    ERRNO error;
+    int i;
 
-    if( read_data(data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    wplan_clear(&wplan);
+    for( i = 0; i < n; ++i )
+        {
+        if( !is_alarm_threshold(fields[i]) )
+            return ERR_NO_ALARM;
+        map_encode(fields[i], values[i], nibbles);
+        plan_field(&wplan, fields[i], nibbles);
+        }
 
-    return (data[2] & 0x0f) * 1000 + (data[1] >> 4) * 100 + (data[1] & 0x0f) * 10 +
-           (data[0] >> 4) + (data[0] & 0x0f) / 10.0 - 1000;
+    if( (error = wplan_write(&p_station->link, &wplan)) != NOERR )
+        handle_comm_error(&p_station->link, error);
+    return error;
     }
 
 
-/*  function        void tendency_forecast( int * tendency, int * forecast )
-
-    brief           Read pressure tendency and weather forecast
-
-    param[out]      int * tendency, 0 = steady, 1 = rising, 2 = falling
-    param[out]      int * forecast, 0 = rainy, 1 = cloudy, 2 = sunny
-*/
-void tendency_forecast( int * tendency, int * forecast )
-    {
-    uint8_t data;
-    int address = 0x26b;
-    int bytes = 1;
+/*  function        int PollAlarms( station_t * p_station )
 
-    if( read_data(&data, address, bytes) != bytes )
-        handle_comm_error(ERR_COMM_READ);
+    brief           reads the alarm flags, a flag that changed since the last
+                    call is reported to the next ReadData() by CHG_ALARM
 
-    *tendency = data >> 4;
-    *forecast = data & 0x0f;
+    param[in]       station_t * p_station
+
+    return          int, 1 if a flag changed
+*/
+int PollAlarms( station_t * p_station )
+    {
+    alarms_t * p_alarms = &p_station->alarms;
+    unsigned long set = 0;
+    unsigned long active = 0;
+    int flipped;
+
+    if( alarm_flags(p_station, &set, &active) != NOERR )
+        return 0;
+
+    flipped = p_alarms->valid && ( set != p_alarms->set || active != p_alarms->active );
+    p_alarms->valid = 1;
+    p_alarms->set = set;
+    p_alarms->active = active;
+    if( flipped )
+        p_alarms->flipped = 1;
+    return flipped;
     }
 
 
-/*  function        void light( int set )
+/*  function        void SampleData( station_t * p_station )
 
-    brief           Turns display light on and off
+    brief           reads the sampled fields that are due and adds a new wind
+                    sample to the wind statistics
 
-    param[in]       int set, boolean value : 0 = off, else = on
+    param[in]       station_t * p_station
 */
-void light( int set )
-    {
-    uint8_t data;
-    int address = 0x016;
-
-    data = 0;
-
-    if( write_data(&data, address, 1, (set) ? BIT_SET : BIT_CLEAR) != 1 )
-        handle_comm_error(ERR_COMM_WRITE);
-    }
-
-
-/*  function        void ReadData( void )
+void SampleData( station_t * p_station )
+    {
+    sample_t const * p_speed;
+    sample_t const * p_dir;
+    sample_t const * p_flags;
+
+    sched_tick(&p_station->sched, &p_station->link);
+
+    p_speed = sched_sample(&p_station->sched, FLD_WIND_SPEED);
+    p_dir = sched_sample(&p_station->sched, FLD_WIND_DIR);
+    p_flags = sched_sample(&p_station->sched, FLD_WIND_FLAGS);
+    if( p_speed->valid && p_dir->valid && p_dir->time == p_speed->time          // read together, sched_tick() checked the speed
+        && ( !p_flags->valid || p_flags->raw == 0 ) )                           // sensor connected
+        windstat_add(&p_station->wind, p_speed->time, p_speed->value, p_dir->value);
+    }
+
+
+/*  function        void ReadData( station_t * p_station )
 
     brief           reads data from the connected weather station and saves them
                     to the global weather data structure
                     the part commented out by NIX puts sample data to the global
                     weather data structure
+
+    param[in]       station_t * p_station
 */
-void ReadData( void )
+void ReadData( station_t * p_station )
     {
     debug("+%s \n", __func__);
 #ifndef NIX
+    readplan_t plan;
     time_t basictime;
-    struct timespec ts;
+    time_t wind_time;
+    struct tm now;
+    unsigned long raw = 0;
+    double value;
+    double speed;
+    double direction;
+    int connected;
+    char act_time[11];
+    windsummary_t wind;
+    double host_time;
+    time_t station_clock;
+    weatherdata_t * p_data = &p_station->weatherdata;
     int minimum_code;
+    ERRNO error;
 
-    ts.tv_sec = 0;
-    ts.tv_nsec = 10000000;
+    clear_comm_stats(&p_station->link);
+    p_data->changed = p_data->act_time[0] ? 0 : CHG_ALL;                        // everything is new at the first read
 
     time(&basictime);
-    strftime(the_weatherdata.act_time, sizeof(the_weatherdata.act_time)-1, "%H:%M:%S", localtime(&basictime));
-    the_weatherdata.act_time[10] = 0;
+    strftime(act_time, sizeof(act_time)-1, "%H:%M:%S", localtime_r(&basictime, &now));
+    act_time[10] = 0;
+    if( strcmp(act_time, p_data->act_time) != 0 )
+        {
+        strcpy(p_data->act_time, act_time);
+        p_data->changed |= CHG_TIME;
+        }
 
     if( verbose() )
         {
@@ -1776,80 +1625,154 @@ void ReadData( void )
         fflush(stdout);
         }
 
-    debug(" %s temperature_outdoor()\n", __func__);
-    the_weatherdata.temperature = temperature_outdoor();                        // outdoor temperature
-    nanosleep(&ts, 0);
-    debug(" %s temperature_indoor()\n", __func__);
-    the_weatherdata.temperature_in = temperature_indoor();                      // indoor temperature
-    nanosleep(&ts, 0);
-    debug(" %s humidity_outdoor()\n", __func__);
-    the_weatherdata.humidity = humidity_outdoor();
-    nanosleep(&ts, 0);
-    debug(" %s humidity_indoor()\n", __func__);
-    the_weatherdata.humidity_in = humidity_indoor();
-    nanosleep(&ts, 0);
-    debug(" %s dewpoint()\n", __func__);
-    the_weatherdata.dewpoint = dewpoint();
-    nanosleep(&ts, 0);
-    debug(" %s wind_current_flags()\n", __func__);
-    the_weatherdata.speed[0] = wind_current_flags(&the_weatherdata.direction, &the_weatherdata.sensor_connected, &minimum_code);
-    nanosleep(&ts, 0);
-    the_weatherdata.speed[1] = the_weatherdata.speed[0] * KMH;
-    the_weatherdata.speed[2] = the_weatherdata.speed[0] * KNOTS;
-    if( the_weatherdata.speed[0] < 0.3 )
-        the_weatherdata.speed[3] = 0.0;
-    else if( the_weatherdata.speed[0] < 1.4 )
-        the_weatherdata.speed[3] = 1.0;
-    else if( the_weatherdata.speed[0] < 3.1 )
-        the_weatherdata.speed[3] = 2.0;
-    else if( the_weatherdata.speed[0] < 5.3 )
-        the_weatherdata.speed[3] = 3.0;
-    else if( the_weatherdata.speed[0] < 7.8 )
-        the_weatherdata.speed[3] = 4.0;
-    else if( the_weatherdata.speed[0] < 10.5 )
-        the_weatherdata.speed[3] = 5.0;
-    else if( the_weatherdata.speed[0] < 13.6 )
-        the_weatherdata.speed[3] = 6.0;
-    else if( the_weatherdata.speed[0] < 16.9 )
-        the_weatherdata.speed[3] = 7.0;
-    else if( the_weatherdata.speed[0] < 20.5 )
-        the_weatherdata.speed[3] = 8.0;
-    else if( the_weatherdata.speed[0] < 24.4 )
-        the_weatherdata.speed[3] = 9.0;
-    else if( the_weatherdata.speed[0] < 28.3 )
-        the_weatherdata.speed[3] = 10.0;
-    else if( the_weatherdata.speed[0] < 32.5 )
-        the_weatherdata.speed[3] = 11.0;
-    else if( the_weatherdata.speed[0] < 37.1 )
-        the_weatherdata.speed[3] = 12.0;
-    else if( the_weatherdata.speed[0] < 41.6 )
-        the_weatherdata.speed[3] = 13.0;
-    else if( the_weatherdata.speed[0] < 14.3 )
-        the_weatherdata.speed[3] = 14.0;
-    else if( the_weatherdata.speed[0] < 50.6 )
-        the_weatherdata.speed[3] = 15.0;
-    else if( the_weatherdata.speed[0] <= 56.1 )
-        the_weatherdata.speed[3] = 16.0;
-    else
-        the_weatherdata.speed[3] = 17.0;
-    memcpy(&the_weatherdata.dir, directions[(int)(the_weatherdata.direction/22.5)], 4);
-    debug(" %s rain_1h()\n", __func__);
-    the_weatherdata.rain_per_hour = rain_1h();                                  // mm or l/qm
-    nanosleep(&ts, 0);
-    debug(" %s rain_24h()\n", __func__);
-    the_weatherdata.rain_per_day = rain_24h();                                  // mm or l/qm
-    nanosleep(&ts, 0);
-    debug(" %s abs_pressure()\n", __func__);
-    the_weatherdata.pressure = abs_pressure();
-    nanosleep(&ts, 0);
-    debug(" %s windchill()\n", __func__);
-    the_weatherdata.windchill = windchill();
-    nanosleep(&ts, 0);
+    if( sched_active(&p_station->sched) )                                       // sampled fields that are due
+        {
+        debug(" %s SampleData()\n", __func__);
+        SampleData(p_station);
+        }
+
+    plan_clear(&plan);                                                          // fields that are not sampled
+    plan_unsampled(p_station, &plan, FLD_TEMP_OUT);
+    plan_unsampled(p_station, &plan, FLD_TEMP_IN);
+    plan_unsampled(p_station, &plan, FLD_HUM_OUT);
+    plan_unsampled(p_station, &plan, FLD_HUM_IN);
+    plan_unsampled(p_station, &plan, FLD_DEWPOINT);
+    plan_unsampled(p_station, &plan, FLD_WIND_FLAGS);
+    plan_unsampled(p_station, &plan, FLD_WIND_SPEED);
+    plan_unsampled(p_station, &plan, FLD_WIND_DIR);
+    plan_unsampled(p_station, &plan, FLD_RAIN_1H);
+    plan_unsampled(p_station, &plan, FLD_RAIN_24H);
+    plan_unsampled(p_station, &plan, FLD_PRESS_ABS);
+    plan_unsampled(p_station, &plan, FLD_WINDCHILL);
+    map_plan(&plan, FLD_CLOCK_SECONDS);                                         // the station's clock for the drift
+    map_plan(&plan, FLD_CLOCK);
+
+    debug(" %s plan_read(&p_station->link)\n", __func__);
+    plan_compare(&plan, &p_station->hashes);                                    // fields of unchanged telegrams aren't decoded again
+    if( (error = plan_read(&p_station->link, &plan)) != NOERR )                 // fields of failed telegrams keep their last value
+        handle_comm_error(&p_station->link, error);
+
+    host_time = plan_time(&plan, map_address(FLD_CLOCK_SECONDS), map_bytes(FLD_CLOCK_SECONDS));
+    if( host_time > 0.0 && station_time(&plan, &station_clock) )                // 0 : not read from the station, e.g. an image
+        clocksync_add(&p_station->clock, host_time, station_clock);
+    clocksync_get(&p_station->clock, &p_data->clock);
+
+    if( update_sampled(p_station, &plan, FLD_TEMP_OUT, &p_data->temperature) )  // outdoor temperature
+        p_data->changed |= CHG_TEMP;
+    if( update_sampled(p_station, &plan, FLD_TEMP_IN, &p_data->temperature_in) ) // indoor temperature
+        p_data->changed |= CHG_TEMP_IN;
+    value = p_data->humidity;
+    if( update_sampled(p_station, &plan, FLD_HUM_OUT, &value) )
+        {
+        p_data->humidity = (int)value;
+        p_data->changed |= CHG_HUMIDITY;
+        }
+    value = p_data->humidity_in;
+    if( update_sampled(p_station, &plan, FLD_HUM_IN, &value) )
+        {
+        p_data->humidity_in = (int)value;
+        p_data->changed |= CHG_HUMIDITY_IN;
+        }
+    if( update_sampled(p_station, &plan, FLD_DEWPOINT, &p_data->dewpoint) )
+        p_data->changed |= CHG_DEWPOINT;
+    wind_time = basictime;
+    speed = p_data->speed[0];
+    direction = p_data->direction;
+    connected = p_data->sensor_connected;
+    if( unchanged(p_station, &plan, FLD_WIND_SPEED) && unchanged(p_station, &plan, FLD_WIND_DIR)
+        && unchanged(p_station, &plan, FLD_WIND_FLAGS) )
+        debug(" %s wind unchanged\n", __func__);
+    else if( ( get_sampled_raw(p_station, &plan, FLD_WIND_SPEED, &raw) == NOERR ) && !wind_invalid(raw) )
+        {
+        get_sampled(p_station, &plan, FLD_WIND_SPEED, &p_data->speed[0]);
+        get_sampled(p_station, &plan, FLD_WIND_DIR, &p_data->direction);
+        if( get_sampled_raw(p_station, &plan, FLD_WIND_FLAGS, &raw) == NOERR )
+            p_data->sensor_connected = (int)raw;
+        if( sched_period(&p_station->sched, FLD_WIND_SPEED) != SAMPLE_OFF )
+            wind_time = sched_sample(&p_station->sched, FLD_WIND_SPEED)->time;  // already added by SampleData()
+        }
+    else                                                                        // wait for a valid wind measurement
+        {
+        debug(" %s wind_current_flags(p_station)\n", __func__);
+        p_data->speed[0] = wind_current_flags(p_station, &p_data->direction, &p_data->sensor_connected, &minimum_code);
+        }
+    if( ( p_data->changed & CHG_WIND ) || p_data->speed[0] != speed || p_data->direction != direction
+        || p_data->sensor_connected != connected )
+        {                                                                       // derived values
+        p_data->changed |= CHG_WIND;
+        p_data->speed[1] = p_data->speed[0] * KMH;
+        p_data->speed[2] = p_data->speed[0] * KNOTS;
+        if( p_data->speed[0] < 0.3 )
+            p_data->speed[3] = 0.0;
+        else if( p_data->speed[0] < 1.4 )
+            p_data->speed[3] = 1.0;
+        else if( p_data->speed[0] < 3.1 )
+            p_data->speed[3] = 2.0;
+        else if( p_data->speed[0] < 5.3 )
+            p_data->speed[3] = 3.0;
+        else if( p_data->speed[0] < 7.8 )
+            p_data->speed[3] = 4.0;
+        else if( p_data->speed[0] < 10.5 )
+            p_data->speed[3] = 5.0;
+        else if( p_data->speed[0] < 13.6 )
+            p_data->speed[3] = 6.0;
+        else if( p_data->speed[0] < 16.9 )
+            p_data->speed[3] = 7.0;
+        else if( p_data->speed[0] < 20.5 )
+            p_data->speed[3] = 8.0;
+        else if( p_data->speed[0] < 24.4 )
+            p_data->speed[3] = 9.0;
+        else if( p_data->speed[0] < 28.3 )
+            p_data->speed[3] = 10.0;
+        else if( p_data->speed[0] < 32.5 )
+            p_data->speed[3] = 11.0;
+        else if( p_data->speed[0] < 37.1 )
+            p_data->speed[3] = 12.0;
+        else if( p_data->speed[0] < 41.6 )
+            p_data->speed[3] = 13.0;
+        else if( p_data->speed[0] < 14.3 )
+            p_data->speed[3] = 14.0;
+        else if( p_data->speed[0] < 50.6 )
+            p_data->speed[3] = 15.0;
+        else if( p_data->speed[0] <= 56.1 )
+            p_data->speed[3] = 16.0;
+        else
+            p_data->speed[3] = 17.0;
+        memcpy(&p_data->dir, directions[(int)(p_data->direction/22.5)], 4);
+        }
+    if( update_sampled(p_station, &plan, FLD_RAIN_1H, &p_data->rain_per_hour) ) // mm or l/qm
+        p_data->changed |= CHG_RAIN_1H;
+    if( update_sampled(p_station, &plan, FLD_RAIN_24H, &p_data->rain_per_day) ) // mm or l/qm
+        p_data->changed |= CHG_RAIN_24H;
+    if( update_sampled(p_station, &plan, FLD_PRESS_ABS, &p_data->pressure) )
+        p_data->changed |= CHG_PRESSURE;
+    if( update_sampled(p_station, &plan, FLD_WINDCHILL, &p_data->windchill) )
+        p_data->changed |= CHG_WINDCHILL;
+
+    if( p_data->sensor_connected == 0 )
+        windstat_add(&p_station->wind, wind_time, p_data->speed[0], p_data->direction);
+    windstat_get(&p_station->wind, basictime, &wind);
+    if( wind.samples != p_data->wind.samples || wind.mean != p_data->wind.mean || wind.gust != p_data->wind.gust
+        || wind.gust_time != p_data->wind.gust_time || wind.direction != p_data->wind.direction
+        || wind.deviation != p_data->wind.deviation )
+        p_data->changed |= CHG_WIND_STATS;
+    p_data->wind = wind;
+
+    if( p_station->alarms.flipped )                                             // reported by PollAlarms()
+        {
+        p_data->changed |= CHG_ALARM;
+        p_station->alarms.flipped = 0;
+        }
+    p_data->alarm_set = p_station->alarms.set;
+    p_data->alarm_active = p_station->alarms.active;
+
+    debug(" %s %d windows for %d fields\n", __func__, plan.n_windows, plan.n_fields);
 #else   // NIX
     time_t basictime;
+    struct tm now;
     time(&basictime);
-    strftime(the_weatherdata.act_time, sizeof(the_weatherdata.act_time)-1, "%H:%M:%S", localtime(&basictime));
-    the_weatherdata.act_time[10] = 0;
+    strftime(p_station->weatherdata.act_time, sizeof(p_station->weatherdata.act_time)-1, "%H:%M:%S", localtime_r(&basictime, &now));
+    p_station->weatherdata.act_time[10] = 0;
 
     if( verbose() )
         {
@@ -1857,57 +1780,58 @@ void ReadData( void )
         fflush(stdout);
         }
 
-    the_weatherdata.temperature = 15.5;                                         // outdoor temperature
-    the_weatherdata.temperature_in = 17.4;                                      // indoor temperature
-    the_weatherdata.humidity = 56;
-    the_weatherdata.humidity_in = 32;
-    the_weatherdata.dewpoint = 16.3;
-    the_weatherdata.speed[0] = 10;
-    the_weatherdata.direction = 275.0;
-    the_weatherdata.sensor_connected = 0;
-    the_weatherdata.speed[1] = the_weatherdata.speed[0] * KMH;
-    the_weatherdata.speed[2] = the_weatherdata.speed[0] * KNOTS;
-    if( the_weatherdata.speed[0] < 0.3 )
-        the_weatherdata.speed[3] = 0.0;
-    else if( the_weatherdata.speed[0] < 1.4 )
-        the_weatherdata.speed[3] = 1.0;
-    else if( the_weatherdata.speed[0] < 3.1 )
-        the_weatherdata.speed[3] = 2.0;
-    else if( the_weatherdata.speed[0] < 5.3 )
-        the_weatherdata.speed[3] = 3.0;
-    else if( the_weatherdata.speed[0] < 7.8 )
-        the_weatherdata.speed[3] = 4.0;
-    else if( the_weatherdata.speed[0] < 10.5 )
-        the_weatherdata.speed[3] = 5.0;
-    else if( the_weatherdata.speed[0] < 13.6 )
-        the_weatherdata.speed[3] = 6.0;
-    else if( the_weatherdata.speed[0] < 16.9 )
-        the_weatherdata.speed[3] = 7.0;
-    else if( the_weatherdata.speed[0] < 20.5 )
-        the_weatherdata.speed[3] = 8.0;
-    else if( the_weatherdata.speed[0] < 24.4 )
-        the_weatherdata.speed[3] = 9.0;
-    else if( the_weatherdata.speed[0] < 28.3 )
-        the_weatherdata.speed[3] = 10.0;
-    else if( the_weatherdata.speed[0] < 32.5 )
-        the_weatherdata.speed[3] = 11.0;
-    else if( the_weatherdata.speed[0] < 37.1 )
-        the_weatherdata.speed[3] = 12.0;
-    else if( the_weatherdata.speed[0] < 41.6 )
-        the_weatherdata.speed[3] = 13.0;
-    else if( the_weatherdata.speed[0] < 14.3 )
-        the_weatherdata.speed[3] = 14.0;
-    else if( the_weatherdata.speed[0] < 50.6 )
-        the_weatherdata.speed[3] = 15.0;
-    else if( the_weatherdata.speed[0] <= 56.1 )
-        the_weatherdata.speed[3] = 16.0;
+    p_station->weatherdata.temperature = 15.5;                                  // outdoor temperature
+    p_station->weatherdata.temperature_in = 17.4;                               // indoor temperature
+    p_station->weatherdata.humidity = 56;
+    p_station->weatherdata.humidity_in = 32;
+    p_station->weatherdata.dewpoint = 16.3;
+    p_station->weatherdata.speed[0] = 10;
+    p_station->weatherdata.direction = 275.0;
+    p_station->weatherdata.sensor_connected = 0;
+    p_station->weatherdata.speed[1] = p_station->weatherdata.speed[0] * KMH;
+    p_station->weatherdata.speed[2] = p_station->weatherdata.speed[0] * KNOTS;
+    if( p_station->weatherdata.speed[0] < 0.3 )
+        p_station->weatherdata.speed[3] = 0.0;
+    else if( p_station->weatherdata.speed[0] < 1.4 )
+        p_station->weatherdata.speed[3] = 1.0;
+    else if( p_station->weatherdata.speed[0] < 3.1 )
+        p_station->weatherdata.speed[3] = 2.0;
+    else if( p_station->weatherdata.speed[0] < 5.3 )
+        p_station->weatherdata.speed[3] = 3.0;
+    else if( p_station->weatherdata.speed[0] < 7.8 )
+        p_station->weatherdata.speed[3] = 4.0;
+    else if( p_station->weatherdata.speed[0] < 10.5 )
+        p_station->weatherdata.speed[3] = 5.0;
+    else if( p_station->weatherdata.speed[0] < 13.6 )
+        p_station->weatherdata.speed[3] = 6.0;
+    else if( p_station->weatherdata.speed[0] < 16.9 )
+        p_station->weatherdata.speed[3] = 7.0;
+    else if( p_station->weatherdata.speed[0] < 20.5 )
+        p_station->weatherdata.speed[3] = 8.0;
+    else if( p_station->weatherdata.speed[0] < 24.4 )
+        p_station->weatherdata.speed[3] = 9.0;
+    else if( p_station->weatherdata.speed[0] < 28.3 )
+        p_station->weatherdata.speed[3] = 10.0;
+    else if( p_station->weatherdata.speed[0] < 32.5 )
+        p_station->weatherdata.speed[3] = 11.0;
+    else if( p_station->weatherdata.speed[0] < 37.1 )
+        p_station->weatherdata.speed[3] = 12.0;
+    else if( p_station->weatherdata.speed[0] < 41.6 )
+        p_station->weatherdata.speed[3] = 13.0;
+    else if( p_station->weatherdata.speed[0] < 14.3 )
+        p_station->weatherdata.speed[3] = 14.0;
+    else if( p_station->weatherdata.speed[0] < 50.6 )
+        p_station->weatherdata.speed[3] = 15.0;
+    else if( p_station->weatherdata.speed[0] <= 56.1 )
+        p_station->weatherdata.speed[3] = 16.0;
     else
-        the_weatherdata.speed[3] = 17.0;
-    memcpy(&the_weatherdata.dir, directions[(int)(the_weatherdata.direction/22.5)], 4);
-    the_weatherdata.rain_per_hour = 0.0;                                        // mm or l/qm
-    the_weatherdata.rain_per_day = 0;                                           // mm or l/qm
-    the_weatherdata.pressure = 1005.0;
-    the_weatherdata.windchill = 3.8;
+        p_station->weatherdata.speed[3] = 17.0;
+    memcpy(&p_station->weatherdata.dir, directions[(int)(p_station->weatherdata.direction/22.5)], 4);
+    p_station->weatherdata.rain_per_hour = 0.0;                                 // mm or l/qm
+    p_station->weatherdata.rain_per_day = 0;                                    // mm or l/qm
+    p_station->weatherdata.pressure = 1005.0;
+    p_station->weatherdata.windchill = 3.8;
+    p_station->weatherdata.changed = CHG_ALL;
 #endif  // NIX
     debug(" %s \n", __func__);
 
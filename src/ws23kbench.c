@@ -0,0 +1,417 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kbench.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Measures how the readings scale with the number of stations
+
+    details     Reads 1, 2, .. n stations at once, each one in its own thread
+                like weather23k does with several configuration files. Every
+                thread calls ReadData() as often as it can and puts the
+                readings into a pipeline, one output thread takes them out.
+                The readings per second of all links together are printed
+                for each number of links.
+
+                The stations are the ports given on the command line, or
+                with -e n emulators started by the benchmark itself. Nothing
+                is served from the shadow, every reading goes over the link.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        With emulators paced at 2400 baud a link is busy all the
+                time, so the readings should grow with the number of links.
+                With -b 0 the machine's cpu is the limit.
+
+    todo
+
+*/
+
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "data.h"
+#include "pipeline.h"
+#include "sercom.h"
+#include "station.h"
+#include "ws23k.h"
+#include "ws23kcom.h"
+
+
+#define DEFAULT_SECONDS                         10
+#define DEFAULT_BAUD                            "2400"
+#define EMULATOR                                "weather23k-emu"
+
+
+typedef struct _bench
+    {
+    station_t * p_station;
+    pipeline_t * p_pipeline;
+    pthread_t thread;
+    } bench_t;
+
+
+typedef struct _output
+    {
+    pipeline_t * p_pipeline;
+    long readings;
+    unsigned long bytes;
+    } output_t;
+
+
+static volatile int the_stop = 0;                                               // ends the reader threads
+static pid_t the_emulators[STATIONS_MAX];
+static char the_links[STATIONS_MAX][64];
+
+
+/*  function        static void usage( void )
+
+    brief           Prints the command line help
+*/
+static void usage( void )
+    {
+    printf("\nweather23k-bench V%s (c) Uwe Jantzen (Klabautermann-Software) %s", VERSION, __DATE__);
+    printf("\n\nUsage:");
+    printf("\n        weather23k-bench [options] [<port> ...]");
+    printf("\nOptions:");
+    printf("\n        -t <seconds>  time for each number of links (default %d s)", DEFAULT_SECONDS);
+    printf("\n        -e <n>        start n emulators instead of using ports (at most %d)", STATIONS_MAX);
+    printf("\n        -b <baud>     baud rate of the emulators (default %s, 0 = no delay)", DEFAULT_BAUD);
+    printf("\n        -h            show this help");
+    printf("\n\n");
+    }
+
+
+/*  function        static int start_emulators( char const * path, int n, char const * baud )
+
+    brief           Starts n emulators and waits for their pseudo terminals
+
+    param[in]       char const * path, directory of the emulator program
+    param[in]       int n, number of emulators
+    param[in]       char const * baud, pace of the answers
+
+    return          int, number of emulators started
+*/
+static int start_emulators( char const * path, int n, char const * baud )
+    {
+    char program[256];
+    struct stat st;
+    int tries;
+    int i;
+
+    snprintf(program, sizeof(program), "%s/%s", path, EMULATOR);
+    for( i = 0; i < n; ++i )
+        {
+        snprintf(the_links[i], sizeof(the_links[i]), "/tmp/weather23k-bench-%d-%d", (int)getpid(), i);
+        the_emulators[i] = fork();
+        if( the_emulators[i] == 0 )
+            {
+            freopen("/dev/null", "w", stdout);
+            execl(program, EMULATOR, "-b", baud, "-l", the_links[i], (char *)0);
+            _exit(127);
+            }
+        if( the_emulators[i] < 0 )
+            break;
+        for( tries = 0; tries < 50 && lstat(the_links[i], &st) < 0; ++tries )
+            usleep(100000);
+        if( tries == 50 )
+            {
+            printf("Emulator %s did not start\n", program);
+            kill(the_emulators[i], SIGINT);
+            waitpid(the_emulators[i], 0, 0);
+            break;
+            }
+        }
+
+    return i;
+    }
+
+
+/*  function        static void stop_emulators( int n )
+
+    brief           Stops the emulators and removes their links
+
+    param[in]       int n, number of emulators
+*/
+static void stop_emulators( int n )
+    {
+    int i;
+
+    for( i = 0; i < n; ++i )
+        kill(the_emulators[i], SIGINT);
+    for( i = 0; i < n; ++i )
+        {
+        waitpid(the_emulators[i], 0, 0);
+        unlink(the_links[i]);
+        }
+    }
+
+
+/*  function        static void * reader_thread( void * p_arg )
+
+    brief           Reads a station until the_stop is set
+
+    param[in]       void * p_arg, bench_t *
+
+    return          void *, 0
+*/
+static void * reader_thread( void * p_arg )
+    {
+    bench_t * p_bench = p_arg;
+    station_t * p_station = p_bench->p_station;
+    reading_t reading;
+
+    memset(&reading, 0, sizeof(reading));
+    reading.p_station = p_station;
+    while( !the_stop )
+        {
+        time(&reading.time);
+        ReadData(p_station);
+        reading.data = p_station->weatherdata;
+        get_comm_stats(&p_station->link, &reading.stats);
+        pipeline_put(p_bench->p_pipeline, &reading);
+        }
+
+    return 0;
+    }
+
+
+/*  function        static void * output_thread( void * p_arg )
+
+    brief           Counts the readings and the bytes they took on the links
+
+    param[in]       void * p_arg, output_t *
+
+    return          void *, 0
+*/
+static void * output_thread( void * p_arg )
+    {
+    output_t * p_output = p_arg;
+    reading_t reading;
+
+    while( pipeline_get(p_output->p_pipeline, &reading) )
+        {
+        ++p_output->readings;
+        p_output->bytes += reading.stats.bytes_tx + reading.stats.bytes_rx;
+        }
+
+    return 0;
+    }
+
+
+/*  function        static ERRNO run( bench_t * benches, int links, int seconds )
+
+    brief           Reads a number of links at once for some time and prints
+                    the readings per second
+
+    param[in]       bench_t * benches
+    param[in]       int links, number of links read at once
+    param[in]       int seconds
+
+    return          ERRNO
+*/
+static ERRNO run( bench_t * benches, int links, int seconds )
+    {
+    pipeline_t pipeline;
+    output_t output;
+    pthread_t thread;
+    struct timespec start;
+    struct timespec end;
+    double elapsed;
+    long put;
+    long dropped;
+    int started;
+    ERRNO error;
+
+    error = pipeline_init(&pipeline);
+    if( error )
+        return error;
+    memset(&output, 0, sizeof(output));
+    output.p_pipeline = &pipeline;
+    if( pthread_create(&thread, 0, output_thread, &output) )
+        {
+        pipeline_deinit(&pipeline);
+        return ERR_THREAD;
+        }
+
+    the_stop = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for( started = 0; started < links; ++started )
+        {
+        benches[started].p_pipeline = &pipeline;
+        if( pthread_create(&benches[started].thread, 0, reader_thread, &benches[started]) )
+            {
+            error = ERR_THREAD;
+            break;
+            }
+        }
+    if( !error )
+        sleep(seconds);
+    the_stop = 1;
+    while( started > 0 )
+        pthread_join(benches[--started].thread, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pipeline_close(&pipeline);
+    pthread_join(thread, 0);
+
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    pipeline_stats(&pipeline, &put, &dropped);
+    if( !error )
+        printf("%5d  %8ld  %10.2f  %10.2f  %10.0f  %7ld\n", links, output.readings, output.readings / elapsed,
+            output.readings / elapsed / links, output.bytes / elapsed, dropped);
+    pipeline_deinit(&pipeline);
+
+    return error;
+    }
+
+
+/*  function        int main( int argc, char *argv[] )
+
+    brief           main function :
+                        reads arguments,
+                        starts the emulators or opens the ports
+                        reads 1 .. n links at once and prints the throughput
+
+    param[in]       int argc, number of command line parameters
+    param[in]       char *argv[], command line parameter list
+
+    return          int, error code
+*/
+int main( int argc, char *argv[] )
+    {
+    char * ports[STATIONS_MAX];
+    char path[256];
+    char * p_slash;
+    char const * baud = DEFAULT_BAUD;
+    bench_t benches[STATIONS_MAX];
+    int seconds = DEFAULT_SECONDS;
+    int emulators = 0;
+    int started = 0;
+    int n = 0;
+    int i;
+    ERRNO error = NOERR;
+
+    for( i = 1; i < argc; ++i )
+        {
+        if( argv[i][0] != '-' )
+            {
+            if( n >= STATIONS_MAX )
+                {
+                usage();
+                return 1;
+                }
+            ports[n++] = argv[i];
+            continue;
+            }
+        if( strlen(argv[i]) != 2 || argv[i][1] == 'h' || i + 1 >= argc )
+            {
+            usage();
+            return ( argv[i][1] == 'h' ) ? 0 : 1;
+            }
+        switch( argv[i][1] )
+            {
+            case 't' :
+                seconds = atoi(argv[++i]);
+                break;
+            case 'e' :
+                emulators = atoi(argv[++i]);
+                break;
+            case 'b' :
+                baud = argv[++i];
+                break;
+            default :
+                usage();
+                return 1;
+            }
+        }
+
+    if( emulators > 0 )
+        {
+        if( emulators > STATIONS_MAX - n )
+            emulators = STATIONS_MAX - n;
+        snprintf(path, sizeof(path), "%s", argv[0]);
+        p_slash = strrchr(path, '/');
+        if( p_slash )
+            *p_slash = 0;
+        else
+            strcpy(path, ".");
+        started = start_emulators(path, emulators, baud);
+        for( i = 0; i < started; ++i )
+            ports[n++] = the_links[i];
+        }
+    if( n == 0 || seconds <= 0 )
+        {
+        stop_emulators(started);
+        usage();
+        return 1;
+        }
+
+    memset(benches, 0, sizeof(benches));
+    for( i = 0; i < n && !error; ++i )
+        {
+        benches[i].p_station = calloc(1, sizeof(station_t));                    // the shadow is never used, ages are SHADOW_NEVER
+        if( !benches[i].p_station )
+            {
+            error = ERR_OUT_OF_MEMORY;
+            break;
+            }
+        error = link_init(&benches[i].p_station->link, ports[i]);
+        if( !error )
+            error = ws_open(&benches[i].p_station->link.port);
+        if( error )
+            printf("Serial port %s error : %d\n", ports[i], error);
+        }
+
+    if( !error )
+        {
+        printf("Links  Readings  Readings/s  per link/s     Bytes/s  Dropped\n");
+        for( i = 1; i <= n && !error; ++i )
+            error = run(benches, i, seconds);
+        if( error )
+            printf("Thread error : %d\n", error);
+        }
+
+    for( i = 0; i < n; ++i )
+        {
+        if( !benches[i].p_station )
+            continue;
+        if( benches[i].p_station->link.port.handle >= 0 )
+            ws_close(&benches[i].p_station->link.port);
+        ws_deinit(&benches[i].p_station->link.port);
+        free(benches[i].p_station);
+        }
+    stop_emulators(started);
+
+    return error;
+    }
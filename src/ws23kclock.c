@@ -0,0 +1,174 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+
+    file        ws23kclock.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Drift of the station's clock against the host's clock
+
+    details     The station's seconds are whole seconds, the station's second
+                may have begun up to one second before the host's time of
+                the reading. Half a second is added to each measurement so
+                the quantization error averages out to zero.
+
+                Until CLOCK_WEIGHT measurements are made the offset is the
+                plain mean, so the estimate settles after a few readings. If
+                the rate is known the offset is advanced by it before a new
+                measurement is weighted in.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note
+
+    todo
+
+*/
+
+
+#include <math.h>
+#include <string.h>
+#include "ws23kclock.h"
+
+
+#define SECONDS_PER_DAY                         86400.0
+
+
+/*  function        static double offset_at( clocksync_t const * p_clock, double host )
+
+    brief           Returns the expected offset at a host time
+
+    param[in]       clocksync_t const * p_clock
+    param[in]       double host, [s] host time
+
+    return          double, [s] station - host
+*/
+static double offset_at( clocksync_t const * p_clock, double host )
+    {
+    if( !p_clock->rated )
+        return p_clock->offset;
+
+    return p_clock->offset + p_clock->rate * ( host - p_clock->host ) / SECONDS_PER_DAY;
+    }
+
+
+/*  function        void clocksync_init( clocksync_t * p_clock )
+
+    brief           Clears the estimate
+
+    param[in]       clocksync_t * p_clock
+*/
+void clocksync_init( clocksync_t * p_clock )
+    {
+    memset(p_clock, 0, sizeof(*p_clock));
+    }
+
+
+/*  function        void clocksync_add( clocksync_t * p_clock, double host, time_t station )
+
+    brief           Adds a reading of the station's clock
+
+    param[in]       clocksync_t * p_clock
+    param[in]       double host, [s] CLOCK_REALTIME when the clock was read
+    param[in]       time_t station, the station's clock
+*/
+void clocksync_add( clocksync_t * p_clock, double host, time_t station )
+    {
+    double measured = (double)station + 0.5 - host;
+    double predicted;
+    double rate;
+    int weight;
+    int jumps;
+
+    if( p_clock->samples > 0 && fabs(measured - offset_at(p_clock, host)) > CLOCK_JUMP )
+        {
+        jumps = p_clock->jumps + 1;                                             // the clock was set, start anew
+        clocksync_init(p_clock);
+        p_clock->jumps = jumps;
+        }
+
+    p_clock->last = measured;
+    if( p_clock->samples == 0 )
+        p_clock->offset = measured;
+    else
+        {
+        predicted = offset_at(p_clock, host);
+        weight = ( p_clock->samples < CLOCK_WEIGHT ) ? p_clock->samples + 1 : CLOCK_WEIGHT;
+        p_clock->offset = predicted + ( measured - predicted ) / weight;
+        }
+    p_clock->host = host;
+    ++p_clock->samples;
+
+    if( p_clock->samples == CLOCK_WEIGHT )                                      // settled, the base of the rate
+        {
+        p_clock->base_host = host;
+        p_clock->base_offset = p_clock->offset;
+        }
+    else if( p_clock->samples > CLOCK_WEIGHT && host - p_clock->base_host >= CLOCK_RATE_BASE )
+        {
+        rate = ( p_clock->offset - p_clock->base_offset ) * SECONDS_PER_DAY / ( host - p_clock->base_host );
+        p_clock->rate = p_clock->rated ? p_clock->rate + ( rate - p_clock->rate ) / CLOCK_RATE_WEIGHT : rate;
+        p_clock->rated = 1;
+        p_clock->base_host = host;
+        p_clock->base_offset = p_clock->offset;
+        }
+    }
+
+
+/*  function        void clocksync_get( clocksync_t const * p_clock, clocksummary_t * p_summary )
+
+    brief           Returns the estimate
+
+    param[in]       clocksync_t const * p_clock
+    param[out]      clocksummary_t * p_summary
+*/
+void clocksync_get( clocksync_t const * p_clock, clocksummary_t * p_summary )
+    {
+    p_summary->samples = p_clock->samples;
+    p_summary->offset = p_clock->offset;
+    p_summary->rated = p_clock->rated;
+    p_summary->rate = p_clock->rate;
+    p_summary->jumps = p_clock->jumps;
+    }
+
+
+/*  function        time_t clocksync_to_host( clocksync_t const * p_clock, time_t station )
+
+    brief           Converts a time of the station's clock into host time
+
+    param[in]       clocksync_t const * p_clock
+    param[in]       time_t station, the station's clock
+
+    return          time_t, host time, station if the clock was not read yet
+*/
+time_t clocksync_to_host( clocksync_t const * p_clock, time_t station )
+    {
+    if( p_clock->samples == 0 )
+        return station;
+
+    return station - (time_t)floor(offset_at(p_clock, (double)station - p_clock->offset) + 0.5);
+    }
@@ -23,13 +23,40 @@
 
     file        ws23kcom.c
 
-    date        22.10.2017
+    date        17.10.2026
 
     author      Uwe Jantzen (jantzen@klabautermann-software.de)
 
     brief       Handle all access to WS2300 weather station
 
-    details     
+    details     The link to the station is kept in sync between telegrams. A
+                reset is only sent after the port was opened, after a failed
+                telegram or after a write.
+
+                The read planner collects the addresses needed by a caller and
+                merges neighbouring ones into as few 15 byte telegrams as
+                possible. The data of every requested field is then taken from
+                the buffered telegrams.
+
+                After link_load_image() all reads and writes are done on a
+                memory image as written by weather23k-dump instead of the
+                station, so every decoder can be used offline.
+
+                Without an image the same buffer is a shadow of the station's
+                memory. Every nibble read or written is kept together with
+                the time it was transferred. A field of a read plan is taken
+                from the shadow as long as all its nibbles are younger than
+                the age set by shadow_set_age(), only the other fields are
+                read from the station.
+
+                The state of a link is kept in a link_t of the caller
+                together with its serial port, so several stations can be
+                used at the same time.
+
+                A write plan collects the nibbles written by a caller. The
+                writes are merged into as few telegrams as possible, each
+                telegram is preceded by a reset, and all of them are verified
+                by a single read-back.
 
     project     weather23k
     target      Linux
@@ -46,10 +73,13 @@
 #include "sercom.h"
 #include "ws23kcom.h"
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 
 #define MAX_RETRIES                             50
+#define WPLAN_PASSES                            2                               // a write plan is sent once more if the read-back differs
 
 #define ACK_WRITE                               0x10
 #define ACK_SET                                 0x04
@@ -88,7 +118,7 @@ static uint8_t checksum_cmd( uint8_t cmd, int n )
     }
 
 
-/*  function        ERRNO reset( void )
+/*  function        ERRNO reset( link_t * p_link )
 
     brief           Reset WS2300 weather station by sending command 0x06.
 
@@ -99,9 +129,11 @@ static uint8_t checksum_cmd( uint8_t cmd, int n )
                     until all data is exhausted, if we got a two back at all, we
                     consider it a success.
 
+    param[in]       link_t * p_link
+
     return          ERRNO
 */
-static ERRNO reset( void )
+static ERRNO reset( link_t * p_link )
     {
     int i;
     uint8_t cmd = 0x06;
@@ -109,11 +141,14 @@ static ERRNO reset( void )
 
     for( i = 0; i < 100; ++i )
         {
-        ws_clear();
+        if( p_link->stop )                                                      // the retries may take minutes
+            return ERR_RESET_COMMUNICATION;
+
+        ws_clear(&p_link->port);
 
-        ws_write(&cmd, 1);
+        ws_write(&p_link->port, &cmd, 1);
 
-        while( ws_read(&dst, 1) == 1 )
+        while( ws_read(&p_link->port, &dst, 1) == 1 )
             {
             if( dst == 0x02 )
                 return NOERR;
@@ -127,18 +162,43 @@ static ERRNO reset( void )
     }
 
 
-/*  function        int perform_read( uint8_t * data, int addr, int n )
+/*  function        static ERRNO sync_link( link_t * p_link )
+
+    brief           Resets the station if the link is not known to be in sync.
+                    After a completely read telegram the station waits for the
+                    next address, so no reset is needed.
+
+    param[in]       link_t * p_link
+
+    return          ERRNO
+*/
+static ERRNO sync_link( link_t * p_link )
+    {
+    if( p_link->synced )
+        return NOERR;
+
+    ++p_link->stats.resyncs;
+    if( reset(p_link) != NOERR )
+        return ERR_RESET_COMMUNICATION;
+
+    p_link->synced = 1;
+    return NOERR;
+    }
+
+
+/*  function        int perform_read( link_t * p_link, uint8_t * data, int addr, int n )
 
     brief           Read a number of data from a given address into the buffer data using
                     the command cmd.
 
+    param[in]       link_t * p_link
     param[out]      uint8_t * data, buffer to read into
     param[in]       int addr, data array is starting here
     param[in]       int n, number of bytes to read
 
     return          int, number of bytes read
 */
-static int perform_read( uint8_t * data, int addr, int n )
+static int perform_read( link_t * p_link, uint8_t * data, int addr, int n )
     {
     uint8_t cmd[5];
     uint8_t dst;
@@ -152,18 +212,18 @@ static int perform_read( uint8_t * data, int addr, int n )
 
     for( i = 0; i < 4; ++i )
         {
-        if( ws_write(cmd + i, 1) != 1 )
+        if( ws_write(&p_link->port, cmd + i, 1) != 1 )
             return -1;
-        if( ws_read(&dst, 1) != 1 )
+        if( ws_read(&p_link->port, &dst, 1) != 1 )
             return -1;
         if( dst != checksum_cmd(cmd[i], i) )
             return -1;
         }
 
     // send the final command that asks for 'number' of bytes, check dst
-    if( ws_write(cmd + 4, 1) != 1 )
+    if( ws_write(&p_link->port, cmd + 4, 1) != 1 )
         return -1;
-    if( ws_read(&dst, 1) != 1 )
+    if( ws_read(&p_link->port, &dst, 1) != 1 )
         return -1;
     if( dst != (n + 0x30) )
         return -1;
@@ -171,12 +231,12 @@ static int perform_read( uint8_t * data, int addr, int n )
     // read the data bytes
     for( i = 0; i < n; ++i )
         {
-        if( ws_read(data + i, 1) != 1 )
+        if( ws_read(&p_link->port, data + i, 1) != 1 )
             return -1;
         }
 
     // read and verify checksum
-    if( ws_read(&dst, 1) != 1 )
+    if( ws_read(&p_link->port, &dst, 1) != 1 )
         return -1;
     for( i = 0; i < n; ++i )
         checksum += data[i];
@@ -189,38 +249,260 @@ static int perform_read( uint8_t * data, int addr, int n )
     }
 
 
-/*  function        int read_data( uint8_t * data, int addr, int n )
+/*  function        static uint8_t image_nibble( link_t * p_link, int addr )
+
+    brief           Gets a nibble of the memory image
+
+    param[in]       link_t * p_link
+    param[in]       int addr, nibble address
+
+    return          uint8_t, nibble
+*/
+static uint8_t image_nibble( link_t * p_link, int addr )
+    {
+    addr %= MEMORY_NIBBLES;
+    return ( addr & 1 ) ? p_link->image[addr / 2] >> 4 : p_link->image[addr / 2] & 0x0f;
+    }
+
+
+/*  function        static void image_set_nibble( link_t * p_link, int addr, uint8_t value )
+
+    brief           Sets a nibble of the memory image
+
+    param[in]       link_t * p_link
+    param[in]       int addr, nibble address
+    param[in]       uint8_t value, nibble
+*/
+static void image_set_nibble( link_t * p_link, int addr, uint8_t value )
+    {
+    addr %= MEMORY_NIBBLES;
+    if( addr & 1 )
+        p_link->image[addr / 2] = (uint8_t)((p_link->image[addr / 2] & 0x0f) | (value << 4));
+    else
+        p_link->image[addr / 2] = (uint8_t)((p_link->image[addr / 2] & 0xf0) | (value & 0x0f));
+    }
+
+
+/*  function        static int image_read( link_t * p_link, uint8_t * data, int addr, int n )
+
+    brief           Reads bytes from the memory image like perform_read()
+
+    param[in]       link_t * p_link
+    param[out]      uint8_t * data, buffer to read into
+    param[in]       int addr, read the data is starting here
+    param[in]       int n number of bytes to read
+
+    return          int, number of bytes read
+*/
+static int image_read( link_t * p_link, uint8_t * data, int addr, int n )
+    {
+    int i;
+
+    for( i = 0; i < n; ++i )
+        data[i] = (uint8_t)(image_nibble(p_link, addr + 2 * i) | (image_nibble(p_link, addr + 2 * i + 1) << 4));
+
+    return n;
+    }
+
+
+/*  function        static int image_write( link_t * p_link, uint8_t * data, int addr, int n, uint8_t enc_type )
+
+    brief           Writes nibbles or sets / clears bits in the memory image
+                    like perform_write()
+
+    param[in]       link_t * p_link
+    param[in]       uint8_t * data, nibbles or bit numbers
+    param[in]       int addr, write the data starting here
+    param[in]       int n, number of nibbles
+    param[in]       uint8_t enc_type
+
+    return          int, number of nibbles written
+*/
+static int image_write( link_t * p_link, uint8_t * data, int addr, int n, uint8_t enc_type )
+    {
+    int i;
+
+    for( i = 0; i < n; ++i )
+        {
+        if( enc_type == BIT_SET )
+            image_set_nibble(p_link, addr, image_nibble(p_link, addr) | (uint8_t)(1 << (data[i] & 3)));
+        else if( enc_type == BIT_CLEAR )
+            image_set_nibble(p_link, addr, image_nibble(p_link, addr) & (uint8_t)~(1 << (data[i] & 3)));
+        else
+            image_set_nibble(p_link, addr++, data[i]);
+        }
+
+    return n;
+    }
+
+
+/*  function        static long shadow_now( void )
+
+    brief           Returns the time used for the shadow
+
+    return          long, [s] monotonic time, never 0
+*/
+static long shadow_now( void )
+    {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long)now.tv_sec + 1;
+    }
+
+
+/*  function        static int shadow_fresh( link_t * p_link, int addr, int nibbles )
+
+    brief           Checks if a range of nibbles may be taken from the shadow
+
+    param[in]       link_t * p_link
+    param[in]       int addr, first nibble
+    param[in]       int nibbles, number of nibbles
+
+    return          int, 1 if all nibbles are valid and young enough
+*/
+static int shadow_fresh( link_t * p_link, int addr, int nibbles )
+    {
+    long now;
+    int a;
+    int i;
+
+    if( p_link->image_loaded )
+        return 1;
+
+    now = shadow_now();
+    for( i = 0; i < nibbles; ++i )
+        {
+        a = ( addr + i ) % MEMORY_NIBBLES;
+        if( p_link->shadow_age[a] == SHADOW_NEVER || p_link->shadow_time[a] == 0 )
+            return 0;
+        if( p_link->shadow_age[a] != SHADOW_FOREVER && now - p_link->shadow_time[a] >= p_link->shadow_age[a] )
+            return 0;
+        }
+
+    return 1;
+    }
+
+
+/*  function        static void shadow_store( link_t * p_link, uint8_t const * data, int addr, int n )
+
+    brief           Keeps bytes read from the station in the shadow
+
+    param[in]       link_t * p_link
+    param[in]       uint8_t const * data, bytes as read by perform_read()
+    param[in]       int addr, first nibble
+    param[in]       int n, number of bytes
+*/
+static void shadow_store( link_t * p_link, uint8_t const * data, int addr, int n )
+    {
+    long now = shadow_now();
+    int i;
+
+    for( i = 0; i < n; ++i )
+        {
+        image_set_nibble(p_link, addr + 2 * i, data[i] & 0x0f);
+        image_set_nibble(p_link, addr + 2 * i + 1, data[i] >> 4);
+        p_link->shadow_time[( addr + 2 * i ) % MEMORY_NIBBLES] = now;
+        p_link->shadow_time[( addr + 2 * i + 1 ) % MEMORY_NIBBLES] = now;
+        }
+    }
+
+
+/*  function        static void shadow_write( link_t * p_link, uint8_t const * data, int addr, int n, uint8_t enc_type )
+
+    brief           Updates the shadow after nibbles were written to the
+                    station, changed bits have to be read again
+
+    param[in]       link_t * p_link
+    param[in]       uint8_t const * data, nibbles or bit numbers
+    param[in]       int addr, first nibble
+    param[in]       int n, number of nibbles
+    param[in]       uint8_t enc_type
+*/
+static void shadow_write( link_t * p_link, uint8_t const * data, int addr, int n, uint8_t enc_type )
+    {
+    long now = shadow_now();
+    int i;
+
+    if( enc_type == BIT_SET || enc_type == BIT_CLEAR )
+        {
+        p_link->shadow_time[addr % MEMORY_NIBBLES] = 0;
+        return;
+        }
+
+    for( i = 0; i < n; ++i )
+        {
+        image_set_nibble(p_link, addr + i, data[i]);
+        p_link->shadow_time[( addr + i ) % MEMORY_NIBBLES] = now;
+        }
+    }
+
+
+/*  function        void shadow_set_age( link_t * p_link, int addr, int nibbles, int age )
+
+    brief           Sets how long a range of the shadow may be used instead of
+                    reading the station
+
+    param[in]       link_t * p_link
+    param[in]       int addr, first nibble
+    param[in]       int nibbles, number of nibbles
+    param[in]       int age, [s], SHADOW_NEVER or SHADOW_FOREVER
+*/
+void shadow_set_age( link_t * p_link, int addr, int nibbles, int age )
+    {
+    int i;
+
+    for( i = 0; i < nibbles; ++i )
+        p_link->shadow_age[( addr + i ) % MEMORY_NIBBLES] = age;
+    }
+
+
+/*  function        int read_data( link_t * p_link, uint8_t * data, int addr, int n )
 
     brief           Read a number of data from a given address into the buffer data using
                     the command cmd. Retry until all data is read or max retries are done.
 
+    param[in]       link_t * p_link
     param[out]      uint8_t * data, buffer to read into
     param[in]       int addr, read the data is starting here
     param[in]       int n number of bytes to read
 
     return          int, number of bytes read
 */
-int read_data( uint8_t * data, int addr, int n )
+int read_data( link_t * p_link, uint8_t * data, int addr, int n )
     {
     int i;
 
-    for( i = 0; i < MAX_RETRIES; ++i )
+    if( p_link->image_loaded )
+        return image_read(p_link, data, addr, n);
+
+    for( i = 0; i < MAX_RETRIES && !p_link->stop; ++i )
         {
-        if( reset() != NOERR )
+        if( sync_link(p_link) != NOERR )
             return ERR_RESET_COMMUNICATION;
 
-        if( perform_read(data, addr, n) == n )                                  // read the data, if expected number of bytes read break out of loop
+        ++p_link->stats.transactions;
+        if( i > 0 )
+            ++p_link->stats.retries;
+
+        if( perform_read(p_link, data, addr, n) == n )                          // read the data, if expected number of bytes read break out of loop
+            {
+            shadow_store(p_link, data, addr, n);
             return n;
+            }
+
+        p_link->synced = 0;                                                     // checksum or echo failed
         }
 
     return -1;                                                                  // could not get enough data
     }
 
 
-/*  function        int perform_write( uint8_t * data, int addr, int n, uint8_t enc_type )
+/*  function        int perform_write( link_t * p_link, uint8_t * data, int addr, int n, uint8_t enc_type )
 
     brief           Write a number of bytes to the WS2300 weather station.
 
+    param[in]       link_t * p_link
     param[in]       uint8_t * data, buffer to write out
     param[in]       int addr, read the data from here
     param[in]       int n, number of bytes to read
@@ -228,7 +510,7 @@ int read_data( uint8_t * data, int addr, int n )
 
     return          int, number of bytes written
 */
-static int perform_write( uint8_t * data, int addr, int n, uint8_t enc_type )
+static int perform_write( link_t * p_link, uint8_t * data, int addr, int n, uint8_t enc_type )
     {
     uint8_t dst;
     uint8_t src[80];
@@ -247,9 +529,9 @@ static int perform_write( uint8_t * data, int addr, int n, uint8_t enc_type )
 
     for( i = 0; i < 4; ++i )                                                    // Write the 4 address bytes
         {
-        if( ws_write(cmd + i, 1) != 1 )
+        if( ws_write(&p_link->port, cmd + i, 1) != 1 )
             return -1;
-        if( ws_read(&dst, 1) != 1 )
+        if( ws_read(&p_link->port, &dst, 1) != 1 )
             return -1;
         if( dst != checksum_cmd(cmd[i], i) )
             return -1;
@@ -257,24 +539,24 @@ static int perform_write( uint8_t * data, int addr, int n, uint8_t enc_type )
 
     for( i = 0; i < n; ++i )                                                    // Write the data nibbles or set/unset the bits
         {
-        if( ws_write(src + i, 1) != 1 )
+        if( ws_write(&p_link->port, src + i, 1) != 1 )
             return -1;
-        if( ws_read(&dst, 1) != 1 )
+        if( ws_read(&p_link->port, &dst, 1) != 1 )
             return -1;
         if( dst != (data[i] + ack) )
             return -1;
-        cmd[i + 4] = src[i];
         }
 
     return i;
     }
 
 
-/*  function        int write_data( uint8_t * data, int addr, int n, uint8_t enc_type )
+/*  function        int write_data( link_t * p_link, uint8_t * data, int addr, int n, uint8_t enc_type )
 
     brief           Write a number of bytes to the WS2300 weather station until all
                     bytes are written or max retires are done.
 
+    param[in]       link_t * p_link
     param[in]       uint8_t * data, buffer to write out
     param[in]       int addr, read the data from here
     param[in]       int n, number of bytes to read
@@ -282,34 +564,760 @@ static int perform_write( uint8_t * data, int addr, int n, uint8_t enc_type )
 
     return          int, number of bytes written
 */
-int write_data( uint8_t * data, int addr, int n, uint8_t enc_type )
+int write_data( link_t * p_link, uint8_t * data, int addr, int n, uint8_t enc_type )
     {
     int i;
 
-    for( i = 0; i < MAX_RETRIES; ++i )
+    if( p_link->image_loaded )
+        return image_write(p_link, data, addr, n, enc_type);
+
+    for( i = 0; i < MAX_RETRIES && !p_link->stop; ++i )
         {
-        if( reset() != NOERR )
+        if( sync_link(p_link) != NOERR )
             return ERR_RESET_COMMUNICATION;
 
-        if( perform_write(data, addr, n, enc_type) == n )                       // write the data, If all data written break out of loop
+        ++p_link->stats.transactions;
+        if( i > 0 )
+            ++p_link->stats.retries;
+
+        p_link->synced = 0;                                                     // a write has no end marker, the next telegram needs a reset
+        if( perform_write(p_link, data, addr, n, enc_type) == n )               // write the data, If all data written break out of loop
+            {
+            shadow_write(p_link, data, addr, n, enc_type);
             return n;
+            }
         }
     
     return -1;                                                                  // could not write all data
     }
 
 
-/*  function        void handle_comm_error( ERRNO err )
+/*  function        void handle_comm_error( link_t * p_link, ERRNO err )
 
     brief           Closes and reopens the connection to the weather station
 
+    param[in]       link_t * p_link
     param[in]       ERRNO err, to show the error
 */
-void handle_comm_error( ERRNO err )
+void handle_comm_error( link_t * p_link, ERRNO err )
     {
     error(err);
-    
-    ws_close();
+
+    if( p_link->image_loaded )                                                  // no port to reopen
+        return;
+
+    ws_close(&p_link->port);
     usleep(8000);
-    ws_open();
+    ws_open(&p_link->port);
+    link_invalidate(p_link);
+    }
+
+
+/*  function        ERRNO link_init( link_t * p_link, char * port )
+
+    brief           Initializes the link to the station at the serial port,
+                    the port is not opened and the shadow is empty
+
+    param[out]      link_t * p_link
+    param[in]       char * port, device name like /dev/ttyS0
+
+    return          ERRNO
+*/
+ERRNO link_init( link_t * p_link, char * port )
+    {
+    memset(p_link, 0, sizeof(*p_link));                                         // shadow ages SHADOW_NEVER
+
+    return ws_init(&p_link->port, port);
+    }
+
+
+/*  function        void link_invalidate( link_t * p_link )
+
+    brief           Forces a reset before the next telegram, has to be called
+                    whenever the port was (re)opened
+
+    param[in]       link_t * p_link
+*/
+void link_invalidate( link_t * p_link )
+    {
+    p_link->synced = 0;
+    }
+
+
+/*  function        void link_stop( link_t * p_link )
+
+    brief           Ends the retries of the link, all following telegrams fail
+                    at once. May be called from another thread.
+
+    param[in]       link_t * p_link
+*/
+void link_stop( link_t * p_link )
+    {
+    p_link->stop = 1;
+    }
+
+
+/*  function        ERRNO link_load_image( link_t * p_link, char const * name )
+
+    brief           Loads a memory image as written by weather23k-dump, all
+                    following reads and writes use this image instead of the
+                    station
+
+    param[in]       link_t * p_link
+    param[in]       char const * name, file name
+
+    return          ERRNO
+*/
+ERRNO link_load_image( link_t * p_link, char const * name )
+    {
+    FILE * p_file;
+    size_t n;
+
+    p_file = fopen(name, "rb");
+    if( !p_file )
+        return ERR_OPEN_FILE;
+
+    memset(p_link->image, 0, sizeof(p_link->image));
+    n = fread(p_link->image, 1, sizeof(p_link->image), p_file);
+    fclose(p_file);
+    if( n != sizeof(p_link->image) )
+        return ERR_EOF;
+
+    p_link->image_loaded = 1;
+    return NOERR;
+    }
+
+
+/*  function        uint8_t const * link_image( link_t * p_link )
+
+    brief           Returns the loaded memory image, it can be decoded directly
+                    with the map_xxx() functions using base address 0
+
+    param[in]       link_t * p_link
+
+    return          uint8_t const *, IMAGE_BYTES bytes or 0 if no image is loaded
+*/
+uint8_t const * link_image( link_t * p_link )
+    {
+    return p_link->image_loaded ? p_link->image : 0;
+    }
+
+
+/*  function        void plan_clear( readplan_t * p_plan )
+
+    brief           Removes all fields and telegrams from a read plan
+
+    param[out]      readplan_t * p_plan
+*/
+void plan_clear( readplan_t * p_plan )
+    {
+    p_plan->n_fields = 0;
+    p_plan->n_windows = 0;
+    p_plan->p_link = 0;
+    p_plan->p_hashes = 0;
+    }
+
+
+/*  function        void plan_compare( readplan_t * p_plan, winhash_t * p_hashes )
+
+    brief           Lets plan_read() compare every telegram with the same
+                    telegram of the last read that used p_hashes, the caller
+                    may skip decoding the fields of unchanged telegrams
+                    p_hashes has to be zeroed before its first use and must
+                    not be shared by callers that decode different fields
+
+    param[in,out]   readplan_t * p_plan
+    param[in,out]   winhash_t * p_hashes
+*/
+void plan_compare( readplan_t * p_plan, winhash_t * p_hashes )
+    {
+    p_plan->p_hashes = p_hashes;
+    }
+
+
+/*  function        int plan_add( readplan_t * p_plan, int addr, int n )
+
+    brief           Adds a field to a read plan
+
+    param[out]      readplan_t * p_plan
+    param[in]       int addr, the field is starting here
+    param[in]       int n, number of bytes to read
+
+    return          int, index of the field or -1 if the plan is full
+*/
+int plan_add( readplan_t * p_plan, int addr, int n )
+    {
+    if( p_plan->n_fields >= PLAN_MAX_FIELDS || n < 1 || n > PLAN_WINDOW_BYTES )
+        return -1;
+
+    p_plan->field_addr[p_plan->n_fields] = addr;
+    p_plan->field_bytes[p_plan->n_fields] = n;
+
+    return p_plan->n_fields++;
+    }
+
+
+/*  function        static int plan_build( link_t * p_link, readplan_t * p_plan )
+
+    brief           Sorts the fields by address and merges them into the fewest
+                    telegrams of at most 15 bytes. The fields are sorted in place,
+                    so field indices are not valid any longer. Fields with a
+                    fresh shadow get no telegram.
+
+    param[in]       link_t * p_link
+    param[in,out]   readplan_t * p_plan
+
+    return          int, number of fields that did not fit into
+                    PLAN_MAX_WINDOWS telegrams, they are not available
+*/
+static int plan_build( link_t * p_link, readplan_t * p_plan )
+    {
+    int i;
+    int j;
+    int addr;
+    int n;
+    int end;
+    int w_addr = 0;
+    int w_end = 0;
+    int lost = 0;
+
+    for( i = 1; i < p_plan->n_fields; ++i )                                     // insertion sort, there are only a few fields
+        {
+        addr = p_plan->field_addr[i];
+        n = p_plan->field_bytes[i];
+        for( j = i; j > 0 && p_plan->field_addr[j - 1] > addr; --j )
+            {
+            p_plan->field_addr[j] = p_plan->field_addr[j - 1];
+            p_plan->field_bytes[j] = p_plan->field_bytes[j - 1];
+            }
+        p_plan->field_addr[j] = addr;
+        p_plan->field_bytes[j] = n;
+        }
+
+    p_plan->n_windows = 0;
+    for( i = 0; i < p_plan->n_fields; ++i )
+        {
+        addr = p_plan->field_addr[i];
+        end = addr + 2 * p_plan->field_bytes[i];                                // first nibble behind the field
+
+        p_plan->field_cached[i] = shadow_fresh(p_link, addr, end - addr);
+        if( p_plan->field_cached[i] )
+            continue;
+
+        if( p_plan->n_windows > 0 && end <= w_addr + 2 * PLAN_WINDOW_BYTES )    // fits into the current telegram
+            {
+            if( end > w_end )
+                w_end = end;
+            }
+        else
+            {
+            if( p_plan->n_windows >= PLAN_MAX_WINDOWS )
+                {
+                ++lost;                                                         // neither read nor cached, plan_get() fails
+                continue;
+                }
+            w_addr = addr;
+            w_end = end;
+            ++p_plan->n_windows;
+            }
+        p_plan->window_addr[p_plan->n_windows - 1] = w_addr;
+        p_plan->window_bytes[p_plan->n_windows - 1] = (w_end - w_addr + 1) / 2;
+        p_plan->window_ok[p_plan->n_windows - 1] = 0;
+        }
+
+    return lost;
+    }
+
+
+/*  function        static int window_changed( winhash_t * p_hashes, int addr, uint8_t const * data, int n )
+
+    brief           Compares a telegram with the last one read from the same
+                    address and remembers it for the next time
+
+    param[in,out]   winhash_t * p_hashes
+    param[in]       int addr, nibble address of the telegram
+    param[in]       uint8_t const * data, bytes read
+    param[in]       int n, number of bytes
+
+    return          int, 0 : the same bytes as the last time, 1 : changed or new
+*/
+static int window_changed( winhash_t * p_hashes, int addr, uint8_t const * data, int n )
+    {
+    uint32_t hash = 2166136261u;                                                // FNV-1a, 32 bit
+    int i;
+
+    for( i = 0; i < n; ++i )
+        hash = ( hash ^ data[i] ) * 16777619u;
+
+    for( i = 0; i < p_hashes->n; ++i )
+        {
+        if( p_hashes->addr[i] == addr && p_hashes->bytes[i] == n )
+            break;
+        }
+    if( i < p_hashes->n && p_hashes->hash[i] == hash )
+        return 0;
+
+    if( i == p_hashes->n )                                                      // a new telegram
+        {
+        if( p_hashes->n < PLAN_HASHES )
+            ++p_hashes->n;
+        else
+            {
+            i = p_hashes->next;
+            p_hashes->next = ( p_hashes->next + 1 ) % PLAN_HASHES;
+            }
+        p_hashes->addr[i] = addr;
+        p_hashes->bytes[i] = n;
+        }
+    p_hashes->hash[i] = hash;
+    return 1;
+    }
+
+
+/*  function        ERRNO plan_read( link_t * p_link, readplan_t * p_plan )
+
+    brief           Reads all fields of a read plan from the weather station
+                    using as few telegrams as possible, fields with a fresh
+                    shadow are not read
+
+    param[in]       link_t * p_link
+    param[in,out]   readplan_t * p_plan
+
+    return          ERRNO, ERR_COMM_READ if at least one telegram failed or
+                    the fields did not fit into the plan's telegrams
+*/
+ERRNO plan_read( link_t * p_link, readplan_t * p_plan )
+    {
+    struct timespec now;
+    int i;
+    ERRNO error = NOERR;
+
+    p_plan->p_link = p_link;
+    if( plan_build(p_link, p_plan) )
+        error = ERR_COMM_READ;
+
+    for( i = 0; i < p_plan->n_fields; ++i )
+        {
+        if( p_plan->field_cached[i] )
+            ++p_link->stats.cache_hits;
+        else
+            ++p_link->stats.cache_misses;
+        }
+
+    for( i = 0; i < p_plan->n_windows; ++i )
+        {
+        if( read_data(p_link, p_plan->window_data[i], p_plan->window_addr[i], p_plan->window_bytes[i]) == p_plan->window_bytes[i] )
+            {
+            clock_gettime(CLOCK_REALTIME, &now);
+            p_plan->window_ok[i] = 1;
+            p_plan->window_time[i] = now.tv_sec + now.tv_nsec / 1e9;
+            p_plan->window_changed[i] = p_plan->p_hashes ? window_changed(p_plan->p_hashes, p_plan->window_addr[i],
+                p_plan->window_data[i], p_plan->window_bytes[i]) : 1;
+            if( !p_plan->window_changed[i] )
+                ++p_link->stats.windows_unchanged;
+            }
+        else
+            error = ERR_COMM_READ;
+        }
+
+    return error;
+    }
+
+
+/*  function        int plan_get( readplan_t const * p_plan, uint8_t * data, int addr, int n )
+
+    brief           Copies a field from the telegrams read by plan_read() into
+                    data as if it was read by read_data(data, addr, n)
+
+    param[in]       readplan_t const * p_plan
+    param[out]      uint8_t * data, buffer to copy into
+    param[in]       int addr, the field is starting here
+    param[in]       int n, number of bytes to copy
+
+    return          int, number of bytes copied or -1 if the field is not available
+*/
+int plan_get( readplan_t const * p_plan, uint8_t * data, int addr, int n )
+    {
+    int i;
+    int j;
+    int offset;
+    uint8_t const * src;
+
+    for( i = 0; i < p_plan->n_windows; ++i )
+        {
+        offset = addr - p_plan->window_addr[i];                                 // nibble offset into the telegram
+        if( offset < 0 || offset + 2 * n > 2 * p_plan->window_bytes[i] )
+            continue;
+        if( !p_plan->window_ok[i] )
+            return -1;
+
+        src = p_plan->window_data[i];
+        if( (offset & 1) == 0 )
+            memcpy(data, src + offset / 2, n);
+        else                                                                    // field starts at a high nibble
+            {
+            for( j = 0; j < n; ++j )
+                data[j] = (uint8_t)((src[(offset + 1) / 2 + j - 1] >> 4) | ((src[(offset + 1) / 2 + j] & 0x0f) << 4));
+            }
+        return n;
+        }
+
+    for( i = 0; i < p_plan->n_fields; ++i )                                     // not read, may be in the shadow
+        {
+        offset = addr - p_plan->field_addr[i];
+        if( p_plan->field_cached[i] && offset >= 0 && offset + 2 * n <= 2 * p_plan->field_bytes[i] )
+            return image_read(p_plan->p_link, data, addr, n);
+        }
+
+    return -1;
+    }
+
+
+/*  function        int plan_changed( readplan_t const * p_plan, int addr, int n )
+
+    brief           Tells whether a field read by plan_read() may differ from
+                    the last read, see plan_compare()
+
+    param[in]       readplan_t const * p_plan
+    param[in]       int addr, the field is starting here
+    param[in]       int n, number of bytes
+
+    return          int, 0 : unchanged, 1 : changed or served from the shadow,
+                    -1 : the field is not available
+*/
+int plan_changed( readplan_t const * p_plan, int addr, int n )
+    {
+    int i;
+    int offset;
+
+    for( i = 0; i < p_plan->n_windows; ++i )
+        {
+        offset = addr - p_plan->window_addr[i];
+        if( offset < 0 || offset + 2 * n > 2 * p_plan->window_bytes[i] )
+            continue;
+        if( !p_plan->window_ok[i] )
+            return -1;
+        return p_plan->window_changed[i];
+        }
+
+    for( i = 0; i < p_plan->n_fields; ++i )                                     // the shadow may have been read by somebody else
+        {
+        offset = addr - p_plan->field_addr[i];
+        if( p_plan->field_cached[i] && offset >= 0 && offset + 2 * n <= 2 * p_plan->field_bytes[i] )
+            return 1;
+        }
+
+    return -1;
+    }
+
+
+/*  function        double plan_time( readplan_t const * p_plan, int addr, int n )
+
+    brief           Tells when a field was read by plan_read()
+
+    param[in]       readplan_t const * p_plan
+    param[in]       int addr, the field is starting here
+    param[in]       int n, number of bytes
+
+    return          double, [s] CLOCK_REALTIME at the end of the telegram, 0 if
+                    the field was not read from the station
+*/
+double plan_time( readplan_t const * p_plan, int addr, int n )
+    {
+    int i;
+    int offset;
+
+    for( i = 0; i < p_plan->n_windows; ++i )
+        {
+        offset = addr - p_plan->window_addr[i];
+        if( offset >= 0 && offset + 2 * n <= 2 * p_plan->window_bytes[i] )
+            return p_plan->window_ok[i] ? p_plan->window_time[i] : 0.0;
+        }
+
+    return 0.0;
+    }
+
+
+/*  function        void wplan_clear( writeplan_t * p_plan )
+
+    brief           Removes all writes from a write plan
+
+    param[out]      writeplan_t * p_plan
+*/
+void wplan_clear( writeplan_t * p_plan )
+    {
+    p_plan->n_writes = 0;
+    p_plan->n_nibbles = 0;
+    }
+
+
+/*  function        int wplan_add( writeplan_t * p_plan, int addr, uint8_t const * nibbles, int n )
+
+    brief           Adds nibbles to be written to a write plan, nothing is sent
+                    before wplan_write()
+
+    param[out]      writeplan_t * p_plan
+    param[in]       int addr, write the nibbles starting here
+    param[in]       uint8_t const * nibbles, one nibble per byte
+    param[in]       int n, number of nibbles
+
+    return          int, index of the write or -1 if the plan is full
+*/
+int wplan_add( writeplan_t * p_plan, int addr, uint8_t const * nibbles, int n )
+    {
+    int i;
+
+    if( p_plan->n_writes >= WPLAN_MAX_WRITES || n < 1 || n > WPLAN_RUN_NIBBLES || p_plan->n_nibbles + n > WPLAN_MAX_NIBBLES )
+        return -1;
+
+    p_plan->write_addr[p_plan->n_writes] = addr;
+    p_plan->write_nibbles[p_plan->n_writes] = n;
+    p_plan->write_offset[p_plan->n_writes] = p_plan->n_nibbles;
+    p_plan->write_ok[p_plan->n_writes] = 0;
+    for( i = 0; i < n; ++i )
+        p_plan->data[p_plan->n_nibbles++] = nibbles[i] & 0x0f;
+
+    return p_plan->n_writes++;
+    }
+
+
+/*  function        static void wplan_build( writeplan_t * p_plan )
+
+    brief           Sorts the writes by address and merges adjoining ones into
+                    single telegrams of at most WPLAN_RUN_NIBBLES nibbles. The
+                    writes are sorted in place, so indices are not valid any
+                    longer.
+
+    param[in,out]   writeplan_t * p_plan
+*/
+static void wplan_build( writeplan_t * p_plan )
+    {
+    uint8_t data[WPLAN_MAX_NIBBLES];
+    int addr[WPLAN_MAX_WRITES];
+    int nibbles[WPLAN_MAX_WRITES];
+    int offset[WPLAN_MAX_WRITES];
+    int order[WPLAN_MAX_WRITES];
+    int n_writes = p_plan->n_writes;
+    int used = 0;
+    int i;
+    int j;
+    int k;
+
+    memcpy(addr, p_plan->write_addr, sizeof(addr));
+    memcpy(nibbles, p_plan->write_nibbles, sizeof(nibbles));
+    memcpy(offset, p_plan->write_offset, sizeof(offset));
+
+    for( i = 0; i < n_writes; ++i )                                             // insertion sort, there are only a few writes
+        {
+        for( j = i; j > 0 && addr[order[j - 1]] > addr[i]; --j )
+            order[j] = order[j - 1];
+        order[j] = i;
+        }
+
+    p_plan->n_writes = 0;
+    for( k = 0; k < n_writes; ++k )
+        {
+        i = order[k];
+        j = p_plan->n_writes - 1;
+        if( j >= 0 && addr[i] == p_plan->write_addr[j] + p_plan->write_nibbles[j]
+            && p_plan->write_nibbles[j] + nibbles[i] <= WPLAN_RUN_NIBBLES )     // continues the last telegram
+            p_plan->write_nibbles[j] += nibbles[i];
+        else
+            {
+            j = p_plan->n_writes++;
+            p_plan->write_addr[j] = addr[i];
+            p_plan->write_nibbles[j] = nibbles[i];
+            p_plan->write_offset[j] = used;
+            p_plan->write_ok[j] = 0;
+            }
+        memcpy(data + used, p_plan->data + offset[i], nibbles[i]);
+        used += nibbles[i];
+        }
+
+    memcpy(p_plan->data, data, used);
+    }
+
+
+/*  function        static int wplan_send( link_t * p_link, uint8_t * data, int addr, int n )
+
+    brief           Writes a telegram of a write plan. Like write_data() the
+                    link is reset before the next telegram, a write has no
+                    end marker and the station may still be in write mode.
+
+    param[in]       link_t * p_link
+    param[in]       uint8_t * data, nibbles to write
+    param[in]       int addr, write the data starting here
+    param[in]       int n, number of nibbles
+
+    return          int, number of nibbles written
+*/
+static int wplan_send( link_t * p_link, uint8_t * data, int addr, int n )
+    {
+    int i;
+
+    for( i = 0; i < MAX_RETRIES && !p_link->stop; ++i )
+        {
+        if( sync_link(p_link) != NOERR )
+            return ERR_RESET_COMMUNICATION;
+
+        ++p_link->stats.transactions;
+        if( i > 0 )
+            ++p_link->stats.retries;
+
+        p_link->synced = 0;                                                     // a write has no end marker, the next telegram needs a reset
+        if( perform_write(p_link, data, addr, n, WRITE_NIBBLE) == n )
+            return n;
+        }
+
+    return -1;
+    }
+
+
+/*  function        static int wplan_verify( link_t * p_link, writeplan_t * p_plan )
+
+    brief           Reads back all writes not verified yet with as few
+                    telegrams as possible and compares them with the plan
+
+    param[in]       link_t * p_link
+    param[in,out]   writeplan_t * p_plan
+
+    return          int, number of writes that don't match
+*/
+static int wplan_verify( link_t * p_link, writeplan_t * p_plan )
+    {
+    readplan_t plan;
+    uint8_t bytes[WPLAN_RUN_NIBBLES / 2 + 1];
+    int first = 0;
+    int last;
+    int windows;
+    int start;
+    int n;
+    int o;
+    int a;
+    int i;
+    int failed = 0;
+
+    while( first < p_plan->n_writes )
+        {
+        plan_clear(&plan);
+        windows = 0;
+        for( last = first; last < p_plan->n_writes; ++last )                    // as many writes as fit into one read plan
+            {
+            if( p_plan->write_ok[last] )
+                continue;
+
+            start = p_plan->write_addr[last] & ~1;                              // telegrams start at an even address
+            n = ( p_plan->write_addr[last] + p_plan->write_nibbles[last] - start + 1 ) / 2;
+            if( windows + ( n + PLAN_WINDOW_BYTES - 1 ) / PLAN_WINDOW_BYTES > PLAN_MAX_WINDOWS )
+                break;
+            windows += ( n + PLAN_WINDOW_BYTES - 1 ) / PLAN_WINDOW_BYTES;
+
+            for( i = 0; i < p_plan->write_nibbles[last]; ++i )                  // the shadow must not answer
+                p_link->shadow_time[( p_plan->write_addr[last] + i ) % MEMORY_NIBBLES] = 0;
+            for( o = 0; o < n; o += PLAN_WINDOW_BYTES )
+                plan_add(&plan, start + 2 * o, ( n - o < PLAN_WINDOW_BYTES ) ? n - o : PLAN_WINDOW_BYTES);
+            }
+
+        plan_read(p_link, &plan);                                               // failed telegrams are found by plan_get()
+
+        for( ; first < last; ++first )
+            {
+            if( p_plan->write_ok[first] )
+                continue;
+
+            start = p_plan->write_addr[first] & ~1;
+            n = ( p_plan->write_addr[first] + p_plan->write_nibbles[first] - start + 1 ) / 2;
+            p_plan->write_ok[first] = 1;
+            for( o = 0; o < n; o += PLAN_WINDOW_BYTES )
+                {
+                if( plan_get(&plan, bytes + o, start + 2 * o, ( n - o < PLAN_WINDOW_BYTES ) ? n - o : PLAN_WINDOW_BYTES) < 0 )
+                    p_plan->write_ok[first] = 0;
+                }
+            for( i = 0; p_plan->write_ok[first] && i < p_plan->write_nibbles[first]; ++i )
+                {
+                a = p_plan->write_addr[first] + i - start;
+                if( ( ( bytes[a / 2] >> ( ( a & 1 ) * 4 ) ) & 0x0f ) != p_plan->data[p_plan->write_offset[first] + i] )
+                    p_plan->write_ok[first] = 0;
+                }
+            if( !p_plan->write_ok[first] )
+                {
+                debug("Write verification failed at 0x%04x\n", p_plan->write_addr[first]);
+                ++failed;
+                }
+            }
+        }
+
+    return failed;
+    }
+
+
+/*  function        ERRNO wplan_write( link_t * p_link, writeplan_t * p_plan )
+
+    brief           Writes all nibbles of a write plan as one transaction :
+                    adjoining writes are merged into as few telegrams as
+                    possible, then everything is read back at once.
+                    Writes that don't match are sent and verified once more.
+
+    param[in]       link_t * p_link
+    param[in,out]   writeplan_t * p_plan
+
+    return          ERRNO, ERR_COMM_WRITE if not all writes could be verified
+*/
+ERRNO wplan_write( link_t * p_link, writeplan_t * p_plan )
+    {
+    int pass;
+    int i;
+
+    if( p_link->image_loaded )
+        {
+        for( i = 0; i < p_plan->n_writes; ++i )
+            image_write(p_link, p_plan->data + p_plan->write_offset[i], p_plan->write_addr[i], p_plan->write_nibbles[i], WRITE_NIBBLE);
+        return NOERR;
+        }
+
+    wplan_build(p_plan);
+
+    for( pass = 0; pass < WPLAN_PASSES; ++pass )
+        {
+        for( i = 0; i < p_plan->n_writes; ++i )
+            {
+            if( p_plan->write_ok[i] )
+                continue;
+            if( wplan_send(p_link, p_plan->data + p_plan->write_offset[i], p_plan->write_addr[i], p_plan->write_nibbles[i]) != p_plan->write_nibbles[i] )
+                return ERR_COMM_WRITE;
+            }
+
+        if( wplan_verify(p_link, p_plan) == 0 )                                 // the read-back is kept in the shadow
+            return NOERR;
+        }
+
+    return ERR_COMM_WRITE;
+    }
+
+
+/*  function        void get_comm_stats( link_t * p_link, commstat_t * p_stats )
+
+    brief           Returns the number of telegrams and bytes exchanged with the
+                    weather station since the last call of clear_comm_stats()
+
+    param[in]       link_t * p_link
+    param[out]      commstat_t * p_stats
+*/
+void get_comm_stats( link_t * p_link, commstat_t * p_stats )
+    {
+    *p_stats = p_link->stats;
+    ws_counters(&p_link->port, &p_stats->bytes_tx, &p_stats->bytes_rx);
+    }
+
+
+/*  function        void clear_comm_stats( link_t * p_link )
+
+    brief           Sets all communication statistics to zero
+
+    param[in]       link_t * p_link
+*/
+void clear_comm_stats( link_t * p_link )
+    {
+    memset(&p_link->stats, 0, sizeof(p_link->stats));
+    ws_clear_counters(&p_link->port);
     }
@@ -0,0 +1,268 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kdump.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Dumps the whole memory of a WS2300 weather station
+
+    details     Reads the nibbles 0x0000 .. 0x13ff of the station with 15 byte
+                telegrams and writes them to a binary image, two nibbles per
+                byte, the lower address in the low nibble. The image can be
+                used by weather23k-emu (-i) and by weather23k ([Port] image)
+                instead of the station.
+
+                With -p every field of the memory map is decoded from the
+                image and printed.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        A dump takes 171 telegrams, about 15 seconds at 2400 baud.
+
+    todo
+
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "data.h"
+#include "sercom.h"
+#include "ws23kcom.h"
+#include "ws23kmap.h"
+
+
+#define DEFAULT_PORT                            "/dev/ttyS0"
+#define DEFAULT_IMAGE                           "ws2300.img"
+
+
+static link_t the_link;                                                         // the station or the image
+
+
+/*  function        static ERRNO dump( link_t * p_link, uint8_t * image )
+
+    brief           Reads the whole memory of the station
+
+    param[in]       link_t * p_link
+    param[out]      uint8_t * image, IMAGE_BYTES bytes
+
+    return          ERRNO
+*/
+static ERRNO dump( link_t * p_link, uint8_t * image )
+    {
+    int addr;
+    int n;
+
+    for( addr = 0; addr < MEMORY_NIBBLES; addr += 2 * PLAN_WINDOW_BYTES )
+        {
+        n = ( MEMORY_NIBBLES - addr ) / 2;
+        if( n > PLAN_WINDOW_BYTES )
+            n = PLAN_WINDOW_BYTES;
+        if( read_data(p_link, image + addr / 2, addr, n) != n )
+            return ERR_COMM_READ;
+        }
+
+    return NOERR;
+    }
+
+
+/*  function        static void print_fields( uint8_t const * image )
+
+    brief           Decodes every field of the memory map from the image
+
+    param[in]       uint8_t const * image, IMAGE_BYTES bytes
+*/
+static void print_fields( uint8_t const * image )
+    {
+    field_t const * p_field;
+    struct timestamp ts;
+    int i;
+    int j;
+
+    for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+        {
+        p_field = map_field(i);
+        printf("%04x  %-30s ", p_field->address, p_field->name);
+        if( p_field->encoding == ENC_TIMESTAMP || p_field->encoding == ENC_CLOCK )
+            {
+            map_timestamp(i, image, 0, &ts);
+            printf("%02d.%02d.%04d %02d:%02d\n", ts.day, ts.month, ts.year, ts.hour, ts.minute);
+            }
+        else if( p_field->nibbles > 8 )                                         // too long for a number
+            {
+            for( j = 0; j < p_field->nibbles; ++j )
+                printf("%x", ( image[(p_field->address + j) / 2] >> ( ( (p_field->address + j) & 1 ) * 4 ) ) & 0x0f);
+            printf("\n");
+            }
+        else
+            printf("%.2f\n", map_value(i, image, 0));
+        }
+    }
+
+
+/*  function        static void usage( void )
+
+    brief           Prints the command line help
+*/
+static void usage( void )
+    {
+    printf("\nweather23k-dump V%s (c) Uwe Jantzen (Klabautermann-Software) %s", VERSION, __DATE__);
+    printf("\n\nUsage:");
+    printf("\n        weather23k-dump [options]");
+    printf("\nOptions:");
+    printf("\n        -d <port>     serial port of the station (default %s)", DEFAULT_PORT);
+    printf("\n        -o <file>     write the image to <file> (default %s)", DEFAULT_IMAGE);
+    printf("\n        -i <file>     don't read the station, use the image <file>");
+    printf("\n        -p            print all fields of the memory map");
+    printf("\n        -h            show this help");
+    printf("\n\n");
+    }
+
+
+/*  function        int main( int argc, char *argv[] )
+
+    brief           main function :
+                        reads arguments,
+                        reads the station's memory or an image
+                        writes the image
+                        prints the decoded fields if wanted
+
+    param[in]       int argc, number of command line parameters
+    param[in]       char *argv[], command line parameter list
+
+    return          int, error code
+*/
+int main( int argc, char *argv[] )
+    {
+    char * port = DEFAULT_PORT;
+    char const * image_file = 0;
+    char const * out_file = DEFAULT_IMAGE;
+    uint8_t image[IMAGE_BYTES];
+    struct timespec start;
+    struct timespec end;
+    commstat_t stats;
+    FILE * p_file;
+    int print = 0;
+    int i;
+    ERRNO error;
+
+    for( i = 1; i < argc; ++i )
+        {
+        if( argv[i][0] != '-' || strlen(argv[i]) != 2 )
+            {
+            usage();
+            return 1;
+            }
+        switch( argv[i][1] )
+            {
+            case 'p' :
+                print = 1;
+                continue;
+            case 'h' :
+                usage();
+                return 0;
+            default :
+                break;
+            }
+        if( i + 1 >= argc )                                                     // all other options need a value
+            {
+            usage();
+            return 1;
+            }
+        switch( argv[i][1] )
+            {
+            case 'd' :
+                port = argv[++i];
+                break;
+            case 'o' :
+                out_file = argv[++i];
+                break;
+            case 'i' :
+                image_file = argv[++i];
+                break;
+            default :
+                usage();
+                return 1;
+            }
+        }
+
+    if( image_file )
+        {
+        error = link_load_image(&the_link, image_file);
+        if( error )
+            {
+            printf("Image file error : %d\n", error);
+            return error;
+            }
+        memcpy(image, link_image(&the_link), IMAGE_BYTES);
+        }
+    else
+        {
+        error = link_init(&the_link, port);
+        if( !error )
+            error = ws_open(&the_link.port);
+        if( error )
+            {
+            printf("Serial port initialization error : %d\n", error);
+            return error;
+            }
+        link_invalidate(&the_link);
+        clear_comm_stats(&the_link);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        error = dump(&the_link, image);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ws_close(&the_link.port);
+        if( error )
+            {
+            printf("Reading the station failed : %d\n", error);
+            return error;
+            }
+
+        get_comm_stats(&the_link, &stats);
+        printf("%d nibbles read in %ld ms, %d telegrams (%d retries, %d resets)\n", MEMORY_NIBBLES,
+            (end.tv_sec - start.tv_sec) * 1000L + (end.tv_nsec - start.tv_nsec) / 1000000L,
+            stats.transactions, stats.retries, stats.resyncs);
+
+        p_file = fopen(out_file, "wb");
+        if( !p_file || fwrite(image, 1, IMAGE_BYTES, p_file) != IMAGE_BYTES )
+            {
+            perror(out_file);
+            if( p_file )
+                fclose(p_file);
+            return ERR_OPEN_FILE;
+            }
+        fclose(p_file);
+        printf("Image written to %s\n", out_file);
+        }
+
+    if( print )
+        print_fields(image);
+
+    return 0;
+    }
@@ -0,0 +1,697 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kemu.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       WS2300 weather station emulator
+
+    details     Opens a pseudo terminal and answers the WS2300 protocol on it
+                like a weather station connected to a serial port. The port
+                name of weather23k has to be set to the slave side of the
+                pseudo terminal which is printed at startup (or to the link
+                given with -l).
+
+                The station's memory of 0x1400 nibbles is initialized from
+                doc/memory_map_2300.txt or from a binary image with two
+                nibbles per byte, the lower address in the low nibble.
+
+                Protocol, every byte sent to the station is answered :
+                0x06                reset, answer 0x02
+                0x82 + nibble * 4   address nibble i (0..3), answer i * 16 + nibble
+                0xc2 + n * 4        read n bytes, answer 0x30 + n, n data bytes
+                                    and the sum of the data bytes
+                0x42 + nibble * 4   write nibble, answer nibble + 0x10
+                0x12 + bit * 4      set bit, answer bit + 0x04
+                0x32 + bit * 4      clear bit, answer bit + 0x0c
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Every byte is delayed by one character time of the given baud
+                rate in each direction, -b 0 answers as fast as possible.
+
+                Faults of a real link can be injected with a probability per
+                answer byte : the byte is dropped (-D), one of its bits is
+                flipped (-C) or the line is held for a while before it is sent
+                (-S, -s). With -W a read of the current wind speed returns the
+                station's "no valid value" pattern 0xff with the flag nibble
+                set. A summary of the injected faults is printed on SIGINT or
+                SIGTERM.
+
+                With -c the station's clock runs, it starts at the host's
+                local time and gains the given ppm.
+
+    todo
+
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#define MEMORY_NIBBLES                          0x1400
+#define DEFAULT_MAP_FILE                        "doc/memory_map_2300.txt"
+#define DEFAULT_BAUD                            2400
+#define DEFAULT_STALL                           2000                            // [ms]
+
+#define WIND_SPEED_ADDRESS                      0x529                           // speed nibbles 0x529..0x52b
+#define WIND_SPEED_NIBBLES                      3
+
+#define CLOCK_SECONDS_ADDRESS                   0x200                           // BCD second, minute, hour
+#define CLOCK_ADDRESS                           0x23b                           // BCD minute, hour, weekday, day, month, year
+
+#define STATE_IDLE                              0                               // waiting for reset or address
+#define STATE_ADDRESS                           1                               // receiving address nibbles
+#define STATE_COMMAND                           2                               // address complete, waiting for command
+#define STATE_WRITE                             3                               // writing nibbles
+
+
+static uint8_t the_memory[MEMORY_NIBBLES];                                      // one nibble per byte
+static int the_master = -1;
+static long the_char_time = 10000000L / DEFAULT_BAUD;                           // [us] 10 bits per byte
+static int the_verbose = 0;
+
+static int the_state = STATE_IDLE;
+static int the_address_count = 0;
+static int the_address = 0;
+
+static double the_drop_rate = 0.0;                                              // probabilities per answer byte [0..1]
+static double the_corrupt_rate = 0.0;
+static double the_stall_rate = 0.0;
+static double the_wind_rate = 0.0;                                              // probability per wind speed read
+static long the_stall_time = DEFAULT_STALL;                                     // [ms]
+
+static int the_clock = 0;                                                       // 1 : the station's clock runs
+static double the_clock_drift = 0.0;                                            // [ppm] the clock gains
+static struct timespec the_clock_start;                                         // CLOCK_REALTIME when the clock was started
+
+static unsigned long the_bytes_sent = 0;
+static unsigned long the_drops = 0;
+static unsigned long the_corruptions = 0;
+static unsigned long the_stalls = 0;
+static unsigned long the_invalid_winds = 0;
+
+static volatile sig_atomic_t the_stop = 0;
+
+
+/*  function        static int load_map( char const * name )
+
+    brief           Initializes the memory from a memory map text file, each
+                    line starting with "<address> <nibble>" is used
+
+    param[in]       char const * name, file name
+
+    return          int, number of nibbles set or -1 if the file can't be read
+*/
+static int load_map( char const * name )
+    {
+    FILE * p_file;
+    char line[256];
+    unsigned int addr;
+    unsigned int val;
+    int count = 0;
+
+    p_file = fopen(name, "r");
+    if( !p_file )
+        return -1;
+
+    while( fgets(line, sizeof(line), p_file) )
+        {
+        if( sscanf(line, "%4x %1x", &addr, &val) != 2 )
+            continue;
+        if( addr >= MEMORY_NIBBLES )
+            continue;
+        the_memory[addr] = (uint8_t)val;
+        ++count;
+        }
+
+    fclose(p_file);
+    return count;
+    }
+
+
+/*  function        static int load_image( char const * name )
+
+    brief           Initializes the memory from a binary image, two nibbles per
+                    byte, lower address in the low nibble
+
+    param[in]       char const * name, file name
+
+    return          int, number of nibbles set or -1 if the file can't be read
+*/
+static int load_image( char const * name )
+    {
+    FILE * p_file;
+    int c;
+    int addr = 0;
+
+    p_file = fopen(name, "rb");
+    if( !p_file )
+        return -1;
+
+    while( ( addr < MEMORY_NIBBLES ) && ( (c = fgetc(p_file)) != EOF ) )
+        {
+        the_memory[addr++] = (uint8_t)(c & 0x0f);
+        the_memory[addr++] = (uint8_t)(c >> 4);
+        }
+
+    fclose(p_file);
+    return addr;
+    }
+
+
+/*  function        static void pace( void )
+
+    brief           Waits for one character time
+*/
+static void pace( void )
+    {
+    if( the_char_time > 0 )
+        usleep(the_char_time);
+    }
+
+
+/*  function        static int chance( double rate )
+
+    brief           Decides randomly whether a fault is injected
+
+    param[in]       double rate, probability [0..1]
+
+    return          int, 1 if the fault has to be injected
+*/
+static int chance( double rate )
+    {
+    if( rate <= 0.0 )
+        return 0;
+    return ( (double)random() / ((double)RAND_MAX + 1.0) ) < rate;
+    }
+
+
+/*  function        static void send_byte( uint8_t b )
+
+    brief           Sends a byte to the host, a byte may be held back, altered
+                    or dropped as set by the fault options
+
+    param[in]       uint8_t b
+*/
+static void send_byte( uint8_t b )
+    {
+    if( chance(the_stall_rate) )
+        {
+        ++the_stalls;
+        if( the_verbose )
+            printf("stall %ld ms\n", the_stall_time);
+        usleep(the_stall_time * 1000);
+        }
+
+    pace();
+
+    if( chance(the_drop_rate) )
+        {
+        ++the_drops;
+        if( the_verbose )
+            printf("drop  %02x\n", b);
+        return;
+        }
+
+    if( chance(the_corrupt_rate) )
+        {
+        ++the_corruptions;
+        if( the_verbose )
+            printf("flip  %02x\n", b);
+        b ^= (uint8_t)(1 << (random() % 8));
+        }
+
+    ++the_bytes_sent;
+    if( write(the_master, &b, 1) != 1 )
+        perror("write");
+    }
+
+
+/*  function        static uint8_t get_nibble( int a, int invalid_wind )
+
+    brief           Gets a memory nibble as it is sent to the host
+
+    param[in]       int a, nibble address
+    param[in]       int invalid_wind, 1 to return the invalid wind pattern
+
+    return          uint8_t, nibble
+*/
+static uint8_t get_nibble( int a, int invalid_wind )
+    {
+    if( invalid_wind && a >= WIND_SPEED_ADDRESS && a < WIND_SPEED_ADDRESS + WIND_SPEED_NIBBLES )
+        {
+        if( a == WIND_SPEED_ADDRESS + 2 )                                       // speed 0x1ff : 0xff and the flag nibble
+            return 0x1;
+        return 0xf;
+        }
+    return the_memory[a];
+    }
+
+
+/*  function        static void put_bcd( int a, int value )
+
+    brief           Sets two nibbles to a BCD number, the ones first
+
+    param[in]       int a, nibble address
+    param[in]       int value, 0 .. 99
+*/
+static void put_bcd( int a, int value )
+    {
+    the_memory[a] = (uint8_t)(value % 10);
+    the_memory[a + 1] = (uint8_t)(value / 10 % 10);
+    }
+
+
+/*  function        static void update_clock( void )
+
+    brief           Sets the station's clock to the host's time plus the drift
+                    since the start
+*/
+static void update_clock( void )
+    {
+    struct timespec now;
+    struct tm t;
+    double elapsed;
+    time_t station;
+
+    if( !the_clock )
+        return;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    elapsed = ( now.tv_sec - the_clock_start.tv_sec ) + ( now.tv_nsec - the_clock_start.tv_nsec ) / 1e9;
+    station = the_clock_start.tv_sec + (time_t)( the_clock_start.tv_nsec / 1e9 + elapsed * ( 1.0 + the_clock_drift / 1e6 ) );
+    localtime_r(&station, &t);
+
+    put_bcd(CLOCK_SECONDS_ADDRESS, t.tm_sec);
+    put_bcd(CLOCK_SECONDS_ADDRESS + 2, t.tm_min);
+    put_bcd(CLOCK_SECONDS_ADDRESS + 4, t.tm_hour);
+    put_bcd(CLOCK_ADDRESS, t.tm_min);
+    put_bcd(CLOCK_ADDRESS + 2, t.tm_hour);
+    the_memory[CLOCK_ADDRESS + 4] = (uint8_t)( t.tm_wday == 0 ? 7 : t.tm_wday ); // Mon .. Sun = 1 .. 7
+    put_bcd(CLOCK_ADDRESS + 5, t.tm_mday);
+    put_bcd(CLOCK_ADDRESS + 7, t.tm_mon + 1);
+    put_bcd(CLOCK_ADDRESS + 9, t.tm_year % 100);
+    }
+
+
+/*  function        static void do_read( int n )
+
+    brief           Answers a read command with n bytes starting at the
+                    current address and the checksum
+
+    param[in]       int n, number of bytes
+*/
+static void do_read( int n )
+    {
+    uint8_t checksum = 0;
+    uint8_t b;
+    int invalid_wind = 0;
+    int i;
+    int a;
+
+    if( the_address <= WIND_SPEED_ADDRESS && the_address + 2 * n > WIND_SPEED_ADDRESS && chance(the_wind_rate) )
+        {
+        invalid_wind = 1;
+        ++the_invalid_winds;
+        if( the_verbose )
+            printf("invalid wind\n");
+        }
+    update_clock();
+
+    send_byte((uint8_t)(0x30 + n));
+
+    for( i = 0; i < n; ++i )
+        {
+        a = (the_address + 2 * i) % MEMORY_NIBBLES;
+        b = (uint8_t)(get_nibble(a, invalid_wind) | (get_nibble((a + 1) % MEMORY_NIBBLES, invalid_wind) << 4));
+        checksum += b;
+        send_byte(b);
+        }
+
+    send_byte(checksum);
+
+    if( the_verbose )
+        printf("read  %04x %2d bytes\n", the_address, n);
+    }
+
+
+/*  function        static void handle_byte( uint8_t b )
+
+    brief           Runs the protocol state machine for one received byte
+
+    param[in]       uint8_t b
+*/
+static void handle_byte( uint8_t b )
+    {
+    int v = (b >> 2) & 0x0f;                                                    // argument of address, read and write commands
+
+    if( b == 0x06 )                                                             // reset
+        {
+        the_state = STATE_IDLE;
+        send_byte(0x02);
+        return;
+        }
+
+    if( (b & 0x03) != 0x02 )                                                    // not a command, ignore it
+        return;
+
+    switch( b & 0xc0 )
+        {
+        case 0x80 :                                                             // address nibble
+            if( the_state != STATE_ADDRESS )
+                {
+                the_state = STATE_ADDRESS;
+                the_address_count = 0;
+                the_address = 0;
+                }
+            send_byte((uint8_t)(the_address_count * 16 + v));
+            the_address = (the_address << 4) | v;
+            if( ++the_address_count == 4 )
+                the_state = STATE_COMMAND;
+            return;
+
+        case 0xc0 :                                                             // read
+            if( the_state != STATE_COMMAND || v == 0 )
+                return;
+            do_read(v);
+            the_state = STATE_IDLE;
+            return;
+
+        default :
+            break;
+        }
+
+    if( the_state != STATE_COMMAND && the_state != STATE_WRITE )
+        return;
+
+    if( b >= 0x42 )                                                             // write nibble
+        {
+        the_memory[the_address % MEMORY_NIBBLES] = (uint8_t)v;
+        if( the_verbose )
+            printf("write %04x = %x\n", the_address, v);
+        the_address = (the_address + 1) % MEMORY_NIBBLES;
+        the_state = STATE_WRITE;
+        send_byte((uint8_t)(v + 0x10));
+        }
+    else if( b >= 0x32 )                                                        // clear bit
+        {
+        v = (b - 0x32) >> 2;
+        if( v > 3 )
+            return;
+        the_memory[the_address % MEMORY_NIBBLES] &= (uint8_t)~(1 << v);
+        if( the_verbose )
+            printf("clear %04x bit %d\n", the_address, v);
+        the_state = STATE_WRITE;
+        send_byte((uint8_t)(v + 0x0c));
+        }
+    else if( b >= 0x12 )                                                        // set bit
+        {
+        v = (b - 0x12) >> 2;
+        if( v > 3 )
+            return;
+        the_memory[the_address % MEMORY_NIBBLES] |= (uint8_t)(1 << v);
+        if( the_verbose )
+            printf("set   %04x bit %d\n", the_address, v);
+        the_state = STATE_WRITE;
+        send_byte((uint8_t)(v + 0x04));
+        }
+    }
+
+
+/*  function        static int open_pty( char const * link )
+
+    brief           Opens the pseudo terminal. The slave side is kept open too,
+                    so the master does not see a hangup when the host closes
+                    its port between two readings.
+
+    param[in]       char const * link, symbolic link to create for the slave or 0
+
+    return          int, 0 or -1 on error
+*/
+static int open_pty( char const * link )
+    {
+    struct termios control;
+    char const * name;
+    int slave;
+
+    the_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if( the_master < 0 || grantpt(the_master) < 0 || unlockpt(the_master) < 0 )
+        {
+        perror("posix_openpt");
+        return -1;
+        }
+
+    name = ptsname(the_master);
+    slave = open(name, O_RDWR | O_NOCTTY);
+    if( slave < 0 )
+        {
+        perror(name);
+        return -1;
+        }
+
+    tcgetattr(slave, &control);                                                 // raw until the host sets its own mode
+    cfmakeraw(&control);
+    tcsetattr(slave, TCSANOW, &control);
+
+    if( link )
+        {
+        unlink(link);
+        if( symlink(name, link) < 0 )
+            {
+            perror(link);
+            return -1;
+            }
+        printf("WS2300 emulator on %s -> %s\n", link, name);
+        }
+    else
+        printf("WS2300 emulator on %s\n", name);
+    fflush(stdout);
+
+    return 0;
+    }
+
+
+/*  function        static void on_signal( int sig )
+
+    brief           Stops the main loop
+
+    param[in]       int sig, signal number
+*/
+static void on_signal( int sig )
+    {
+    (void)sig;
+    the_stop = 1;
+    }
+
+
+/*  function        static void print_summary( void )
+
+    brief           Prints the number of sent bytes and injected faults
+*/
+static void print_summary( void )
+    {
+    printf("\nbytes sent      : %lu\n", the_bytes_sent);
+    printf("dropped         : %lu\n", the_drops);
+    printf("corrupted       : %lu\n", the_corruptions);
+    printf("stalled         : %lu\n", the_stalls);
+    printf("invalid wind    : %lu\n", the_invalid_winds);
+    }
+
+
+/*  function        static void usage( void )
+
+    brief           Prints the command line help
+*/
+static void usage( void )
+    {
+    printf("\nweather23k-emu V%s (c) Uwe Jantzen (Klabautermann-Software) %s", VERSION, __DATE__);
+    printf("\n\nUsage:");
+    printf("\n        weather23k-emu [options]");
+    printf("\nOptions:");
+    printf("\n        -m <file>     initialize memory from a memory map text file (default %s)", DEFAULT_MAP_FILE);
+    printf("\n        -i <file>     initialize memory from a binary image");
+    printf("\n        -b <baud>     pace the answers like a serial line of <baud> (default %d, 0 = no delay)", DEFAULT_BAUD);
+    printf("\n        -l <path>     create a symbolic link <path> to the pseudo terminal");
+    printf("\n        -D <percent>  drop answer bytes with this probability");
+    printf("\n        -C <percent>  flip a bit of answer bytes with this probability");
+    printf("\n        -S <percent>  hold the line before answer bytes with this probability");
+    printf("\n        -s <ms>       time the line is held (default %d ms)", DEFAULT_STALL);
+    printf("\n        -W <percent>  answer wind speed reads with the invalid pattern 0xff");
+    printf("\n        -r <seed>     seed of the random faults (default time)");
+    printf("\n        -c <ppm>      run the station's clock, it gains <ppm> against the host");
+    printf("\n        -v            verbose, show every read and write");
+    printf("\n        -h            show this help");
+    printf("\n\n");
+    }
+
+
+/*  function        int main( int argc, char *argv[] )
+
+    brief           main function :
+                        reads arguments,
+                        initializes memory and pseudo terminal
+                        loops
+                            answers the bytes sent by the host
+
+    param[in]       int argc, number of command line parameters
+    param[in]       char *argv[], command line parameter list
+
+    return          int, error code
+*/
+int main( int argc, char *argv[] )
+    {
+    char const * map_file = DEFAULT_MAP_FILE;
+    char const * image_file = 0;
+    char const * link = 0;
+    long baud = DEFAULT_BAUD;
+    unsigned int seed = (unsigned int)time(0);
+    struct sigaction action;
+    uint8_t b;
+    ssize_t n;
+    int i;
+
+    for( i = 1; i < argc; ++i )
+        {
+        if( argv[i][0] != '-' || strlen(argv[i]) != 2 )
+            {
+            usage();
+            return 1;
+            }
+        switch( argv[i][1] )
+            {
+            case 'v' :
+                the_verbose = 1;
+                continue;
+            case 'h' :
+                usage();
+                return 0;
+            default :
+                break;
+            }
+        if( i + 1 >= argc )                                                     // all other options need a value
+            {
+            usage();
+            return 1;
+            }
+        switch( argv[i][1] )
+            {
+            case 'm' :
+                map_file = argv[++i];
+                break;
+            case 'i' :
+                image_file = argv[++i];
+                break;
+            case 'b' :
+                baud = atol(argv[++i]);
+                break;
+            case 'l' :
+                link = argv[++i];
+                break;
+            case 'D' :
+                the_drop_rate = atof(argv[++i]) / 100.0;
+                break;
+            case 'C' :
+                the_corrupt_rate = atof(argv[++i]) / 100.0;
+                break;
+            case 'S' :
+                the_stall_rate = atof(argv[++i]) / 100.0;
+                break;
+            case 's' :
+                the_stall_time = atol(argv[++i]);
+                break;
+            case 'W' :
+                the_wind_rate = atof(argv[++i]) / 100.0;
+                break;
+            case 'r' :
+                seed = (unsigned int)strtoul(argv[++i], 0, 0);
+                break;
+            case 'c' :
+                the_clock = 1;
+                the_clock_drift = atof(argv[++i]);
+                break;
+            default :
+                usage();
+                return 1;
+            }
+        }
+
+    the_char_time = ( baud > 0 ) ? 10000000L / baud : 0;
+    srandom(seed);
+    clock_gettime(CLOCK_REALTIME, &the_clock_start);
+
+    if( image_file )
+        {
+        if( load_image(image_file) < 0 )
+            {
+            perror(image_file);
+            return 1;
+            }
+        }
+    else if( load_map(map_file) < 0 )
+        {
+        perror(map_file);
+        return 1;
+        }
+
+    if( open_pty(link) < 0 )
+        return 1;
+
+    memset(&action, 0, sizeof(action));                                         // no SA_RESTART, read() has to return
+    action.sa_handler = on_signal;
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+
+    while( !the_stop )
+        {
+        n = read(the_master, &b, 1);
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 )
+            {
+            perror("read");
+            print_summary();
+            return 1;
+            }
+        pace();                                                                 // the byte needs this time on the line
+        handle_byte(b);
+        }
+
+    print_summary();
+    return 0;
+    }
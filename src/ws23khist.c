@@ -0,0 +1,402 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23khist.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       History records of the WS2300 weather station
+
+    details     The position of the last fetched record is remembered by its
+                index in the ring and the time it was saved. history_sync()
+                compares it with the station's pointer to the last written
+                record and reads only the records in between. The new
+                records are contiguous in the ring (two ranges if the ring
+                wraps), they are read with 15 byte telegrams.
+
+                If the time of the remembered record does not fit to the
+                station's pointer any more (history cleared, interval
+                changed) all records saved after the remembered time are
+                read.
+
+                The position can be saved to a file so a restarted program
+                continues where it stopped and fills the gap.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Record layout, nibble 0 first :
+                0 .. 4      temperatures, Tin = (v % 1000) / 10 - 30,
+                            Tout = (v / 1000) / 10 - 30
+                5 .. 9      pressure = 1000 + (v % 10000) / 10, minus 1000
+                            if >= 1500, indoor humidity = v / 10000
+                10 .. 11    outdoor humidity, BCD
+                12 .. 14    rain counter
+                15 .. 17    wind speed / 10 [m/sec]
+                18          wind direction * 22.5 [°]
+
+    todo
+
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "debug.h"
+#include "errors.h"
+#include "ws23kcom.h"
+#include "ws23kmap.h"
+#include "ws23khist.h"
+
+
+#define HISTORY_BYTES                           ((HISTORY_RECORDS * HISTORY_RECORD_NIBBLES + 1) / 2 + 1)
+
+
+/*  function        static unsigned long get_bin( uint8_t const * data, int base, int addr, int n )
+
+    brief           Gets a binary number out of a buffer read by read_data()
+
+    param[in]       uint8_t const * data, buffer
+    param[in]       int base, address of the low nibble of data[0]
+    param[in]       int addr, address of the least significant nibble
+    param[in]       int n, number of nibbles
+
+    return          unsigned long, value
+*/
+static unsigned long get_bin( uint8_t const * data, int base, int addr, int n )
+    {
+    unsigned long value = 0;
+    int offset;
+
+    while( n-- > 0 )
+        {
+        offset = addr + n - base;
+        value = value * 16 + ( ( offset & 1 ) ? data[offset / 2] >> 4 : data[offset / 2] & 0x0f );
+        }
+
+    return value;
+    }
+
+
+/*  function        static time_t to_time( struct timestamp const * ts )
+
+    brief           Converts a timestamp of the station into calendar time
+
+    param[in]       struct timestamp const * ts
+
+    return          time_t
+*/
+static time_t to_time( struct timestamp const * ts )
+    {
+    struct tm t;
+
+    memset(&t, 0, sizeof(t));
+    t.tm_min = ts->minute;
+    t.tm_hour = ts->hour;
+    t.tm_mday = ts->day;
+    t.tm_mon = ts->month - 1;
+    t.tm_year = ts->year - 1900;
+    t.tm_isdst = -1;                                                            // the station runs on local time
+
+    return mktime(&t);
+    }
+
+
+/*  function        static ERRNO read_range( link_t * p_link, uint8_t * data, int addr, int nibbles )
+
+    brief           Reads a range of nibbles with as few telegrams as possible
+
+    param[in]       link_t * p_link
+    param[out]      uint8_t * data, buffer for (nibbles + 1) / 2 bytes
+    param[in]       int addr, first nibble
+    param[in]       int nibbles, number of nibbles
+
+    return          ERRNO
+*/
+static ERRNO read_range( link_t * p_link, uint8_t * data, int addr, int nibbles )
+    {
+    int bytes = ( nibbles + 1 ) / 2;
+    int done = 0;
+    int n;
+
+    while( done < bytes )
+        {
+        n = bytes - done;
+        if( n > PLAN_WINDOW_BYTES )
+            n = PLAN_WINDOW_BYTES;
+        if( read_data(p_link, data + done, addr + 2 * done, n) != n )
+            {
+            handle_comm_error(p_link, ERR_COMM_READ);
+            return ERR_COMM_READ;
+            }
+        done += n;
+        }
+
+    return NOERR;
+    }
+
+
+/*  function        static void decode( uint8_t const * data, int base, int index, history_record_t * p_record )
+
+    brief           Decodes a history record
+
+    param[in]       uint8_t const * data, buffer holding the record
+    param[in]       int base, address of the low nibble of data[0]
+    param[in]       int index, index of the record in the ring
+    param[out]      history_record_t * p_record
+*/
+static void decode( uint8_t const * data, int base, int index, history_record_t * p_record )
+    {
+    int addr = HISTORY_ADDRESS + index * HISTORY_RECORD_NIBBLES;
+    unsigned long value;
+
+    p_record->index = index;
+
+    value = get_bin(data, base, addr, 5);
+    p_record->temperature_in = (value % 1000) / 10.0 - 30.0;
+    p_record->temperature_out = (value / 1000) / 10.0 - 30.0;
+
+    value = get_bin(data, base, addr + 5, 5);
+    p_record->pressure = 1000.0 + (value % 10000) / 10.0;
+    if( p_record->pressure >= 1500.0 )
+        p_record->pressure -= 1000.0;
+    p_record->humidity_in = (int)(value / 10000);
+
+    p_record->humidity_out = (int)(get_bin(data, base, addr + 11, 1) * 10 + get_bin(data, base, addr + 10, 1));
+    p_record->rain_count = (int)get_bin(data, base, addr + 12, 3);
+    p_record->speed = get_bin(data, base, addr + 15, 3) / 10.0;
+    p_record->direction = get_bin(data, base, addr + 18, 1) * 22.5;
+    }
+
+
+/*  function        ERRNO history_info( link_t * p_link, history_info_t * p_info )
+
+    brief           Reads the history settings and pointers with a single
+                    telegram
+
+    param[in]       link_t * p_link
+    param[out]      history_info_t * p_info
+
+    return          ERRNO
+*/
+ERRNO history_info( link_t * p_link, history_info_t * p_info )
+    {
+    readplan_t plan;
+    double value;
+    ERRNO error;
+
+    plan_clear(&plan);
+    map_plan(&plan, FLD_HIST_INTERVAL);
+    map_plan(&plan, FLD_HIST_COUNTDOWN);
+    map_plan(&plan, FLD_HIST_TLAST);
+    map_plan(&plan, FLD_HIST_LAST);
+    map_plan(&plan, FLD_HIST_COUNT);
+    error = plan_read(p_link, &plan);
+    if( error )
+        {
+        handle_comm_error(p_link, error);
+        return error;
+        }
+
+    map_get(&plan, FLD_HIST_INTERVAL, &value);
+    p_info->interval = (int)value;
+    map_get(&plan, FLD_HIST_COUNTDOWN, &value);
+    p_info->countdown = (int)value;
+    map_get_timestamp(&plan, FLD_HIST_TLAST, &p_info->last_time);
+    map_get(&plan, FLD_HIST_LAST, &value);
+    p_info->last_record = (int)value;
+    map_get(&plan, FLD_HIST_COUNT, &value);
+    p_info->records = (int)value;
+
+    if( p_info->last_record >= HISTORY_RECORDS || p_info->records > HISTORY_RECORDS )
+        return ERR_COMM_READ;
+
+    return NOERR;
+    }
+
+
+/*  function        int history_sync( histpos_t * p_pos, link_t * p_link, history_record_t * records, int max )
+
+    brief           Reads the records saved since the last call, the oldest
+                    first. If there are more than max new records the oldest
+                    max records are returned, the next call gets the others.
+
+    param[in]       histpos_t * p_pos
+    param[in]       link_t * p_link
+    param[out]      history_record_t * records, buffer for max records
+    param[in]       int max, size of the buffer
+
+    return          int, number of new records or < 0 on error (ERRNO)
+*/
+int history_sync( histpos_t * p_pos, link_t * p_link, history_record_t * records, int max )
+    {
+    uint8_t data[HISTORY_BYTES];
+    history_info_t info;
+    time_t last;
+    int period;
+    int count;
+    int first;
+    int index;
+    int base;
+    int n;
+    int i;
+    ERRNO error;
+
+    error = history_info(p_link, &info);
+    if( error )
+        return error;
+    if( info.records == 0 || info.interval <= 0 )
+        return 0;
+
+    last = to_time(&info.last_time);
+    period = info.interval * 60;
+
+    count = info.records;                                                       // no position : get all
+    if( p_pos->index >= 0 )
+        {
+        count = ( info.last_record - p_pos->index + HISTORY_RECORDS ) % HISTORY_RECORDS;
+        if( last - (time_t)count * period != p_pos->time )                      // the ring does not fit, use the time
+            {
+            count = ( last > p_pos->time ) ? (int)( ( last - p_pos->time ) / period ) : 0;
+            debug("History position lost, %d records newer than the last fetched one\n", count);
+            }
+        }
+    if( count > info.records )
+        count = info.records;
+    if( count == 0 )
+        return 0;
+
+    first = ( info.last_record - count + 1 + HISTORY_RECORDS ) % HISTORY_RECORDS;
+    if( count > max )
+        count = max;
+
+    i = 0;
+    while( i < count )                                                          // one range up to the end of the ring, one from its start
+        {
+        index = ( first + i ) % HISTORY_RECORDS;
+        n = count - i;
+        if( index + n > HISTORY_RECORDS )
+            n = HISTORY_RECORDS - index;
+
+        base = HISTORY_ADDRESS + index * HISTORY_RECORD_NIBBLES;
+        base &= ~1;                                                             // telegrams start at an even address
+        error = read_range(p_link, data, base, HISTORY_ADDRESS + (index + n) * HISTORY_RECORD_NIBBLES - base);
+        if( error )
+            return error;
+
+        for( ; n > 0; --n, ++i, ++index )
+            {
+            decode(data, base, index, &records[i]);
+            records[i].time = last - (time_t)(( info.last_record - index + HISTORY_RECORDS ) % HISTORY_RECORDS) * period;
+            }
+        }
+
+    p_pos->index = records[count - 1].index;
+    p_pos->time = records[count - 1].time;
+
+    return count;
+    }
+
+
+/*  function        void history_get_position( histpos_t const * p_pos, int * index, time_t * time )
+
+    brief           Returns the position of the last fetched record
+
+    param[in]       histpos_t const * p_pos
+    param[out]      int * index, index in the ring, -1 if none was fetched yet
+    param[out]      time_t * time, time the record was saved
+*/
+void history_get_position( histpos_t const * p_pos, int * index, time_t * time )
+    {
+    *index = p_pos->index;
+    *time = p_pos->time;
+    }
+
+
+/*  function        void history_set_position( histpos_t * p_pos, int index, time_t time )
+
+    brief           Sets the position of the last fetched record, the next
+                    history_sync() starts after it
+
+    param[in]       histpos_t * p_pos
+    param[in]       int index, index in the ring, -1 to get all records
+    param[in]       time_t time, time the record was saved
+*/
+void history_set_position( histpos_t * p_pos, int index, time_t time )
+    {
+    p_pos->index = ( index >= 0 && index < HISTORY_RECORDS ) ? index : -1;
+    p_pos->time = time;
+    }
+
+
+/*  function        ERRNO history_load_position( histpos_t * p_pos, char const * name )
+
+    brief           Reads the position of the last fetched record from a file
+
+    param[in]       histpos_t * p_pos
+    param[in]       char const * name, file name
+
+    return          ERRNO
+*/
+ERRNO history_load_position( histpos_t * p_pos, char const * name )
+    {
+    FILE * p_file;
+    int index;
+    long time;
+
+    p_file = fopen(name, "r");
+    if( !p_file )
+        return ERR_OPEN_FILE;
+
+    if( fscanf(p_file, "%d %ld", &index, &time) == 2 )
+        history_set_position(p_pos, index, (time_t)time);
+
+    fclose(p_file);
+    return NOERR;
+    }
+
+
+/*  function        ERRNO history_save_position( histpos_t const * p_pos, char const * name )
+
+    brief           Writes the position of the last fetched record to a file
+
+    param[in]       histpos_t const * p_pos
+    param[in]       char const * name, file name
+
+    return          ERRNO
+*/
+ERRNO history_save_position( histpos_t const * p_pos, char const * name )
+    {
+    FILE * p_file;
+
+    p_file = fopen(name, "w");
+    if( !p_file )
+        return ERR_OPEN_FILE;
+
+    fprintf(p_file, "%d %ld\n", p_pos->index, (long)p_pos->time);
+
+    fclose(p_file);
+    return NOERR;
+    }
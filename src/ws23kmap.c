@@ -0,0 +1,505 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kmap.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Memory map of the WS2300 weather station
+
+    details     All numbers are stored least significant nibble first. A
+                field's raw value is built from its nibbles with radix 10
+                (BCD) or 16 (binary) and then scaled : value = raw * scale +
+                offset. Timestamps are stored as BCD minute, hour, day, month
+                and year, the clock has an additional weekday nibble.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        The addresses are taken from doc/memory_map_2300.txt
+
+    todo
+
+*/
+
+
+#include "debug.h"
+#include "ws23kmap.h"
+#include <string.h>
+
+
+#define MAX_FIELD_NIBBLES                       48                              // the rain 24h area is the longest field
+
+
+static field_t const the_fields[FLD_NUM_OF_FIELDS] =
+    {
+    { FLD_TEMP_IN,              "temperature indoor",           0x346,  4, ENC_BCD,       0.01,  -30.0, REFRESH_LIVE     },
+    { FLD_TEMP_IN_MIN,          "temperature indoor min",       0x34b,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_TEMP_IN_MAX,          "temperature indoor max",       0x350,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_TEMP_IN_TMIN,         "temperature indoor min time",  0x354, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_TEMP_IN_TMAX,         "temperature indoor max time",  0x35e, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_TEMP_OUT,             "temperature outdoor",          0x373,  4, ENC_BCD,       0.01,  -30.0, REFRESH_LIVE     },
+    { FLD_TEMP_OUT_MIN,         "temperature outdoor min",      0x378,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_TEMP_OUT_MAX,         "temperature outdoor max",      0x37d,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_TEMP_OUT_TMIN,        "temperature outdoor min time", 0x381, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_TEMP_OUT_TMAX,        "temperature outdoor max time", 0x38b, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_WINDCHILL,            "windchill",                    0x3a0,  4, ENC_BCD,       0.01,  -30.0, REFRESH_LIVE     },
+    { FLD_WINDCHILL_MIN,        "windchill min",                0x3a5,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_WINDCHILL_MAX,        "windchill max",                0x3aa,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_WINDCHILL_TMIN,       "windchill min time",           0x3ae, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_WINDCHILL_TMAX,       "windchill max time",           0x3b8, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_DEWPOINT,             "dewpoint",                     0x3ce,  4, ENC_BCD,       0.01,  -30.0, REFRESH_LIVE     },
+    { FLD_DEWPOINT_MIN,         "dewpoint min",                 0x3d3,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_DEWPOINT_MAX,         "dewpoint max",                 0x3d8,  4, ENC_BCD,       0.01,  -30.0, REFRESH_MINMAX   },
+    { FLD_DEWPOINT_TMIN,        "dewpoint min time",            0x3dc, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_DEWPOINT_TMAX,        "dewpoint max time",            0x3e6, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_IN,               "humidity indoor",              0x3fb,  2, ENC_BCD,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_HUM_IN_MIN,           "humidity indoor min",          0x3fd,  2, ENC_BCD,       1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_IN_MAX,           "humidity indoor max",          0x3ff,  2, ENC_BCD,       1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_IN_TMIN,          "humidity indoor min time",     0x401, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_IN_TMAX,          "humidity indoor max time",     0x40b, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_OUT,              "humidity outdoor",             0x419,  2, ENC_BCD,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_HUM_OUT_MIN,          "humidity outdoor min",         0x41b,  2, ENC_BCD,       1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_OUT_MAX,          "humidity outdoor max",         0x41d,  2, ENC_BCD,       1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_OUT_TMIN,         "humidity outdoor min time",    0x41f, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_HUM_OUT_TMAX,         "humidity outdoor max time",    0x429, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_RAIN_24H,             "rain 24h",                     0x497,  6, ENC_BCD,       0.01,    0.0, REFRESH_LIVE     },
+    { FLD_RAIN_24H_MAX,         "rain 24h max",                 0x49d,  6, ENC_BCD,       0.01,    0.0, REFRESH_MINMAX   },
+    { FLD_RAIN_24H_TMAX,        "rain 24h max time",            0x4a3, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_RAIN_1H,              "rain 1h",                      0x4b4,  6, ENC_BCD,       0.01,    0.0, REFRESH_LIVE     },
+    { FLD_RAIN_1H_MAX,          "rain 1h max",                  0x4ba,  6, ENC_BCD,       0.01,    0.0, REFRESH_MINMAX   },
+    { FLD_RAIN_1H_TMAX,         "rain 1h max time",             0x4c0, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_RAIN_TOTAL,           "rain total",                   0x4d2,  6, ENC_BCD,       0.01,    0.0, REFRESH_LIVE     },
+    { FLD_RAIN_TOTAL_TRESET,    "rain total reset time",        0x4d8, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_WIND_MIN,             "wind min",                     0x4ee,  4, ENC_BIN,       1/360.0, 0.0, REFRESH_MINMAX   },
+    { FLD_WIND_MAX,             "wind max",                     0x4f4,  4, ENC_BIN,       1/360.0, 0.0, REFRESH_MINMAX   },
+    { FLD_WIND_TMIN,            "wind min time",                0x4f8, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_WIND_TMAX,            "wind max time",                0x502, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_WIND_FLAGS,           "wind sensor flags",            0x527,  1, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_MINCODE,         "wind minimum code",            0x528,  1, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_SPEED,           "wind speed",                   0x529,  3, ENC_BIN,       0.1,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_DIR,             "wind direction",               0x52c,  1, ENC_BIN,      22.5,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_DIR1,            "wind direction 1",             0x52d,  1, ENC_BIN,      22.5,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_DIR2,            "wind direction 2",             0x52e,  1, ENC_BIN,      22.5,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_DIR3,            "wind direction 3",             0x52f,  1, ENC_BIN,      22.5,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_DIR4,            "wind direction 4",             0x530,  1, ENC_BIN,      22.5,     0.0, REFRESH_LIVE     },
+    { FLD_WIND_DIR5,            "wind direction 5",             0x531,  1, ENC_BIN,      22.5,     0.0, REFRESH_LIVE     },
+    { FLD_PRESS_ABS,            "pressure absolute",            0x5d8,  5, ENC_BCD,       0.1,     0.0, REFRESH_LIVE     },
+    { FLD_PRESS_REL,            "pressure relative",            0x5e2,  5, ENC_BCD,       0.1,     0.0, REFRESH_LIVE     },
+    { FLD_PRESS_CORR,           "pressure correction",          0x5ec,  5, ENC_BCD,       0.1, -1000.0, REFRESH_SETTINGS },
+    { FLD_PRESS_ABS_MIN,        "pressure absolute min",        0x5f6,  5, ENC_BCD,       0.1,     0.0, REFRESH_MINMAX   },
+    { FLD_PRESS_REL_MIN,        "pressure relative min",        0x600,  5, ENC_BCD,       0.1,     0.0, REFRESH_MINMAX   },
+    { FLD_PRESS_ABS_MAX,        "pressure absolute max",        0x60a,  5, ENC_BCD,       0.1,     0.0, REFRESH_MINMAX   },
+    { FLD_PRESS_REL_MAX,        "pressure relative max",        0x614,  5, ENC_BCD,       0.1,     0.0, REFRESH_MINMAX   },
+    { FLD_PRESS_TMIN,           "pressure min time",            0x61e, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_PRESS_TMAX,           "pressure max time",            0x628, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_MINMAX   },
+    { FLD_CLOCK,                "clock",                        0x23b, 11, ENC_CLOCK,     1.0,     0.0, REFRESH_LIVE     },
+    { FLD_FORECAST,             "forecast",                     0x26b,  1, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_TENDENCY,             "tendency",                     0x26c,  1, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_RAIN_24H_AREA,        "rain 24h area",                0x446, 48, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_RAIN_1H_AREA,         "rain 1h area",                 0x479, 30, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_SETTINGS,             "bit settings",                 0x016,  1, ENC_BIN,       1.0,     0.0, REFRESH_SETTINGS },
+    { FLD_HIST_INTERVAL,        "history interval",             0x6b2,  3, ENC_BIN,       1.0,     1.0, REFRESH_SETTINGS },   // stored as minutes - 1
+    { FLD_HIST_COUNTDOWN,       "history countdown",            0x6b5,  3, ENC_BIN,       1.0,     1.0, REFRESH_LIVE     },
+    { FLD_HIST_TLAST,           "history last record time",     0x6b8, 10, ENC_TIMESTAMP, 1.0,     0.0, REFRESH_LIVE     },
+    { FLD_HIST_LAST,            "history last record",          0x6c2,  2, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_HIST_COUNT,           "history records",              0x6c4,  2, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_ALARM_SET,            "alarm set flags",              0x019,  7, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_ALARM_ACTIVE,         "alarm active flags",           0x020, 13, ENC_BIN,       1.0,     0.0, REFRESH_LIVE     },
+    { FLD_ALARM_TEMP_IN_LO,     "alarm temp indoor low",        0x369,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_TEMP_IN_HI,     "alarm temp indoor high",       0x36e,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_TEMP_OUT_LO,    "alarm temp outdoor low",       0x396,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_TEMP_OUT_HI,    "alarm temp outdoor high",      0x39b,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_WINDCHILL_LO,   "alarm windchill low",          0x3c3,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_WINDCHILL_HI,   "alarm windchill high",         0x3c8,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_DEWPOINT_LO,    "alarm dewpoint low",           0x3f1,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_DEWPOINT_HI,    "alarm dewpoint high",          0x3f6,  4, ENC_BCD,       0.01,  -30.0, REFRESH_SETTINGS },
+    { FLD_ALARM_HUM_IN_LO,      "alarm humidity indoor low",    0x415,  2, ENC_BCD,       1.0,     0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_HUM_IN_HI,      "alarm humidity indoor high",   0x417,  2, ENC_BCD,       1.0,     0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_HUM_OUT_LO,     "alarm humidity outdoor low",   0x433,  2, ENC_BCD,       1.0,     0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_HUM_OUT_HI,     "alarm humidity outdoor high",  0x435,  2, ENC_BCD,       1.0,     0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_RAIN_24H,       "alarm rain 24h",               0x4ae,  6, ENC_BCD,       0.01,    0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_RAIN_1H,        "alarm rain 1h",                0x4cb,  6, ENC_BCD,       0.01,    0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_WIND_LO,        "alarm wind low",               0x533,  3, ENC_BCD,       0.1,     0.0, REFRESH_SETTINGS }, // the station updates 0x50e
+    { FLD_ALARM_WIND_HI,        "alarm wind high",              0x538,  3, ENC_BCD,       0.1,     0.0, REFRESH_SETTINGS }, // the station updates 0x514
+    { FLD_ALARM_PRESS_LO,       "alarm pressure low",           0x63c,  5, ENC_BCD,       0.1,     0.0, REFRESH_SETTINGS },
+    { FLD_ALARM_PRESS_HI,       "alarm pressure high",          0x650,  5, ENC_BCD,       0.1,     0.0, REFRESH_SETTINGS },
+    { FLD_CLOCK_SECONDS,        "clock with seconds",           0x200,  6, ENC_BCD,       1.0,     0.0, REFRESH_LIVE     },
+    };
+
+
+/*  function        static int nibble( uint8_t const * data, int base, int addr )
+
+    brief           Returns the nibble at address addr out of a buffer read
+                    from address base
+
+    param[in]       uint8_t const * data, buffer as read by read_data()
+    param[in]       int base, address of the low nibble of data[0]
+    param[in]       int addr, address of the wanted nibble
+
+    return          int, nibble 0 .. 15
+*/
+static int nibble( uint8_t const * data, int base, int addr )
+    {
+    int offset = addr - base;
+
+    if( offset & 1 )
+        return data[offset / 2] >> 4;
+    return data[offset / 2] & 0x0f;
+    }
+
+
+/*  function        field_t const * map_field( int field )
+
+    brief           Returns the descriptor of a field
+
+    param[in]       int field, FLD_xxx
+
+    return          field_t const *, descriptor or 0 if field is unknown
+*/
+field_t const * map_field( int field )
+    {
+    if( ( field < 0 ) || ( field >= FLD_NUM_OF_FIELDS ) )
+        return 0;
+
+    return &the_fields[field];
+    }
+
+
+/*  function        int map_address( int field )
+
+    brief           Returns the address of a field in the station's memory
+
+    param[in]       int field, FLD_xxx
+
+    return          int, nibble address
+*/
+int map_address( int field )
+    {
+    return the_fields[field].address;
+    }
+
+
+/*  function        int map_bytes( int field )
+
+    brief           Returns the number of bytes read_data() has to read to get
+                    all nibbles of a field
+
+    param[in]       int field, FLD_xxx
+
+    return          int, number of bytes
+*/
+int map_bytes( int field )
+    {
+    return (the_fields[field].nibbles + 1) / 2;
+    }
+
+
+/*  function        unsigned long map_raw( int field, uint8_t const * data, int base )
+
+    brief           Builds the unscaled value of a field from its nibbles
+
+    param[in]       int field, FLD_xxx, must not be a timestamp
+    param[in]       uint8_t const * data, buffer as read by read_data()
+    param[in]       int base, address data was read from
+
+    return          unsigned long, raw value
+*/
+unsigned long map_raw( int field, uint8_t const * data, int base )
+    {
+    field_t const * f = &the_fields[field];
+    unsigned long radix = ( f->encoding == ENC_BCD ) ? 10 : 16;
+    unsigned long raw = 0;
+    int i;
+
+    for( i = f->nibbles - 1; i >= 0; --i )                                      // most significant nibble is the last one
+        raw = raw * radix + nibble(data, base, f->address + i);
+
+    return raw;
+    }
+
+
+/*  function        double map_value( int field, uint8_t const * data, int base )
+
+    brief           Decodes a field
+
+    param[in]       int field, FLD_xxx, must not be a timestamp
+    param[in]       uint8_t const * data, buffer as read by read_data()
+    param[in]       int base, address data was read from
+
+    return          double, value in the field's unit
+*/
+double map_value( int field, uint8_t const * data, int base )
+    {
+    return map_raw(field, data, base) * the_fields[field].scale + the_fields[field].offset;
+    }
+
+
+/*  function        void map_timestamp( int field, uint8_t const * data, int base, struct timestamp * ts )
+
+    brief           Decodes a timestamp or the clock
+
+    param[in]       int field, FLD_xxx of encoding ENC_TIMESTAMP or ENC_CLOCK
+    param[in]       uint8_t const * data, buffer as read by read_data()
+    param[in]       int base, address data was read from
+    param[out]      struct timestamp * ts
+*/
+void map_timestamp( int field, uint8_t const * data, int base, struct timestamp * ts )
+    {
+    int a = the_fields[field].address;
+    int d = ( the_fields[field].encoding == ENC_CLOCK ) ? a + 5 : a + 4;        // skip the weekday
+
+    ts->minute = nibble(data, base, a + 1) * 10 + nibble(data, base, a);
+    ts->hour = nibble(data, base, a + 3) * 10 + nibble(data, base, a + 2);
+    ts->day = nibble(data, base, d + 1) * 10 + nibble(data, base, d);
+    ts->month = nibble(data, base, d + 3) * 10 + nibble(data, base, d + 2);
+    ts->year = 2000 + nibble(data, base, d + 5) * 10 + nibble(data, base, d + 4);
+    }
+
+
+/*  function        void map_nibbles( int field, uint8_t const * data, int base, uint8_t * dst )
+
+    brief           Unpacks the nibbles of a field into one byte each as needed
+                    by write_data()
+
+    param[in]       int field, FLD_xxx
+    param[in]       uint8_t const * data, buffer as read by read_data()
+    param[in]       int base, address data was read from
+    param[out]      uint8_t * dst, buffer for the field's number of nibbles
+*/
+void map_nibbles( int field, uint8_t const * data, int base, uint8_t * dst )
+    {
+    int i;
+
+    for( i = 0; i < the_fields[field].nibbles; ++i )
+        dst[i] = nibble(data, base, the_fields[field].address + i);
+    }
+
+
+/*  function        void map_encode( int field, double value, uint8_t * dst )
+
+    brief           Encodes a value into the nibbles of a field as needed by
+                    write_data(), values out of the field's range are limited
+
+    param[in]       int field, FLD_xxx, must not be a timestamp
+    param[in]       double value, in the field's unit
+    param[out]      uint8_t * dst, buffer for the field's number of nibbles
+*/
+void map_encode( int field, double value, uint8_t * dst )
+    {
+    field_t const * f = &the_fields[field];
+    unsigned long radix = ( f->encoding == ENC_BCD ) ? 10 : 16;
+    double raw = ( value - f->offset ) / f->scale + 0.5;                        // rounded
+    double max = 1.0;
+    unsigned long r;
+    int i;
+
+    for( i = 0; i < f->nibbles; ++i )
+        max *= radix;
+    if( raw < 0.0 )
+        raw = 0.0;
+    else if( raw > max - 1.0 )
+        raw = max - 1.0;
+
+    r = (unsigned long)raw;
+    for( i = 0; i < f->nibbles; ++i )                                           // least significant nibble first
+        {
+        dst[i] = (uint8_t)( r % radix );
+        r /= radix;
+        }
+    }
+
+
+/*  function        void map_encode_timestamp( struct timestamp const * ts, uint8_t * dst )
+
+    brief           Encodes a timestamp into the 10 nibbles of an ENC_TIMESTAMP
+                    field as needed by write_data()
+
+    param[in]       struct timestamp const * ts
+    param[out]      uint8_t * dst, buffer for 10 nibbles
+*/
+void map_encode_timestamp( struct timestamp const * ts, uint8_t * dst )
+    {
+    dst[0] = ts->minute % 10;
+    dst[1] = ts->minute / 10;
+    dst[2] = ts->hour % 10;
+    dst[3] = ts->hour / 10;
+    dst[4] = ts->day % 10;
+    dst[5] = ts->day / 10;
+    dst[6] = ts->month % 10;
+    dst[7] = ts->month / 10;
+    dst[8] = ts->year % 10;
+    dst[9] = (ts->year / 10) % 10;
+    }
+
+
+/*  function        void map_set_refresh( link_t * p_link, int refresh, int age )
+
+    brief           Sets how long the shadow of all fields of a refresh class
+                    may be used instead of reading the station. Classes set
+                    later win where fields share a telegram byte.
+
+    param[in]       link_t * p_link
+    param[in]       int refresh, REFRESH_xxx
+    param[in]       int age, [s], SHADOW_NEVER or SHADOW_FOREVER
+*/
+void map_set_refresh( link_t * p_link, int refresh, int age )
+    {
+    int i;
+
+    for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+        {
+        if( the_fields[i].refresh == refresh )
+            shadow_set_age(p_link, the_fields[i].address, 2 * map_bytes(i), age);
+        }
+    }
+
+
+/*  function        int map_plan( readplan_t * p_plan, int field )
+
+    brief           Adds a field to a read plan
+
+    param[in]       readplan_t * p_plan
+    param[in]       int field, FLD_xxx
+
+    return          int, return value of plan_add()
+*/
+int map_plan( readplan_t * p_plan, int field )
+    {
+    return plan_add(p_plan, map_address(field), map_bytes(field));
+    }
+
+
+/*  function        ERRNO map_get_raw( readplan_t const * p_plan, int field, unsigned long * raw )
+
+    brief           Takes the unscaled value of a field out of a read plan
+
+    param[in]       readplan_t const * p_plan, plan after plan_read()
+    param[in]       int field, FLD_xxx
+    param[out]      unsigned long * raw, unchanged if the field is not available
+
+    return          ERRNO
+*/
+ERRNO map_get_raw( readplan_t const * p_plan, int field, unsigned long * raw )
+    {
+    uint8_t data[MAX_FIELD_NIBBLES / 2];
+    int address = map_address(field);
+    int bytes = map_bytes(field);
+
+    if( plan_get(p_plan, data, address, bytes) != bytes )
+        return ERR_COMM_READ;
+
+    *raw = map_raw(field, data, address);
+    return NOERR;
+    }
+
+
+/*  function        ERRNO map_get( readplan_t const * p_plan, int field, double * value )
+
+    brief           Takes a field out of a read plan and decodes it
+
+    param[in]       readplan_t const * p_plan, plan after plan_read()
+    param[in]       int field, FLD_xxx
+    param[out]      double * value, unchanged if the field is not available
+
+    return          ERRNO
+*/
+ERRNO map_get( readplan_t const * p_plan, int field, double * value )
+    {
+    uint8_t data[MAX_FIELD_NIBBLES / 2];
+    int address = map_address(field);
+    int bytes = map_bytes(field);
+
+    if( plan_get(p_plan, data, address, bytes) != bytes )
+        return ERR_COMM_READ;
+
+    *value = map_value(field, data, address);
+    return NOERR;
+    }
+
+
+/*  function        ERRNO map_get_nibbles( readplan_t const * p_plan, int field, uint8_t * dst )
+
+    brief           Takes the nibbles of a field out of a read plan, one byte
+                    each as needed by write_data()
+
+    param[in]       readplan_t const * p_plan, plan after plan_read()
+    param[in]       int field, FLD_xxx
+    param[out]      uint8_t * dst, buffer for the field's number of nibbles
+
+    return          ERRNO
+*/
+ERRNO map_get_nibbles( readplan_t const * p_plan, int field, uint8_t * dst )
+    {
+    uint8_t data[MAX_FIELD_NIBBLES / 2];
+    int address = map_address(field);
+    int bytes = map_bytes(field);
+
+    if( plan_get(p_plan, data, address, bytes) != bytes )
+        return ERR_COMM_READ;
+
+    map_nibbles(field, data, address, dst);
+    return NOERR;
+    }
+
+
+/*  function        ERRNO map_get_timestamp( readplan_t const * p_plan, int field, struct timestamp * ts )
+
+    brief           Takes a timestamp or the clock out of a read plan
+
+    param[in]       readplan_t const * p_plan, plan after plan_read()
+    param[in]       int field, FLD_xxx of encoding ENC_TIMESTAMP or ENC_CLOCK
+    param[out]      struct timestamp * ts, unchanged if the field is not available
+
+    return          ERRNO
+*/
+ERRNO map_get_timestamp( readplan_t const * p_plan, int field, struct timestamp * ts )
+    {
+    uint8_t data[MAX_FIELD_NIBBLES / 2];
+    int address = map_address(field);
+    int bytes = map_bytes(field);
+
+    if( plan_get(p_plan, data, address, bytes) != bytes )
+        return ERR_COMM_READ;
+
+    map_timestamp(field, data, address, ts);
+    return NOERR;
+    }
+
+
+/*  function        int map_changed( readplan_t const * p_plan, int field )
+
+    brief           Tells whether a field of a read plan may have changed
+                    since the last read, see plan_compare()
+
+    param[in]       readplan_t const * p_plan, plan after plan_read()
+    param[in]       int field, FLD_xxx
+
+    return          int, 0 : unchanged, 1 : changed, -1 : not available
+*/
+int map_changed( readplan_t const * p_plan, int field )
+    {
+    return plan_changed(p_plan, map_address(field), map_bytes(field));
+    }
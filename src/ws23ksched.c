@@ -0,0 +1,371 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23ksched.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Multi-rate sampling of the WS2300 weather station
+
+    details     Each field has a period and the time it is due next.
+                sched_tick() plans all due fields, so fields of different
+                rates that are due together share telegrams. After a
+                successful read a field is due at the next multiple of its
+                period (a period of 60 s at every full minute, 300 s every
+                five minutes), after a failed read or an invalid wind
+                measurement it is tried again after SCHED_RETRY_MS. If the
+                clock was set back a field is due at once. The state is kept
+                in a sched_t of each station.
+
+                A field is taken as due up to SCHED_SLACK_MS early. So a
+                field sampled every minute by the minute cycle is not missed
+                because the cycle started a few milliseconds early.
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Periods are in seconds, SAMPLE_OFF means the field is not
+                sampled, its accessor in ws23k.c reads it when it is needed.
+
+    todo
+
+*/
+
+
+#include <string.h>
+#include "debug.h"
+#include "errors.h"
+#include "ws23kcom.h"
+#include "ws23kmap.h"
+#include "ws23ksched.h"
+
+
+#define SCHED_SLACK_MS                          1000                            // a field is due this early
+#define SCHED_RETRY_MS                          1000                            // retry a failed field after this time
+
+
+static int const the_group_wind[] =
+    {
+    FLD_WIND_FLAGS, FLD_WIND_MINCODE, FLD_WIND_SPEED, FLD_WIND_DIR, -1
+    };
+static int const the_group_temperature[] =
+    {
+    FLD_TEMP_IN, FLD_TEMP_OUT, FLD_DEWPOINT, FLD_WINDCHILL, -1
+    };
+static int const the_group_humidity[] =
+    {
+    FLD_HUM_IN, FLD_HUM_OUT, -1
+    };
+static int const the_group_pressure[] =
+    {
+    FLD_PRESS_ABS, FLD_PRESS_REL, -1
+    };
+static int const the_group_rain[] =
+    {
+    FLD_RAIN_1H, FLD_RAIN_24H, FLD_RAIN_TOTAL, -1
+    };
+static int const * const the_groups[SAMPLE_MINMAX] =                            // SAMPLE_MINMAX uses the refresh class of the map
+    {
+    the_group_wind,
+    the_group_temperature,
+    the_group_humidity,
+    the_group_pressure,
+    the_group_rain
+    };
+
+
+/*  function        static long long now_ms( void )
+
+    brief           Returns the time of day
+
+    return          long long, [ms] since the epoch
+*/
+static long long now_ms( void )
+    {
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (long long)now.tv_sec * 1000LL + now.tv_nsec / 1000000L;
+    }
+
+
+/*  function        static int is_due( sched_t * p_sched, int field, long long now )
+
+    brief           Checks if a sampled field is due
+
+    param[in]       sched_t * p_sched
+    param[in]       int field, FLD_xxx
+    param[in]       long long now, [ms] since the epoch
+
+    return          int, 1 if the field has to be read
+*/
+static int is_due( sched_t * p_sched, int field, long long now )
+    {
+    if( p_sched->period[field] == SAMPLE_OFF )
+        return 0;
+    if( p_sched->due[field] - now > p_sched->period[field] * 1000LL + SCHED_SLACK_MS ) // the clock was set back
+        p_sched->due[field] = now;
+
+    return p_sched->due[field] - SCHED_SLACK_MS <= now;
+    }
+
+
+/*  function        void sched_set_period( sched_t * p_sched, int field, int period )
+
+    brief           Sets the sampling period of a field, the field is due at
+                    the next sched_tick()
+
+    param[in]       sched_t * p_sched
+    param[in]       int field, FLD_xxx
+    param[in]       int period, [s], SAMPLE_OFF to stop sampling the field
+*/
+void sched_set_period( sched_t * p_sched, int field, int period )
+    {
+    if( field < 0 || field >= FLD_NUM_OF_FIELDS )
+        return;
+
+    p_sched->period[field] = ( period > 0 ) ? period : SAMPLE_OFF;
+    p_sched->due[field] = 0;
+    }
+
+
+/*  function        int sched_period( sched_t const * p_sched, int field )
+
+    brief           Returns the sampling period of a field
+
+    param[in]       sched_t const * p_sched
+    param[in]       int field, FLD_xxx
+
+    return          int, [s], SAMPLE_OFF if the field is not sampled
+*/
+int sched_period( sched_t const * p_sched, int field )
+    {
+    if( field < 0 || field >= FLD_NUM_OF_FIELDS )
+        return SAMPLE_OFF;
+
+    return p_sched->period[field];
+    }
+
+
+/*  function        void sched_set_group( sched_t * p_sched, int group, int period )
+
+    brief           Sets the sampling period of all fields of a group
+
+    param[in]       sched_t * p_sched
+    param[in]       int group, SAMPLE_xxx
+    param[in]       int period, [s], SAMPLE_OFF to stop sampling the group
+*/
+void sched_set_group( sched_t * p_sched, int group, int period )
+    {
+    int const * p_field;
+    int i;
+
+    if( group == SAMPLE_MINMAX )
+        {
+        for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+            {
+            if( map_field(i)->refresh == REFRESH_MINMAX )
+                sched_set_period(p_sched, i, period);
+            }
+        return;
+        }
+
+    if( group < 0 || group >= SAMPLE_MINMAX )
+        return;
+
+    for( p_field = the_groups[group]; *p_field >= 0; ++p_field )
+        sched_set_period(p_sched, *p_field, period);
+    }
+
+
+/*  function        int sched_active( sched_t const * p_sched )
+
+    brief           Checks if any field is sampled
+
+    param[in]       sched_t const * p_sched
+
+    return          int, 1 if at least one field has a period
+*/
+int sched_active( sched_t const * p_sched )
+    {
+    int i;
+
+    for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+        {
+        if( p_sched->period[i] != SAMPLE_OFF )
+            return 1;
+        }
+
+    return 0;
+    }
+
+
+/*  function        int sched_next( sched_t * p_sched )
+
+    brief           Returns the time until the next field is due
+
+    param[in]       sched_t * p_sched
+
+    return          int, [s], 0 if a field is due, -1 if no field is sampled
+*/
+int sched_next( sched_t * p_sched )
+    {
+    long long now = now_ms();
+    long long next = -1;
+    int i;
+
+    for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+        {
+        if( p_sched->period[i] == SAMPLE_OFF )
+            continue;
+        if( is_due(p_sched, i, now) )
+            return 0;
+        if( next < 0 || p_sched->due[i] < next )
+            next = p_sched->due[i];
+        }
+
+    if( next < 0 )
+        return -1;
+
+    return (int)( ( next - SCHED_SLACK_MS - now + 999 ) / 1000 );
+    }
+
+
+/*  function        int sched_tick( sched_t * p_sched, link_t * p_link )
+
+    brief           Reads all fields that are due with one read plan and keeps
+                    their values. The wind fields are only kept if the station
+                    delivered a valid measurement.
+
+    param[in]       sched_t * p_sched
+    param[in]       link_t * p_link
+
+    return          int, number of fields read or < 0 on error (ERRNO)
+*/
+int sched_tick( sched_t * p_sched, link_t * p_link )
+    {
+    readplan_t plan;
+    sample_t sample;
+    unsigned long speed = 0;
+    long long now = now_ms();
+    time_t t;
+    int wind_ok = 1;
+    int changed;
+    int read = 0;
+    int i;
+    ERRNO error;
+
+    plan_clear(&plan);
+    for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+        {
+        if( is_due(p_sched, i, now) )
+            map_plan(&plan, i);
+        }
+    if( plan.n_fields == 0 )
+        return 0;
+
+    plan_compare(&plan, &p_sched->hashes);
+    if( (error = plan_read(p_link, &plan)) != NOERR )                           // fields of failed telegrams are retried
+        handle_comm_error(p_link, error);
+    ++p_sched->ticks;
+    time(&t);
+
+    if( map_get_raw(&plan, FLD_WIND_SPEED, &speed) == NOERR
+        && ( speed & 0x0ff ) == 0x0ff && ( speed >> 8 ) <= 1 )                  // the station is just measuring a new wind value
+        {
+        debug("Sampling : invalid wind\n");
+        wind_ok = 0;
+        }
+
+    for( i = 0; i < FLD_NUM_OF_FIELDS; ++i )
+        {
+        if( !is_due(p_sched, i, now) )
+            continue;
+
+        changed = map_changed(&plan, i);
+        if( changed < 0 || ( !wind_ok && map_address(i) >= map_address(FLD_WIND_FLAGS)
+            && map_address(i) <= map_address(FLD_WIND_DIR) ) )
+            {
+            p_sched->due[i] = now + SCHED_RETRY_MS;
+            continue;
+            }
+
+        if( !changed && p_sched->samples[i].valid )                             // the same bytes as the last time, keep the decoded value
+            p_sched->samples[i].time = t;
+        else
+            {
+            memset(&sample, 0, sizeof(sample));
+            map_get_raw(&plan, i, &sample.raw);
+            if( map_field(i)->encoding == ENC_TIMESTAMP || map_field(i)->encoding == ENC_CLOCK )
+                map_get_timestamp(&plan, i, &sample.ts);
+            else
+                map_get(&plan, i, &sample.value);
+            sample.valid = 1;
+            sample.time = t;
+            p_sched->samples[i] = sample;
+            }
+        p_sched->due[i] = ( ( now + SCHED_SLACK_MS ) / ( p_sched->period[i] * 1000LL ) + 1 ) * p_sched->period[i] * 1000LL;
+        ++read;
+        }
+
+    p_sched->fields_read += read;
+    return error ? error : read;
+    }
+
+
+/*  function        sample_t const * sched_sample( sched_t const * p_sched, int field )
+
+    brief           Returns the latest value of a field read by sched_tick()
+
+    param[in]       sched_t const * p_sched
+    param[in]       int field, FLD_xxx
+
+    return          sample_t const *, valid is 0 if the field was never read
+*/
+sample_t const * sched_sample( sched_t const * p_sched, int field )
+    {
+    static sample_t const none = { 0, };
+
+    if( field < 0 || field >= FLD_NUM_OF_FIELDS )
+        return &none;
+
+    return &p_sched->samples[field];
+    }
+
+
+/*  function        void sched_stats( sched_t const * p_sched, int * ticks, int * fields )
+
+    brief           Returns how often the station was read by sched_tick() and
+                    how many fields were read since the start
+
+    param[in]       sched_t const * p_sched
+    param[out]      int * ticks
+    param[out]      int * fields
+*/
+void sched_stats( sched_t const * p_sched, int * ticks, int * fields )
+    {
+    *ticks = p_sched->ticks;
+    *fields = p_sched->fields_read;
+    }
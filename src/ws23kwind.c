@@ -0,0 +1,255 @@
+/*
+    Copyright (C)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+    Klabautermann Software
+    Uwe Jantzen
+    Weingartener Straße 33
+    76297 Stutensee
+    Germany
+
+    file        ws23kwind.c
+
+    date        17.10.2026
+
+    author      Uwe Jantzen (jantzen@klabautermann-software.de)
+
+    brief       Running wind statistics of the last ten minutes
+
+    details     The sums of speed, wind vector and direction unit vector are
+                updated when a sample is added and when it falls out of the
+                window, so the mean values cost O(1) per sample. The gust is
+                the first entry of a queue of ring positions with falling
+                speeds : a new sample removes all weaker ones from its end,
+                the oldest one leaves at the front when it expires. Each
+                position enters and leaves the queue once, that is O(1) per
+                sample too.
+
+                To keep rounding errors from adding up the sums are computed
+                anew from the ring after WIND_WINDOW samples.
+
+                The variability of the direction is the estimation of
+                Yamartino (1984) from the mean of the unit vectors :
+                    eps = sqrt(1 - (sa² + ca²))
+                    sigma = asin(eps) * (1 + (2 / sqrt(3) - 1) * eps³)
+
+    project     weather23k
+    target      Linux
+    begin       17.10.2026
+
+    note        Calm samples count for the mean speed and the gust, not for
+                the direction.
+
+    todo
+
+*/
+
+
+#include <math.h>
+#include <string.h>
+#include "ws23kwind.h"
+
+
+#define DEG2RAD                                 ( M_PI / 180.0 )
+
+
+/*  function        static void drop_oldest( windstat_t * p_wind )
+
+    brief           Removes the oldest sample from the ring, the sums and the
+                    queue of peaks
+
+    param[in]       windstat_t * p_wind
+*/
+static void drop_oldest( windstat_t * p_wind )
+    {
+    windsample_t const * p_sample = &p_wind->ring[p_wind->head];
+
+    p_wind->sum_speed -= p_sample->speed;
+    p_wind->sum_u -= p_sample->speed * p_sample->sin;
+    p_wind->sum_v -= p_sample->speed * p_sample->cos;
+    p_wind->sum_sin -= p_sample->sin;
+    p_wind->sum_cos -= p_sample->cos;
+    if( p_sample->sin != 0.0 || p_sample->cos != 0.0 )
+        --p_wind->directions;
+
+    if( p_wind->peak_count > 0 && p_wind->peaks[p_wind->peak_head] == p_wind->head )
+        {
+        p_wind->peak_head = ( p_wind->peak_head + 1 ) % WIND_WINDOW;
+        --p_wind->peak_count;
+        }
+
+    p_wind->head = ( p_wind->head + 1 ) % WIND_WINDOW;
+    --p_wind->count;
+    }
+
+
+/*  function        static void expire( windstat_t * p_wind, time_t now )
+
+    brief           Removes all samples that are older than the window
+
+    param[in]       windstat_t * p_wind
+    param[in]       time_t now
+*/
+static void expire( windstat_t * p_wind, time_t now )
+    {
+    while( p_wind->count > 0 && p_wind->ring[p_wind->head].time <= now - WIND_WINDOW )
+        drop_oldest(p_wind);
+    }
+
+
+/*  function        static void recompute( windstat_t * p_wind )
+
+    brief           Computes the sums anew from the samples in the ring
+
+    param[in]       windstat_t * p_wind
+*/
+static void recompute( windstat_t * p_wind )
+    {
+    windsample_t const * p_sample;
+    int i;
+
+    p_wind->sum_speed = p_wind->sum_u = p_wind->sum_v = 0.0;
+    p_wind->sum_sin = p_wind->sum_cos = 0.0;
+    p_wind->directions = 0;
+    for( i = 0; i < p_wind->count; ++i )
+        {
+        p_sample = &p_wind->ring[( p_wind->head + i ) % WIND_WINDOW];
+        p_wind->sum_speed += p_sample->speed;
+        p_wind->sum_u += p_sample->speed * p_sample->sin;
+        p_wind->sum_v += p_sample->speed * p_sample->cos;
+        p_wind->sum_sin += p_sample->sin;
+        p_wind->sum_cos += p_sample->cos;
+        if( p_sample->sin != 0.0 || p_sample->cos != 0.0 )
+            ++p_wind->directions;
+        }
+    p_wind->added = 0;
+    }
+
+
+/*  function        void windstat_init( windstat_t * p_wind )
+
+    brief           Empties the statistics
+
+    param[out]      windstat_t * p_wind
+*/
+void windstat_init( windstat_t * p_wind )
+    {
+    memset(p_wind, 0, sizeof(*p_wind));
+    }
+
+
+/*  function        void windstat_add( windstat_t * p_wind, time_t t, double speed, double direction )
+
+    brief           Adds a wind sample, a sample that is not newer than the
+                    last one is ignored
+
+    param[in]       windstat_t * p_wind
+    param[in]       time_t t, time the sample was read
+    param[in]       double speed, [m/s]
+    param[in]       double direction, [°]
+*/
+void windstat_add( windstat_t * p_wind, time_t t, double speed, double direction )
+    {
+    windsample_t * p_sample;
+    int pos;
+    int last;
+
+    if( p_wind->count > 0 && t <= p_wind->ring[( p_wind->head + p_wind->count - 1 ) % WIND_WINDOW].time )
+        return;
+
+    expire(p_wind, t);
+    if( p_wind->count == WIND_WINDOW )                                          // only if the clock was set back
+        drop_oldest(p_wind);
+
+    pos = ( p_wind->head + p_wind->count ) % WIND_WINDOW;
+    p_sample = &p_wind->ring[pos];
+    p_sample->time = t;
+    p_sample->speed = speed;
+    p_sample->sin = 0.0;
+    p_sample->cos = 0.0;
+    if( speed >= WIND_CALM )
+        {
+        p_sample->sin = sin(direction * DEG2RAD);
+        p_sample->cos = cos(direction * DEG2RAD);
+        ++p_wind->directions;
+        }
+    ++p_wind->count;
+
+    p_wind->sum_speed += speed;
+    p_wind->sum_u += speed * p_sample->sin;
+    p_wind->sum_v += speed * p_sample->cos;
+    p_wind->sum_sin += p_sample->sin;
+    p_wind->sum_cos += p_sample->cos;
+
+    while( p_wind->peak_count > 0 )                                             // weaker samples can't become the gust any more
+        {
+        last = p_wind->peaks[( p_wind->peak_head + p_wind->peak_count - 1 ) % WIND_WINDOW];
+        if( p_wind->ring[last].speed > speed )
+            break;
+        --p_wind->peak_count;
+        }
+    p_wind->peaks[( p_wind->peak_head + p_wind->peak_count ) % WIND_WINDOW] = pos;
+    ++p_wind->peak_count;
+
+    if( ++p_wind->added >= WIND_WINDOW )
+        recompute(p_wind);
+    }
+
+
+/*  function        void windstat_get( windstat_t * p_wind, time_t now, windsummary_t * p_summary )
+
+    brief           Returns the statistics of the samples of the last
+                    WIND_WINDOW seconds
+
+    param[in]       windstat_t * p_wind
+    param[in]       time_t now
+    param[out]      windsummary_t * p_summary
+*/
+void windstat_get( windstat_t * p_wind, time_t now, windsummary_t * p_summary )
+    {
+    windsample_t const * p_gust;
+    double sa;
+    double ca;
+    double eps;
+
+    expire(p_wind, now);
+    memset(p_summary, 0, sizeof(*p_summary));
+    p_summary->samples = p_wind->count;
+    if( p_wind->count == 0 )
+        return;
+
+    p_summary->mean = p_wind->sum_speed / p_wind->count;
+    p_gust = &p_wind->ring[p_wind->peaks[p_wind->peak_head]];
+    p_summary->gust = p_gust->speed;
+    p_summary->gust_time = p_gust->time;
+
+    if( p_wind->directions == 0 )                                               // calm all the time
+        return;
+
+    if( fabs(p_wind->sum_u) > 1e-9 || fabs(p_wind->sum_v) > 1e-9 )
+        p_summary->direction = atan2(p_wind->sum_u, p_wind->sum_v) / DEG2RAD;
+    else
+        p_summary->direction = atan2(p_wind->sum_sin, p_wind->sum_cos) / DEG2RAD;
+    if( p_summary->direction < 0.0 )
+        p_summary->direction += 360.0;
+    if( p_summary->direction >= 359.95 )                                        // would be printed as 360.0
+        p_summary->direction = 0.0;
+
+    sa = p_wind->sum_sin / p_wind->directions;
+    ca = p_wind->sum_cos / p_wind->directions;
+    eps = 1.0 - ( sa * sa + ca * ca );
+    eps = ( eps > 0.0 ) ? sqrt(eps) : 0.0;
+    p_summary->deviation = asin(eps) * ( 1.0 + ( 2.0 / sqrt(3.0) - 1.0 ) * eps * eps * eps ) / DEG2RAD;
+    }